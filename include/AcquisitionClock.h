@@ -0,0 +1,12 @@
+#pragma once
+
+#include <QtGlobal>
+
+// Epoch-anchored monotonic clock shared by frames and sensor samples.
+// Readings are wall-clock milliseconds since epoch at the first call, then
+// advance with the steady clock so capture timestamps never go backwards.
+class AcquisitionClock
+{
+public:
+    static qint64 nowMs();
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QPointer>
+#include <QQueue>
+#include <QString>
+#include <QThreadPool>
+#include <QVariantMap>
+#include <QWaitCondition>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+class QFile;
+
+class AsyncWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Completion = std::function<void(bool ok, const QString &errorMessage)>;
+
+    explicit AsyncWriter(int maxInFlight = 0, qint64 maxInFlightBytes = 0, QObject *parent = nullptr);
+    ~AsyncWriter();
+
+    static AsyncWriter *shared();
+
+    QString backendName() const;
+    int maxInFlight() const { return m_maxInFlight; }
+    int inFlight() const;
+    Q_INVOKABLE QVariantMap metrics() const;
+
+    int openAppend(const QString &path, bool truncate, QString *errorMessage = nullptr);
+    bool append(int fileId, const QByteArray &data, bool durable,
+                QObject *context = nullptr, Completion completion = Completion());
+    bool writeFile(const QString &path, const QByteArray &data, bool durable,
+                   QObject *context = nullptr, Completion completion = Completion());
+    void close(int fileId);
+    void waitForIdle();
+
+private:
+    struct FileState {
+        std::shared_ptr<QFile> file;
+        std::shared_ptr<QMutex> mutex;
+        qint64 nextOffset = 0;
+        int pending = 0;
+        bool closing = false;
+    };
+
+    struct Request {
+        int fileId = -1;
+        std::shared_ptr<QFile> file;
+        std::shared_ptr<QMutex> fileMutex;
+        QString path;
+        qint64 offset = 0;
+        QByteArray data;
+        bool durable = false;
+        QPointer<QObject> context;
+        bool hasContext = false;
+        Completion completion;
+        qint64 submittedNs = 0;
+        bool ok = true;
+        QString errorMessage;
+    };
+
+    bool enqueue(Request request);
+    QList<Request> takeBatch();
+    void runPoolWorker();
+    void executeBatch(QList<Request> &batch);
+    void complete(QList<Request> &batch);
+    static bool writeAt(Request &request);
+    static bool openForWrite(Request &request);
+    static bool syncFile(QFile *file, QMutex *mutex);
+
+#ifdef HAVE_LIBURING
+    bool startUring();
+    void runUringLoop();
+    void executeUringBatch(QList<Request> &batch);
+    bool driveUring(int prepared, const std::function<void(int, int)> &onComplete);
+    void resetUring();
+    struct UringState;
+    std::unique_ptr<UringState> m_uring;
+#endif
+
+    int m_maxInFlight;
+    qint64 m_maxInFlightBytes;
+    mutable QMutex m_mutex;
+    QWaitCondition m_workAvailable;
+    QWaitCondition m_idle;
+    QQueue<Request> m_queue;
+    QHash<int, FileState> m_files;
+    int m_nextFileId;
+    int m_inFlight;
+    qint64 m_inFlightBytes;
+    int m_activeWorkers;
+    int m_maxWorkers;
+    bool m_stopping;
+    QThreadPool m_pool;
+
+    std::atomic<quint64> m_requests;
+    std::atomic<quint64> m_batches;
+    std::atomic<quint64> m_syncs;
+    std::atomic<quint64> m_bytesWritten;
+    std::atomic<quint64> m_rejected;
+    std::atomic<quint64> m_failed;
+    std::atomic<qint64> m_maxLatencyNs;
+};
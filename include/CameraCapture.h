@@ -6,47 +6,155 @@
 #include <QImage>
 #include <QDir>
 #include <QDateTime>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QVariantMap>
 #include <opencv2/opencv.hpp>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "ChangeDetector.h"
+#include "FramePool.h"
+#include "FrameSource.h"
+#include "PreTriggerRecorder.h"
+#include "SharedBusWriter.h"
+
+class FrameWriter;
 
 class CameraCapture : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(bool isRunning READ isRunning NOTIFY runningChanged)
     Q_PROPERTY(QSize resolution READ resolution WRITE setResolution NOTIFY resolutionChanged)
+    Q_PROPERTY(QString source READ source NOTIFY sourceChanged)
+    Q_PROPERTY(QString cameraId READ cameraId CONSTANT)
+    Q_PROPERTY(CameraState state READ state NOTIFY stateChanged)
+    Q_PROPERTY(QString stateName READ stateName NOTIFY stateChanged)
 
 public:
+    enum CameraState {
+        Stopped,
+        Opening,
+        Warming,
+        Live,
+        Failed
+    };
+    Q_ENUM(CameraState)
+
     explicit CameraCapture(QObject *parent = nullptr);
+    explicit CameraCapture(const QString &cameraId, QObject *parent = nullptr);
     ~CameraCapture();
 
     bool isRunning() const { return m_isRunning; }
+    CameraState state() const { return static_cast<CameraState>(m_state.load()); }
+    QString stateName() const { return stateName(state()); }
+    static QString stateName(CameraState state);
+    qint64 openMs() const { return m_openMs.load(); }
+    qint64 timeToFirstFrameMs() const { return m_firstFrameMs.load(); }
     QSize resolution() const { return m_resolution; }
     void setResolution(const QSize &resolution);
+    QString cameraId() const { return m_cameraId; }
+    void setPreviewEnabled(bool enabled) { m_previewEnabled = enabled; }
+    void setDisplayDemand(std::function<bool()> demand) { m_displayDemand = std::move(demand); }
+    void setKeepAliveInterval(int intervalMs);
+    bool isIdle() const { return m_idle; }
+    void setFrameSaveInterval(int intervalMs);
+    void setFrameWriter(FrameWriter *frameWriter);
+    void setBusName(const QString &busName);
+    void setPreTriggerConfig(const PreTriggerConfig &config);
+    bool isPreTriggerEnabled() const { return m_preTriggerMs.load() > 0; }
+    QString source() const;
+    const FrameSourceConfig &sourceConfig() const { return m_sourceConfig; }
+    void setSourceConfig(const FrameSourceConfig &config);
+    Q_INVOKABLE bool setSource(const QString &spec);
+    quint64 framesCaptured() const { return m_framesCaptured.load(); }
+    quint64 framesSaved() const { return m_framesSaved.load(); }
+    quint64 framesDropped() const { return m_framesDropped.load(); }
+    quint64 framesUnchanged() const { return m_framesUnchanged.load(); }
+    quint64 previewFrames() const { return m_previewFrames.load(); }
+    quint64 previewSkipped() const { return m_previewSkipped.load(); }
+    Q_INVOKABLE QVariantMap metrics() const;
 
     Q_INVOKABLE bool start();
     Q_INVOKABLE void stop();
     Q_INVOKABLE bool saveFrame(const QString &filename);
+    Q_INVOKABLE void trigger(const QString &reason);
 
 signals:
     void frameReady(const QImage &frame);
     void runningChanged();
+    void stateChanged();
     void resolutionChanged();
+    void sourceChanged();
     void error(const QString &message);
-    void frameSaved(const QString &filename);
+    void frameSaved(const QString &filename, qint64 timestampMs);
+    void eventRecorded(const QString &directory, int frames, const QStringList &reasons);
 
 private slots:
     void captureFrame();
     void saveCurrentFrame();
+    void beginOpen();
 
 private:
+    bool isOwnThread() const;
     bool openCamera();
     void closeCamera();
-    QImage matToQImage(const cv::Mat &mat);
+    void setState(CameraState state);
+    void becomeLive();
+    void enterFailed(const QString &message);
+    bool sourcePresent() const;
+    QImage matToQImage(const cv::Mat &mat, FramePixelFormat format);
+    void publishFrame(const cv::Mat &frame, FramePixelFormat format, qint64 timestampMs);
+    cv::Mat placeholderFrame() const;
+    int captureInterval() const;
+    void updateRateMetrics(qint64 captureUs);
+    void updateIdleState();
 
-    cv::VideoCapture m_capture;
+    QString m_cameraId;
+    std::unique_ptr<FrameSource> m_source;
+    FramePool m_framePool;
+    ChangeDetector m_changeDetector;
+    cv::Mat m_decoded;
+    QString m_busName;
+    SharedBusWriter m_busWriter;
+    PreTriggerRecorder *m_preTrigger;
+    std::atomic<int> m_preTriggerMs;
+    FrameSourceConfig m_sourceConfig;
+    FrameWriter *m_frameWriter;
     QTimer *m_timer;
     QTimer *m_frameSaveTimer;
-    bool m_isRunning;
+    QTimer *m_reconnectTimer;
+    std::atomic<bool> m_isRunning;
+    std::atomic<int> m_state;
+    QElapsedTimer m_startTimer;
+    QElapsedTimer m_warmupTimer;
+    int m_reconnectDelayMs;
+    bool m_failureReported;
+    std::atomic<qint64> m_openMs;
+    std::atomic<qint64> m_firstFrameMs;
+    std::atomic<quint64> m_reconnects;
+    std::atomic<bool> m_previewEnabled;
+    std::function<bool()> m_displayDemand;
+    QElapsedTimer m_demandTimer;
+    std::atomic<bool> m_idle;
+    int m_keepAliveIntervalMs;
     QSize m_resolution;
+    std::atomic<quint64> m_framesCaptured;
+    std::atomic<quint64> m_framesSaved;
+    std::atomic<quint64> m_framesDropped;
+    std::atomic<quint64> m_framesUnchanged;
+    std::atomic<double> m_lastChangePercent;
+    std::atomic<quint64> m_readFailures;
+    std::atomic<quint64> m_previewFrames;
+    std::atomic<quint64> m_previewSkipped;
+    std::atomic<double> m_captureFps;
+    std::atomic<double> m_captureMs;
+    int m_consecutiveFailures;
+    QElapsedTimer m_rateTimer;
+    quint64 m_rateFrames;
+    mutable QMutex m_frameMutex;
     cv::Mat m_currentFrame;
+    FramePixelFormat m_currentFrameFormat;
+    qint64 m_currentFrameTimestampMs;
     QString m_dataDirectory;
 };
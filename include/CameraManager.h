@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QObject>
+#include <QList>
+#include <QStringList>
+#include <QThread>
+#include <QVariantList>
+#include "CameraCapture.h"
+#include "FrameWriter.h"
+
+class ImageProvider;
+
+class CameraManager : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int cameraCount READ cameraCount NOTIFY camerasChanged)
+    Q_PROPERTY(QStringList cameraIds READ cameraIds NOTIFY camerasChanged)
+    Q_PROPERTY(bool isRunning READ isRunning NOTIFY runningChanged)
+    Q_PROPERTY(QString cameraState READ cameraState NOTIFY cameraStateChanged)
+    Q_PROPERTY(bool preTriggerEnabled READ isPreTriggerEnabled NOTIFY camerasChanged)
+
+public:
+    explicit CameraManager(ImageProvider *imageProvider = nullptr, QObject *parent = nullptr);
+    ~CameraManager();
+
+    CameraCapture *addCamera(const FrameSourceConfig &config);
+    CameraCapture *primaryCamera() const;
+    Q_INVOKABLE CameraCapture *camera(const QString &cameraId) const;
+    QList<CameraCapture *> cameras() const;
+    FrameWriter *frameWriter() { return &m_frameWriter; }
+
+    int cameraCount() const { return m_cameras.size(); }
+    QStringList cameraIds() const;
+    bool isRunning() const;
+    QString cameraState() const;
+
+    Q_INVOKABLE void setResolution(const QSize &resolution);
+    void setPreviewEnabled(bool enabled);
+    void setFrameSaveInterval(int intervalMs);
+    void setKeepAliveInterval(int intervalMs);
+    void setBusName(const QString &busName);
+    void setPreTriggerConfig(const PreTriggerConfig &config);
+    bool isPreTriggerEnabled() const { return m_preTriggerConfig.isEnabled(); }
+
+    // Asks every camera to start and returns false only if there are none.
+    // Cameras open on their own threads; one that fails reports through
+    // error() and cameraStateChanged() afterwards.
+    Q_INVOKABLE bool startAll();
+    Q_INVOKABLE void stopAll();
+    Q_INVOKABLE QVariantList metrics() const;
+    Q_INVOKABLE void trigger(const QString &reason);
+    void shutdown();
+    // Waits until every frame already handed to the writer is on disk and
+    // its frameSaved has been delivered. Call on this object's thread.
+    void waitForSavedFrames();
+
+signals:
+    void camerasChanged();
+    void runningChanged();
+    void cameraStateChanged();
+    void error(const QString &cameraId, const QString &message);
+    void eventRecorded(const QString &cameraId, const QString &directory, int frames);
+    // Re-emitted from every camera. The camera id comes last so slots that
+    // take (filename, timestampMs) can be connected directly.
+    void frameSaved(const QString &filename, qint64 timestampMs, const QString &cameraId);
+
+private:
+    struct CameraSlot {
+        CameraCapture *capture;
+        QThread *thread;
+    };
+
+    void stopAndWait(CameraCapture *capture);
+
+    ImageProvider *m_imageProvider;
+    FrameWriter m_frameWriter;
+    PreTriggerConfig m_preTriggerConfig;
+    QList<CameraSlot> m_cameras;
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QtGlobal>
+#include <opencv2/opencv.hpp>
+#include "FrameSource.h"
+
+// Decides whether a frame differs enough from the last stored one to be
+// worth saving. Frames are compared as small grayscale thumbnails.
+class ChangeDetector
+{
+public:
+    static const int ThumbnailWidth = 64;
+    static const int ThumbnailHeight = 48;
+
+    explicit ChangeDetector(double thresholdPercent = 0.0, int keepAliveMs = 60000);
+
+    void configure(double thresholdPercent, int keepAliveMs);
+    void reset();
+    bool isEnabled() const { return m_thresholdPercent > 0.0; }
+    double thresholdPercent() const { return m_thresholdPercent; }
+    int keepAliveMs() const { return m_keepAliveMs; }
+
+    bool shouldStore(const cv::Mat &frame, FramePixelFormat format, qint64 timestampMs);
+    double lastChangePercent() const { return m_lastChangePercent; }
+
+private:
+    bool makeThumbnail(const cv::Mat &frame, FramePixelFormat format);
+
+    double m_thresholdPercent;
+    int m_keepAliveMs;
+    qint64 m_lastStoredMs;
+    double m_lastChangePercent;
+    cv::Mat m_reference;
+    cv::Mat m_thumbnail;
+    cv::Mat m_scratch;
+};
@@ -6,21 +6,20 @@
 #include <QTimer>
 #include <QDateTime>
 #include <QStandardPaths>
-
-struct SensorReading {
-    QDateTime timestamp;
-    double temperature;
-    double pressure;
-    QString frameFilename;
-};
-
-Q_DECLARE_METATYPE(SensorReading)
+#include "FrameIndex.h"
+#include "LogFollower.h"
+#include "RollupStore.h"
+#include "SensorDataset.h"
+#include "SessionCatalog.h"
+#include "ThumbnailAtlas.h"
 
 class DataLogger : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(bool isLogging READ isLogging NOTIFY loggingChanged)
     Q_PROPERTY(QString currentLogFile READ currentLogFile NOTIFY currentLogFileChanged)
+    Q_PROPERTY(QString loadedLogFile READ loadedLogFile NOTIFY dataLoaded)
+    Q_PROPERTY(bool isFollowing READ isFollowing NOTIFY followingChanged)
 
 public:
     explicit DataLogger(QObject *parent = nullptr);
@@ -28,32 +27,83 @@ public:
 
     bool isLogging() const { return m_isLogging; }
     QString currentLogFile() const { return m_currentLogFile; }
+    QString loadedLogFile() const { return m_loadedLogFile; }
+    bool isFollowing() const { return m_isFollowing; }
 
     Q_INVOKABLE bool startLogging();
     Q_INVOKABLE void stopLogging();
     Q_INVOKABLE bool loadLogFile(const QString &filename);
+    Q_INVOKABLE bool followLogFile(const QString &filename);
+    Q_INVOKABLE bool reviewRecording();
+    Q_INVOKABLE void stopFollowing();
+    Q_INVOKABLE QVariantMap followStatus() const;
     Q_INVOKABLE QString getDataDirectory();
-    Q_INVOKABLE QList<SensorReading> getReadings() const { return m_readings; }
+    SensorDataset::Snapshot readings() const { return m_readings.snapshot(); }
+    const FrameIndex &frameIndex() const { return m_frameIndex; }
+    const RollupStore &rollups() const { return m_rollups; }
+    SessionCatalog *catalog() { return &m_catalog; }
+    quint64 rowsDurable() const { return m_rowsDurable; }
 
     void logSensorData(double temperature, double pressure, const QString &timestamp);
-    void logFrame(const QString &frameFilename);
+    void logSample(qint64 timestampMs, double temperature, double pressure);
+    void logFrame(const QString &frameFilename, qint64 timestampMs);
+
+    static bool isValidHeader(const QString &header);
+    static bool parseReading(const QString &line, SensorReading &reading, QString *errorMessage = nullptr);
+    static bool readLogFile(const QString &filename, SensorDataset &readings, QString *errorMessage = nullptr);
 
 signals:
     void loggingChanged();
     void currentLogFileChanged();
     void dataLoaded();
+    void followingChanged();
+    void readingsAppended(int first);
+    void framesAppended(int first);
+    void frameIndexReset();
     void error(const QString &message);
 
 private:
     bool createLogFile();
     void writeHeader();
+    bool openFrameIndexFile();
+    void flushPending();
+    bool submitRows(int fileId, QByteArray &rows, int rowCount);
+    void buildFrameIndexFromReadings();
+    void loadRollups(const QString &logFilename);
+    void appendFollowedRows(const QList<QByteArray> &lines);
+    void appendFollowedFrames(const QList<QByteArray> &lines);
+    void followedFileRotated(const QString &filename);
+    void openFrameFollower();
+    void publishRecorded();
 
-    QFile *m_logFile;
-    QTextStream *m_stream;
+    int m_logFileId;
+    int m_frameIndexFileId;
+    QByteArray m_pendingRows;
+    int m_pendingRowCount;
+    QByteArray m_pendingFrameRows;
+    QTimer *m_flushTimer;
+    quint64 m_rowsDurable;
+    qint64 m_logBytes;
+    bool m_backlogReported;
     bool m_isLogging;
     QString m_currentLogFile;
+    QString m_loadedLogFile;
     QTimer *m_frameTimer;
-    QString m_lastFrameFilename;
-    QList<SensorReading> m_readings;
+    QString m_pendingFrameFilename;
+    SensorDataset m_readings;
+    FrameIndex m_frameIndex;
+    RollupStore m_rollups;
+    ThumbnailAtlas m_thumbnails;
+    SessionCatalog m_catalog;
+    LogFollower *m_logFollower;
+    LogFollower *m_frameFollower;
+    bool m_isFollowing;
+    bool m_isReviewing;
+    int m_reviewedReadings;
+    int m_reviewedFrames;
+    bool m_followLoaded;
+    int m_fileFrameStart;
+    QString m_followedFrame;
+    quint64 m_followSkipped;
     QString m_dataDirectory;
 };
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <QObject>
+#include <QThreadPool>
+#include <QSemaphore>
+#include <QMutex>
+#include <QMap>
+#include <QFile>
+#include <QSize>
+#include <QDateTime>
+#include <QVector>
+#include <atomic>
+#include "DataLogger.h"
+#include "Resampler.h"
+
+enum class ExportFormat {
+    Csv,
+    Binary,
+    Compressed
+};
+
+enum class FrameExportMode {
+    None,
+    Copy,
+    Transcode
+};
+
+struct ExportOptions {
+    QString sourceLogFile;
+    QString outputFile;
+    qint64 startMs = 0;
+    qint64 endMs = 0;
+    ExportFormat format = ExportFormat::Csv;
+    int resampleIntervalMs = 0;
+    ResampleMethod resampleMethod = ResampleMethod::Mean;
+    FrameExportMode frameMode = FrameExportMode::None;
+    QSize frameSize;
+    int jpegQuality = 90;
+    int chunkRows = 4096;
+};
+
+class ExportEngine : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool isRunning READ isRunning NOTIFY runningChanged)
+    Q_PROPERTY(double progress READ progress NOTIFY progressChanged)
+
+public:
+    explicit ExportEngine(int maxThreads = 0, QObject *parent = nullptr);
+    ~ExportEngine();
+
+    bool isRunning() const { return m_isRunning.load(); }
+    double progress() const { return m_progress.load(); }
+    quint64 rowsWritten() const { return m_rowsWritten.load(); }
+    int framesWritten() const { return m_framesWritten.load(); }
+
+    bool start(const ExportOptions &options);
+    Q_INVOKABLE bool exportRange(const QString &sourceLogFile, const QString &outputFile,
+                                 const QDateTime &startTime, const QDateTime &endTime,
+                                 const QString &format, const QString &frameMode, int resampleIntervalMs,
+                                 const QString &resampleMethod = "mean");
+    Q_INVOKABLE void cancel();
+    void waitForDone();
+
+    static bool parseFormat(const QString &text, ExportFormat &format);
+    static bool parseFrameMode(const QString &text, FrameExportMode &mode);
+    static QString formatExtension(ExportFormat format);
+
+signals:
+    void runningChanged();
+    void progressChanged();
+    void progressUpdated(double fraction, quint64 rowsWritten, int framesWritten);
+    void finished(bool success, const QString &outputFile, const QString &message);
+    void error(const QString &message);
+
+private:
+    void run();
+    bool writeHeader();
+    bool finalizeOutput();
+    void submitChunk(QVector<SensorReading> rows);
+    void submitFrame(qint64 timestampMs, const QString &sourcePath, const QString &targetPath);
+    void writeCompleted(quint64 sequence, const QByteArray &data, int rows);
+    QByteArray encodeChunk(const QVector<SensorReading> &rows) const;
+    void reportProgress(double fraction);
+    void fail(const QString &message);
+    QString resolveFramePath(const QString &frameFilename) const;
+
+    ExportOptions m_options;
+    QThreadPool m_pool;
+    int m_maxInFlight;
+    QSemaphore m_slots;
+    std::atomic<bool> m_isRunning;
+    std::atomic<bool> m_cancelled;
+    std::atomic<double> m_progress;
+    std::atomic<quint64> m_rowsWritten;
+    std::atomic<int> m_framesWritten;
+    std::atomic<int> m_framesFailed;
+    int m_lastPercent;
+
+    QMutex m_writeMutex;
+    QFile m_output;
+    QMap<quint64, QPair<QByteArray, int>> m_completed;
+    quint64 m_nextSequence;
+    quint64 m_nextWrite;
+    QString m_failure;
+};
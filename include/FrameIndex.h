@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+#include <QPair>
+
+struct FrameIndexEntry {
+    qint64 timestampMs;
+    QString filename;
+};
+
+class FrameIndex
+{
+public:
+    void clear() { m_entries.clear(); }
+    void append(qint64 timestampMs, const QString &filename);
+
+    int size() const { return m_entries.size(); }
+    bool isEmpty() const { return m_entries.isEmpty(); }
+    const FrameIndexEntry &at(int index) const { return m_entries.at(index); }
+
+    int nearestFrame(qint64 timestampMs) const;
+    QPair<qint64, qint64> frameWindow(int index) const;
+
+    bool load(const QString &filename, QString *errorMessage = nullptr);
+    static QString sidecarPath(const QString &logFilename);
+
+private:
+    QVector<FrameIndexEntry> m_entries;
+};
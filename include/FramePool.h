@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QImage>
+#include <QVector>
+#include <QVariantMap>
+#include <atomic>
+#include <opencv2/opencv.hpp>
+
+// Fixed set of preallocated frame buffers for one capture thread. A buffer
+// is free again as soon as every cv::Mat or QImage referring to it is gone,
+// so frames can be handed to the display and the frame writer without copies.
+class FramePool
+{
+public:
+    explicit FramePool(int capacity = 6, int imageCapacity = 3);
+    ~FramePool();
+
+    int capacity() const { return m_capacity; }
+    bool isConfigured() const { return !m_buffers.isEmpty(); }
+    bool matches(int rows, int cols, int type) const;
+
+    void configure(int rows, int cols, int type);
+    void clear();
+
+    cv::Mat acquire();
+    QImage acquireImage(int width, int height, QImage::Format format);
+
+    int inUse() const { return m_inUse.load(); }
+    QVariantMap metrics() const;
+
+private:
+    struct ImageBuffer {
+        uchar *data;
+        int width;
+        int height;
+        QImage::Format format;
+        std::atomic<int> state;
+    };
+
+    static void releaseImage(void *info);
+    static void destroyImage(ImageBuffer *buffer);
+
+    int m_capacity;
+    int m_imageCapacity;
+    QVector<cv::Mat> m_buffers;
+    int m_rows;
+    int m_cols;
+    int m_type;
+    int m_next;
+    QVector<ImageBuffer *> m_images;
+
+    std::atomic<quint64> m_acquired;
+    std::atomic<quint64> m_exhausted;
+    std::atomic<quint64> m_allocations;
+    std::atomic<quint64> m_reallocations;
+    std::atomic<quint64> m_imagesAcquired;
+    std::atomic<quint64> m_imageAllocations;
+    std::atomic<quint64> m_imagesExhausted;
+    std::atomic<int> m_inUse;
+};
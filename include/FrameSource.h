@@ -0,0 +1,139 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QSize>
+#include <QList>
+#include <memory>
+#include <opencv2/opencv.hpp>
+
+class QCommandLineParser;
+
+enum class FramePixelFormat {
+    BGR,
+    BGRA,
+    Gray,
+    YUYV,
+    MJPEG
+};
+
+struct FrameSourceConfig {
+    QString type = "device";
+    QString location = "0";
+    QSize resolution = QSize(640, 480);
+    double fps = 30.0;
+    FramePixelFormat pixelFormat = FramePixelFormat::BGR;
+    bool loop = true;
+    bool unthrottled = false;
+    double changeThreshold = 0.0;
+    int changeKeepAliveMs = 60000;
+};
+
+class FrameSource
+{
+public:
+    virtual ~FrameSource() = default;
+
+    virtual bool open() = 0;
+    virtual void close() = 0;
+    virtual bool isOpened() const = 0;
+    virtual bool read(cv::Mat &frame) = 0;
+    virtual void setResolution(const QSize &resolution);
+    virtual QString description() const = 0;
+
+    const FrameSourceConfig &config() const { return m_config; }
+    FramePixelFormat pixelFormat() const { return m_config.pixelFormat; }
+
+    static std::unique_ptr<FrameSource> create(const FrameSourceConfig &config);
+    static bool parseSpec(const QString &spec, FrameSourceConfig &config, QString *errorMessage);
+    static bool parsePixelFormat(const QString &text, FramePixelFormat &format);
+    static QString pixelFormatName(FramePixelFormat format);
+    static bool decodeToBgr(const cv::Mat &frame, FramePixelFormat format, cv::Mat &bgr);
+
+    static void addCommandLineOptions(QCommandLineParser &parser);
+    static bool applyCommandLineOptions(const QCommandLineParser &parser, QList<FrameSourceConfig> &configs, QString *errorMessage);
+
+protected:
+    explicit FrameSource(const FrameSourceConfig &config);
+    bool convertFromBgr(const cv::Mat &bgr, cv::Mat &frame) const;
+
+    FrameSourceConfig m_config;
+};
+
+class DeviceFrameSource : public FrameSource
+{
+public:
+    explicit DeviceFrameSource(const FrameSourceConfig &config);
+
+    bool open() override;
+    void close() override;
+    bool isOpened() const override { return m_capture.isOpened(); }
+    bool read(cv::Mat &frame) override;
+    void setResolution(const QSize &resolution) override;
+    QString description() const override;
+
+private:
+    bool readFirstNativeFrame(cv::Mat &frame);
+
+    cv::VideoCapture m_capture;
+    cv::Mat m_bgr;
+    int m_deviceIndex;
+    bool m_nativeFormat;
+    bool m_requestNative;
+    bool m_formatChecked;
+};
+
+class VideoFileFrameSource : public FrameSource
+{
+public:
+    explicit VideoFileFrameSource(const FrameSourceConfig &config);
+
+    bool open() override;
+    void close() override;
+    bool isOpened() const override { return m_capture.isOpened(); }
+    bool read(cv::Mat &frame) override;
+    QString description() const override;
+
+private:
+    cv::VideoCapture m_capture;
+    cv::Mat m_decoded;
+    cv::Mat m_resized;
+};
+
+class ImageSequenceFrameSource : public FrameSource
+{
+public:
+    explicit ImageSequenceFrameSource(const FrameSourceConfig &config);
+
+    bool open() override;
+    void close() override;
+    bool isOpened() const override { return !m_files.isEmpty(); }
+    bool read(cv::Mat &frame) override;
+    QString description() const override;
+
+private:
+    QStringList m_files;
+    int m_position;
+    cv::Mat m_resized;
+};
+
+class PatternFrameSource : public FrameSource
+{
+public:
+    explicit PatternFrameSource(const FrameSourceConfig &config);
+
+    bool open() override;
+    void close() override;
+    bool isOpened() const override { return m_isOpened; }
+    bool read(cv::Mat &frame) override;
+    void setResolution(const QSize &resolution) override;
+    QString description() const override;
+
+private:
+    void buildPattern();
+
+    bool m_isOpened;
+    quint64 m_frameNumber;
+    cv::Mat m_pattern;
+    cv::Mat m_frame;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QObject>
+#include <QThreadPool>
+#include <QString>
+#include <atomic>
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include "FrameSource.h"
+
+class FrameWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FrameWriter(int maxThreads = 0, int maxPending = 0, QObject *parent = nullptr);
+    ~FrameWriter();
+
+    bool submit(const QString &cameraId, const cv::Mat &frame, FramePixelFormat format,
+                const QString &filename, qint64 timestampMs);
+    void waitForDone();
+
+    static bool encodeJpeg(const cv::Mat &frame, FramePixelFormat format, std::vector<uchar> &encoded);
+    static bool writeJpeg(const cv::Mat &frame, FramePixelFormat format, const QString &filename, QString *errorMessage);
+
+    int maxThreads() const { return m_pool.maxThreadCount(); }
+    int maxPending() const { return m_maxPending; }
+    int pending() const { return m_pending.load(); }
+    quint64 written() const { return m_written.load(); }
+    quint64 rejected() const { return m_rejected.load(); }
+    quint64 failed() const { return m_failed.load(); }
+
+signals:
+    void frameWritten(const QString &cameraId, const QString &filename, qint64 timestampMs);
+    void writeFailed(const QString &cameraId, const QString &filename, const QString &message);
+
+private:
+    QThreadPool m_pool;
+    int m_maxPending;
+    std::atomic<int> m_pending;
+    std::atomic<quint64> m_written;
+    std::atomic<quint64> m_rejected;
+    std::atomic<quint64> m_failed;
+};
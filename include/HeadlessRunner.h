@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QSize>
+#include <QElapsedTimer>
+#include <QStringList>
+
+#include "CameraManager.h"
+#include "SensorDataGenerator.h"
+#include "DataLogger.h"
+#include "RuleEngine.h"
+#include "TelemetryAggregator.h"
+#include "TelemetryStreamer.h"
+
+struct HeadlessConfig {
+    int durationSeconds = 0;
+    double samplingRate = 1.0;
+    QSize resolution = QSize(640, 480);
+    int frameSaveIntervalMs = 5000;
+    bool cameraEnabled = true;
+    int statsIntervalSeconds = 0;
+    QList<FrameSourceConfig> sources;
+    QStringList rules;
+    QString busName;
+    TelemetryConfig telemetry;
+    PreTriggerConfig preTrigger;
+    QString aggregateHost;
+    quint16 aggregatePort = 0;
+};
+
+class HeadlessRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HeadlessRunner(const HeadlessConfig &config, QObject *parent = nullptr);
+    ~HeadlessRunner();
+
+    static bool isRequested(int argc, char *argv[]);
+    static bool parseArguments(const QStringList &arguments, HeadlessConfig &config, QString *errorMessage);
+
+    bool start();
+    void stop();
+
+private slots:
+    void checkForShutdown();
+    void reportProgress();
+    void finish();
+
+private:
+    static bool loadConfigFile(const QString &filename, HeadlessConfig &config, QString *errorMessage);
+    static bool parseResolution(const QString &text, QSize &resolution);
+    void printStatistics(const QString &title);
+
+    HeadlessConfig m_config;
+    CameraManager m_cameraManager;
+    SensorDataGenerator m_sensorGenerator;
+    DataLogger m_dataLogger;
+    RuleEngine m_ruleEngine;
+    TelemetryStreamer m_telemetry;
+    TelemetryAggregator m_aggregator;
+    QTimer *m_shutdownTimer;
+    QTimer *m_durationTimer;
+    QTimer *m_statsTimer;
+    QElapsedTimer m_elapsed;
+    quint64 m_samplesLogged;
+    quint64 m_alerts;
+    quint64 m_events;
+    int m_errorCount;
+    bool m_isRunning;
+};
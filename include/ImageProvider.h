@@ -2,9 +2,16 @@
 
 #include <QQuickImageProvider>
 #include <QImage>
-#include <QMutex>
+#include <QReadWriteLock>
+#include <QHash>
 #include <QString>
 #include <QObject>
+#include <QVariantMap>
+#include <atomic>
+#include <memory>
+
+class SessionCatalog;
+class ThumbnailAtlas;
 
 class ImageProvider : public QQuickImageProvider
 {
@@ -14,13 +21,58 @@ public:
     QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
     
     void updateImage(const QImage &image);
+    void updateImage(const QString &slotId, const QImage &image);
+    void setPrimarySlot(const QString &slotId);
     void updatePlaybackImage(const QString &frameFilename);
     void setPlaybackMode(bool enabled);
+    void setDisplayActive(bool active);
+    void setThumbnailAtlas(ThumbnailAtlas *atlas) { m_thumbnailAtlas = atlas; }
+    void setSessionCatalog(SessionCatalog *catalog) { m_sessionCatalog = catalog; }
+    bool wantsFrame(const QString &slotId);
+    quint64 framesDelivered(const QString &slotId);
+    quint64 framesDropped(const QString &slotId);
+    QVariantMap metrics();
 
 private:
-    QImage m_currentImage;
-    QImage m_playbackImage;
-    QMutex m_mutex;
-    bool m_playbackMode;
-    QString m_lastFrameFile;
+    // Frames are published by swapping a shared pointer. A writer builds
+    // the new frame with no lock held and exchanges it in; a reader takes
+    // a reference to whatever is current. The atomic shared_ptr operations
+    // only guard the reference count, never image I/O or decoding.
+    struct PublishedFrame {
+        QImage image;
+        quint64 sequence;
+    };
+
+    struct FrameSlot {
+        std::shared_ptr<const PublishedFrame> frame;
+        std::atomic<quint64> published{0};
+        std::atomic<quint64> deliveredSequence{0};
+        std::atomic<quint64> delivered{0};
+    };
+
+    struct WaitStats {
+        std::atomic<quint64> count{0};
+        std::atomic<qint64> totalNs{0};
+        std::atomic<qint64> maxNs{0};
+        void add(qint64 ns);
+        QVariantMap toMap() const;
+    };
+
+    FrameSlot *slot(const QString &slotId);
+    QString resolveSlotId(const QString &id) const;
+    void lockSlotsForRead();
+
+    QReadWriteLock m_slotsLock;
+    QHash<QString, std::shared_ptr<FrameSlot>> m_slots;
+    QString m_primarySlot;
+    std::shared_ptr<const QImage> m_playbackImage;
+    std::atomic<bool> m_playbackMode;
+    std::atomic<bool> m_displayActive;
+    ThumbnailAtlas *m_thumbnailAtlas;
+    SessionCatalog *m_sessionCatalog;
+
+    std::atomic<quint64> m_slotsContended;
+    WaitStats m_readWait;
+    WaitStats m_publishWait;
+    WaitStats m_playbackLoad;
 };
@@ -11,6 +11,7 @@ public:
     explicit ImageProviderWrapper(ImageProvider* provider, QObject *parent = nullptr);
 
     Q_INVOKABLE void setPlaybackMode(bool enabled);
+    Q_INVOKABLE QVariantMap metrics() const;
 
 private:
     ImageProvider* m_provider;
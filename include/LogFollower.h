@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QObject>
+#include <QFile>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QByteArray>
+#include <QList>
+
+// Tails a text file that another process appends to. Only bytes past the
+// last read offset are read; a line is handed out once its newline has
+// been written, so a row caught half-way through a write waits for the
+// rest. Truncation or replacement of the file restarts from offset zero,
+// and with a rotation pattern set the follower moves on to a newer file in
+// the same directory once the current one has been drained.
+class LogFollower : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LogFollower(QObject *parent = nullptr);
+    ~LogFollower();
+
+    bool open(const QString &filename, QString *errorMessage = nullptr);
+    void close();
+
+    bool isOpen() const { return m_file.isOpen(); }
+    QString fileName() const { return m_fileName; }
+    qint64 offset() const { return m_offset; }
+    quint64 bytesRead() const { return m_bytesRead; }
+    int rotations() const { return m_rotations; }
+
+    // Name filter such as "sensor_log_*.csv"; newer files sort later.
+    void setRotationPattern(const QString &pattern) { m_rotationPattern = pattern; }
+
+    // Reads whatever has been appended since the last call.
+    void readAvailable();
+
+signals:
+    void linesAppended(const QList<QByteArray> &lines);
+    void rotated(const QString &filename);
+
+private:
+    struct Identity {
+        quint64 device = 0;
+        quint64 inode = 0;
+        qint64 size = -1;
+        bool operator==(const Identity &other) const { return device == other.device && inode == other.inode; }
+    };
+
+    static Identity identify(const QString &filename);
+    bool reopen(const QString &filename);
+    void drain();
+    QString newerFile() const;
+    void watch();
+
+    QFile m_file;
+    QString m_fileName;
+    QString m_rotationPattern;
+    Identity m_identity;
+    qint64 m_offset;
+    QByteArray m_partial;
+    QFileSystemWatcher *m_watcher;
+    QTimer *m_pollTimer;
+    quint64 m_bytesRead;
+    int m_rotations;
+};
@@ -2,6 +2,10 @@
 
 #include <QObject>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <functional>
+#include <queue>
+#include <vector>
 #include "DataLogger.h"
 
 class PlaybackController : public QObject
@@ -13,7 +17,9 @@ class PlaybackController : public QObject
     Q_PROPERTY(int totalReadings READ totalReadings NOTIFY totalReadingsChanged)
     Q_PROPERTY(double playbackSpeed READ playbackSpeed WRITE setPlaybackSpeed NOTIFY playbackSpeedChanged)
     Q_PROPERTY(bool loopEnabled READ loopEnabled WRITE setLoopEnabled NOTIFY loopEnabledChanged)
+    Q_PROPERTY(bool aggregateSamples READ aggregateSamples WRITE setAggregateSamples NOTIFY aggregateSamplesChanged)
     Q_PROPERTY(QDateTime currentTimestamp READ currentTimestamp NOTIFY currentTimestampChanged)
+    Q_PROPERTY(bool following READ isFollowing WRITE setFollowing NOTIFY followingChanged)
 
 public:
     explicit PlaybackController(QObject *parent = nullptr);
@@ -26,9 +32,21 @@ public:
     void setPlaybackSpeed(double speed);
     bool loopEnabled() const { return m_loopEnabled; }
     void setLoopEnabled(bool enabled);
+    bool aggregateSamples() const { return m_aggregateSamples; }
+    void setAggregateSamples(bool enabled);
     QDateTime currentTimestamp() const;
+    bool isFollowing() const { return m_following; }
+    void setFollowing(bool following);
 
-    Q_INVOKABLE void loadData(const QList<SensorReading> &readings);
+    static constexpr double MinSpeed = 0.1;
+    static constexpr double MaxSpeed = 10000.0;
+    static constexpr int TickIntervalMs = 33;
+
+    void loadData(const SensorDataset::Snapshot &readings);
+    void setFrameIndex(const FrameIndex &frameIndex);
+    void setRollups(const RollupStore &rollups);
+    void appendReadings(const SensorDataset::Snapshot &readings);
+    void appendFrames(const FrameIndex &frameIndex);
     Q_INVOKABLE void play();
     Q_INVOKABLE void pause();
     Q_INVOKABLE void stop();
@@ -38,6 +56,12 @@ public:
     Q_INVOKABLE void seekToTimestamp(const QDateTime &timestamp);
     Q_INVOKABLE QList<SensorReading> getReadingsInRange(const QDateTime &start, const QDateTime &end);
     Q_INVOKABLE QVariantMap getStatistics() const;
+    Q_INVOKABLE QVariantMap getRangeStatistics(const QDateTime &start, const QDateTime &end) const;
+    Q_INVOKABLE QVariantList rollupSeries(const QDateTime &start, const QDateTime &end, int maxPoints) const;
+    Q_INVOKABLE int frameIndexAt(int readingIndex) const;
+    Q_INVOKABLE qint64 timestampAt(int readingIndex) const;
+    Q_INVOKABLE QVariantMap sampleRangeForFrame(int frameIndex) const;
+    Q_INVOKABLE QVariantMap playbackMetrics() const;
 
 signals:
     void playingChanged();
@@ -46,8 +70,11 @@ signals:
     void totalReadingsChanged();
     void playbackSpeedChanged();
     void loopEnabledChanged();
+    void aggregateSamplesChanged();
     void currentTimestampChanged();
+    void followingChanged();
     void dataPoint(double temperature, double pressure, const QString &timestamp, const QString &frameFilename);
+    void frameChanged(int frameIndex, const QString &frameFilename);
     void playbackFinished();
     void statisticsChanged();
 
@@ -56,11 +83,22 @@ private slots:
 
 private:
     void updateCurrentData();
+    void emitRange(int first, int end);
+    void anchorPlayhead(qint64 mediaMs);
+    qint64 playheadMs() const;
     int findIndexByTimeOffset(int currentIndex, int secondsOffset);
     void calculateStatistics();
+    void publishStatistics(const RollupBucket &summary, double temperatureMedian, double pressureMedian);
     int findIndexByTimestamp(const QDateTime &timestamp);
+    int findIndexByTimestampMs(qint64 timestampMs) const;
+    int lowerBoundIndex(qint64 timestampMs) const;
+    int upperBoundIndex(qint64 timestampMs) const;
+    void resetMetrics();
 
-    QList<SensorReading> m_readings;
+    SensorDataset::Snapshot m_readings;
+    FrameIndex m_frameIndex;
+    RollupStore m_rollups;
+    int m_currentFrame;
     QTimer *m_playbackTimer;
     bool m_isPlaying;
     bool m_isPaused;
@@ -68,5 +106,27 @@ private:
     int m_totalReadings;
     double m_playbackSpeed;
     bool m_loopEnabled;
+    bool m_aggregateSamples;
+    QElapsedTimer m_wallClock;
+    qint64 m_anchorMediaMs;
+    quint64 m_ticks;
+    quint64 m_samplesPlayed;
+    quint64 m_pointsEmitted;
+    quint64 m_framesEmitted;
     QVariantMap m_statistics;
+
+    // Exact median kept in two heaps, so a followed log can grow without
+    // re-sorting everything read so far.
+    struct RunningMedian {
+        std::priority_queue<double> lower;
+        std::priority_queue<double, std::vector<double>, std::greater<double>> upper;
+        void add(double value);
+        double value() const;
+        int count() const { return int(lower.size() + upper.size()); }
+        void clear() { lower = {}; upper = {}; }
+    };
+
+    bool m_following;
+    RunningMedian m_temperatureMedian;
+    RunningMedian m_pressureMedian;
 };
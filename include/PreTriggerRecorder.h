@@ -0,0 +1,120 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QQueue>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVariantMap>
+#include <QVector>
+#include <atomic>
+#include <deque>
+#include <opencv2/opencv.hpp>
+#include "FrameSource.h"
+
+class QCommandLineParser;
+
+struct PreTriggerConfig {
+    int preTriggerMs = 0;
+    int postTriggerMs = 5000;
+    qint64 maxRingBytes = 64 * 1024 * 1024;
+    bool triggerOnAlert = true;
+
+    bool isEnabled() const { return preTriggerMs > 0; }
+};
+
+// Keeps the last few seconds of a camera's frames in memory as JPEG, within
+// a byte budget. A trigger writes the ring to an event directory and keeps
+// writing every frame until the post-trigger window closes; triggers inside
+// the window extend it. Each event gets an event.json index:
+//
+//   data/events/<camera>_<yyyyMMdd_hhmmss_zzz>/frame_<ms>.jpg
+//   data/events/<camera>_<yyyyMMdd_hhmmss_zzz>/event.json
+//
+// Lives in the camera's thread; frames are encoded on a pool of up to four
+// threads. If encoding still falls behind the capture rate, frames are
+// skipped (counted as ringFramesSkipped) and a warning is logged.
+class PreTriggerRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PreTriggerRecorder(QObject *parent = nullptr);
+    ~PreTriggerRecorder();
+
+    static void addCommandLineOptions(QCommandLineParser &parser);
+    static bool applyCommandLineOptions(const QCommandLineParser &parser, PreTriggerConfig &config, QString *errorMessage);
+
+    void configure(const PreTriggerConfig &config, const QString &cameraId, const QString &dataDirectory);
+    bool isEnabled() const { return m_config.isEnabled(); }
+    const PreTriggerConfig &config() const { return m_config; }
+
+    void addFrame(const cv::Mat &frame, FramePixelFormat format, qint64 timestampMs);
+    void trigger(const QString &reason, qint64 timestampMs);
+    void finish();
+    QVariantMap metrics() const;
+
+signals:
+    void eventRecorded(const QString &directory, int frames, const QStringList &reasons);
+    void error(const QString &message);
+
+private:
+    struct EncodedFrame {
+        qint64 timestampMs;
+        QByteArray jpeg;
+    };
+
+    struct PendingWrite {
+        QString path;
+        QByteArray data;
+        bool durable;
+    };
+
+    struct Event {
+        QString directory;
+        qint64 triggerMs = 0;
+        qint64 endMs = 0;
+        QStringList reasons;
+        QVector<qint64> frames;
+        int preFrames = 0;
+    };
+
+    void addEncoded(qint64 timestampMs, const QByteArray &jpeg);
+    void evict(qint64 newestMs);
+    void queueFrame(const EncodedFrame &frame);
+    void drainWrites();
+    void finishEvent();
+    void updateRingMetrics();
+
+    PreTriggerConfig m_config;
+    QString m_cameraId;
+    QString m_eventsDirectory;
+    QThreadPool m_pool;
+    std::atomic<int> m_encoding;
+    QElapsedTimer m_skipWarningTimer;
+    quint64 m_skippedAtWarning;
+
+    std::deque<EncodedFrame> m_ring;
+    qint64 m_ringBytes;
+
+    bool m_active;
+    Event m_event;
+    QQueue<PendingWrite> m_writeQueue;
+    int m_writesInFlight;
+    QTimer *m_finishTimer;
+
+    // Read by metrics() from other threads.
+    std::atomic<int> m_ringFrames;
+    std::atomic<qint64> m_ringSizeBytes;
+    std::atomic<qint64> m_ringSpanMs;
+    std::atomic<int> m_writesPending;
+    std::atomic<bool> m_eventActive;
+    std::atomic<quint64> m_framesEncoded;
+    std::atomic<quint64> m_framesSkipped;
+    std::atomic<quint64> m_framesEvicted;
+    std::atomic<quint64> m_framesWritten;
+    std::atomic<quint64> m_writeFailures;
+    std::atomic<quint64> m_events;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QString>
+#include <deque>
+
+enum class ResampleMethod {
+    Linear,   // interpolated between the samples either side of the point
+    Previous, // the last sample at or before the point
+    Mean      // mean of the samples in [point, point + interval)
+};
+
+// Converts irregularly spaced samples to a uniform grid, point i lying at
+// startMs + i * intervalMs. Points the samples do not cover (before the
+// first sample, after the last for Linear, empty buckets for Mean) are NaN.
+//
+// resample() works over stored, contiguous columns. The search for each
+// point's samples is done once for all channels. For each channel, a
+// scalar pass gathers the samples either side of every point into
+// contiguous buffers, and only the arithmetic over those buffers is left
+// to the compiler to vectorise. The streaming interface gives the same
+// points for samples pushed one at a time, for sources that are never held
+// in memory.
+class Resampler
+{
+public:
+    static constexpr int MaxChannels = 4;
+    static constexpr qint64 AutoStart = -1;
+
+    Resampler(ResampleMethod method, qint64 intervalMs, int channels, qint64 startMs = AutoStart);
+
+    // Streaming: samples must arrive in time order; earlier ones are
+    // dropped. Completed points are queued for takePoint().
+    void push(qint64 timestampMs, const double *values);
+    void finish();
+    bool takePoint(qint64 &timestampMs, double *values);
+    quint64 droppedSamples() const { return m_dropped; }
+
+    static int gridSize(qint64 startMs, qint64 endMs, qint64 intervalMs);
+    static qint64 alignedStart(ResampleMethod method, qint64 firstMs, qint64 intervalMs);
+    static void resample(ResampleMethod method, const qint64 *timestamps, const double *const *columns,
+                         int count, int channels, qint64 startMs, qint64 intervalMs, int points,
+                         double *const *outputs);
+
+    static bool parseMethod(const QString &text, ResampleMethod &method);
+    static QString methodName(ResampleMethod method);
+
+private:
+    struct Point {
+        qint64 timestampMs;
+        double values[MaxChannels];
+    };
+
+    void emitPoint(const double *values);
+    void emitEmptyPoint();
+
+    ResampleMethod m_method;
+    qint64 m_intervalMs;
+    int m_channels;
+    qint64 m_nextMs;
+    bool m_started;
+    bool m_haveSample;
+    qint64 m_lastMs;
+    double m_last[MaxChannels];
+    double m_sum[MaxChannels];
+    int m_bucketCount;
+    quint64 m_dropped;
+    std::deque<Point> m_ready;
+};
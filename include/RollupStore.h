@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+#include <QVariantMap>
+#include <QVariantList>
+#include <QFile>
+#include <memory>
+
+struct RollupStats {
+    quint64 count = 0;
+    double min = 0.0;
+    double max = 0.0;
+    double sum = 0.0;
+    double sumSquares = 0.0;
+
+    void add(double value);
+    void merge(const RollupStats &other);
+    double mean() const { return count > 0 ? sum / count : 0.0; }
+    double stdDev() const;
+};
+
+struct RollupBucket {
+    qint64 startMs = 0;
+    RollupStats temperature;
+    RollupStats pressure;
+
+    void merge(const RollupBucket &other);
+};
+
+class RollupStore
+{
+public:
+    enum Tier {
+        Second,
+        Minute,
+        Hour,
+        TierCount
+    };
+
+    RollupStore();
+    RollupStore(const RollupStore &other);
+    RollupStore &operator=(const RollupStore &other);
+
+    static qint64 tierInterval(int tier);
+    static QString sidecarPath(const QString &logFilename);
+    static QVariantMap toVariantMap(const RollupBucket &bucket);
+
+    void clear();
+    void add(qint64 timestampMs, double temperature, double pressure);
+    bool isEmpty() const { return m_tiers[Second].isEmpty(); }
+    quint64 sampleCount() const;
+    const QVector<RollupBucket> &buckets(int tier) const { return m_tiers[tier]; }
+
+    RollupBucket summarize(qint64 startMs, qint64 endMs) const;
+    QVector<RollupBucket> series(qint64 startMs, qint64 endMs, int maxPoints, int *tierUsed = nullptr) const;
+
+    bool openOutput(const QString &filename, QString *errorMessage = nullptr);
+    void closeOutput();
+    bool load(const QString &filename, QString *errorMessage = nullptr);
+    bool save(const QString &filename, QString *errorMessage = nullptr) const;
+
+private:
+    RollupBucket summarize(qint64 startMs, qint64 endMs, int tier) const;
+    int lowerBound(int tier, qint64 startMs) const;
+    void writeBucket(int tier, const RollupBucket &bucket);
+
+    QVector<RollupBucket> m_tiers[TierCount];
+    std::unique_ptr<QFile> m_output;
+};
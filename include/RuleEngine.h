@@ -0,0 +1,111 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QVariantMap>
+#include <QVariantList>
+
+class QCommandLineParser;
+
+enum class RuleKind : quint8 {
+    Threshold,
+    RateOfChange,
+    WindowAverage
+};
+
+struct CompiledRule {
+    RuleKind kind;
+    quint8 channel;
+    bool above;
+    double limit;
+    qint64 windowMs;
+};
+
+struct RuleState {
+    bool active = false;
+    bool hasPrevious = false;
+    qint64 previousMs = 0;
+    double previousValue = 0.0;
+    double windowSum = 0.0;
+    int windowStart = 0;
+    QVector<qint64> windowTimes;
+    QVector<double> windowValues;
+};
+
+class RuleEngine : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int ruleCount READ ruleCount NOTIFY rulesChanged)
+    Q_PROPERTY(QStringList activeAlerts READ activeAlerts NOTIFY activeAlertsChanged)
+
+public:
+    enum Channel {
+        Temperature,
+        Pressure,
+        ChannelCount
+    };
+
+    explicit RuleEngine(QObject *parent = nullptr);
+
+    static void addCommandLineOptions(QCommandLineParser &parser);
+    static bool applyCommandLineOptions(const QCommandLineParser &parser, QStringList &rules, QString *errorMessage);
+
+    int ruleCount() const { return m_rules.size(); }
+    QStringList activeAlerts() const;
+
+    Q_INVOKABLE bool addRule(const QString &name, const QString &expression);
+    bool addRules(const QStringList &definitions, QString *errorMessage);
+    Q_INVOKABLE void clearRules();
+    Q_INVOKABLE QVariantList rules() const;
+
+    void setBatchSize(int samples) { m_batchSize = qMax(1, samples); }
+    void setMaxLatency(int intervalMs) { m_flushTimer->setInterval(qMax(1, intervalMs)); }
+    Q_INVOKABLE QVariantMap metrics() const;
+
+    static bool compile(const QString &expression, CompiledRule &rule, QString *errorMessage);
+    static QString channelName(int channel);
+
+public slots:
+    void addSample(qint64 timestampMs, double temperature, double pressure);
+    void flush();
+
+signals:
+    void rulesChanged();
+    void activeAlertsChanged();
+    void alertRaised(const QString &rule, double value, qint64 timestampMs);
+    void alertCleared(const QString &rule, double value, qint64 timestampMs);
+    void error(const QString &message);
+
+private:
+    struct RuleEvent {
+        int rule;
+        bool raised;
+        double value;
+        qint64 timestampMs;
+    };
+
+    static void splitDefinition(const QString &definition, QString &name, QString &expression);
+    void appendRule(const QString &name, const QString &expression, const CompiledRule &rule);
+    void evaluate(int ruleIndex, QVector<RuleEvent> &events);
+
+    QVector<CompiledRule> m_rules;
+    QVector<RuleState> m_states;
+    QStringList m_names;
+    QStringList m_expressions;
+
+    QVector<qint64> m_times;
+    QVector<double> m_columns[ChannelCount];
+    int m_batchSize;
+    QTimer *m_flushTimer;
+
+    quint64 m_batches;
+    quint64 m_samplesEvaluated;
+    quint64 m_alertsRaised;
+    qint64 m_lastBatchNs;
+    qint64 m_maxBatchNs;
+    qint64 m_totalBatchNs;
+    int m_lastBatchSamples;
+};
@@ -3,15 +3,18 @@
 #include <QObject>
 #include <QTimer>
 #include <QDateTime>
+#include <QVariantMap>
+#include <QVector>
 #include <random>
+#include "SharedBusWriter.h"
 
 class SensorDataGenerator : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(bool isRunning READ isRunning NOTIFY runningChanged)
     Q_PROPERTY(double samplingRate READ samplingRate WRITE setSamplingRate NOTIFY samplingRateChanged)
-    Q_PROPERTY(double temperature READ temperature NOTIFY temperatureChanged)
-    Q_PROPERTY(double pressure READ pressure NOTIFY pressureChanged)
+    Q_PROPERTY(double temperature READ temperature NOTIFY readingChanged)
+    Q_PROPERTY(double pressure READ pressure NOTIFY readingChanged)
 
 public:
     explicit SensorDataGenerator(QObject *parent = nullptr);
@@ -25,22 +28,30 @@ public:
     Q_INVOKABLE bool start();
     Q_INVOKABLE void stop();
 
+    bool setBusName(const QString &busName, QString *errorMessage = nullptr);
+    QVariantMap busMetrics() const { return m_busWriter.metrics(); }
+
 signals:
     void runningChanged();
     void samplingRateChanged();
-    void temperatureChanged();
-    void pressureChanged();
-    void dataReady(double temperature, double pressure, const QString &timestamp);
+    void readingChanged();
+    void sampleReady(qint64 timestampMs, double temperature, double pressure);
 
 private slots:
     void generateData();
 
 private:
+    void publishBlock();
+
     QTimer *m_timer;
+    QTimer *m_notifyTimer;
     bool m_isRunning;
     double m_samplingRate; 
     double m_temperature;
     double m_pressure;
+    SharedBusWriter m_busWriter;
+    QVector<SharedBus::Sample> m_busBlock;
+    int m_busBlockSize;
     
     
     std::random_device m_randomDevice;
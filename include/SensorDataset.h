@@ -0,0 +1,105 @@
+#pragma once
+
+#include <QDateTime>
+#include <QList>
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+#include <memory>
+
+struct SensorReading {
+    QDateTime timestamp;
+    qint64 timestampMs;
+    double temperature;
+    double pressure;
+    QString frameFilename;
+};
+
+Q_DECLARE_METATYPE(SensorReading)
+
+// Append-only readings shared by reference between the logger and
+// playback. Readings live in fixed-size chunks that are never moved and
+// never rewritten once published, so a Snapshot is just the chunk table
+// and a row count: it keeps seeing exactly the rows that existed when it
+// was taken, whatever is appended or cleared afterwards. The dataset is
+// written from one thread; snapshots may be passed to any thread.
+class SensorDataset
+{
+public:
+    static constexpr int ChunkShift = 12;
+    static constexpr int ChunkSize = 1 << ChunkShift;
+
+private:
+    struct Chunk {
+        SensorReading readings[ChunkSize];
+    };
+    using ChunkTable = QVector<std::shared_ptr<Chunk>>;
+
+public:
+    class Snapshot
+    {
+    public:
+        class const_iterator
+        {
+        public:
+            const_iterator(const Snapshot *snapshot, int index) : m_snapshot(snapshot), m_index(index) {}
+            const SensorReading &operator*() const { return m_snapshot->at(m_index); }
+            const_iterator &operator++() { ++m_index; return *this; }
+            bool operator!=(const const_iterator &other) const { return m_index != other.m_index; }
+
+        private:
+            const Snapshot *m_snapshot;
+            int m_index;
+        };
+
+        int size() const { return m_size; }
+        bool isEmpty() const { return m_size == 0; }
+        quint64 generation() const { return m_generation; }
+
+        const SensorReading &at(int index) const
+        {
+            return (*m_chunks)[index >> ChunkShift]->readings[index & (ChunkSize - 1)];
+        }
+        const SensorReading &operator[](int index) const { return at(index); }
+        const SensorReading &first() const { return at(0); }
+        const SensorReading &last() const { return at(m_size - 1); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, m_size); }
+
+        // Readings are in timestamp order, so both are binary searches.
+        int lowerBound(qint64 timestampMs) const;
+        int upperBound(qint64 timestampMs) const;
+        QList<SensorReading> mid(int first, int end) const;
+        // Copies rows [first, end) into contiguous per-field arrays.
+        void copyColumns(int first, int end, qint64 *timestamps, double *temperatures, double *pressures) const;
+
+    private:
+        friend class SensorDataset;
+
+        std::shared_ptr<const ChunkTable> m_chunks;
+        int m_size = 0;
+        quint64 m_generation = 0;
+    };
+
+    SensorDataset();
+
+    void clear();
+    void append(const SensorReading &reading);
+
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+    const SensorReading &at(int index) const
+    {
+        return (*m_chunks)[index >> ChunkShift]->readings[index & (ChunkSize - 1)];
+    }
+    const SensorReading &first() const { return at(0); }
+    const SensorReading &last() const { return at(m_size - 1); }
+    int chunkCount() const { return m_chunks->size(); }
+
+    Snapshot snapshot() const;
+
+private:
+    std::shared_ptr<const ChunkTable> m_chunks;
+    int m_size;
+    quint64 m_generation;
+};
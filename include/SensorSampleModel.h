@@ -0,0 +1,77 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QTimer>
+#include <QVariantList>
+#include <QVariantMap>
+#include <QVector>
+
+// Ring of the most recent sensor samples for live views. Samples are
+// buffered as they arrive and committed to QML at most once per display
+// refresh: one beginInsertRows for the whole batch, one beginRemoveRows
+// for whatever fell off the front, and one latestChanged notification.
+class SensorSampleModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+    Q_PROPERTY(int capacity READ capacity WRITE setCapacity NOTIFY capacityChanged)
+    Q_PROPERTY(double latestTemperature READ latestTemperature NOTIFY latestChanged)
+    Q_PROPERTY(double latestPressure READ latestPressure NOTIFY latestChanged)
+    Q_PROPERTY(qint64 latestTimestampMs READ latestTimestampMs NOTIFY latestChanged)
+
+public:
+    enum Roles {
+        TimestampMsRole = Qt::UserRole + 1,
+        TemperatureRole,
+        PressureRole
+    };
+
+    explicit SensorSampleModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int capacity() const { return m_capacity; }
+    void setCapacity(int capacity);
+    double latestTemperature() const { return m_latest.temperature; }
+    double latestPressure() const { return m_latest.pressure; }
+    qint64 latestTimestampMs() const { return m_latest.timestampMs; }
+    int commitIntervalMs() const { return m_commitTimer->interval(); }
+
+    static int displayIntervalMs();
+
+    Q_INVOKABLE QVariantList values(const QString &role, int maxPoints) const;
+    Q_INVOKABLE void clear();
+    Q_INVOKABLE QVariantMap metrics() const;
+
+public slots:
+    void addSample(qint64 timestampMs, double temperature, double pressure);
+    void commit();
+
+signals:
+    void countChanged();
+    void capacityChanged();
+    void latestChanged();
+
+private:
+    struct Sample {
+        qint64 timestampMs;
+        double temperature;
+        double pressure;
+    };
+
+    const Sample &at(int row) const { return m_ring[(m_head + row) % m_capacity]; }
+
+    QVector<Sample> m_ring;
+    int m_capacity;
+    int m_head;
+    int m_count;
+    QVector<Sample> m_pending;
+    Sample m_latest;
+    QTimer *m_commitTimer;
+    quint64 m_samplesReceived;
+    quint64 m_samplesDiscarded;
+    quint64 m_commits;
+    int m_largestBatch;
+};
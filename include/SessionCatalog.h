@@ -0,0 +1,84 @@
+#pragma once
+
+#include <QObject>
+#include <QFile>
+#include <QHash>
+#include <QSet>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVariantList>
+#include "FrameIndex.h"
+
+struct SessionInfo {
+    QString logFile;        // absolute path
+    qint64 startMs = -1;
+    qint64 endMs = -1;
+    qint64 rows = 0;
+    qint64 frames = 0;
+    qint64 sizeBytes = 0;   // log size when last catalogued
+    QString frameDirectory; // where the session's frames are found; empty until probed
+    bool recording = false;
+};
+
+// Catalog of the sessions in the data directory, kept in an append-only
+// journal (sessions.catalog, one JSON object per line; later lines win).
+// Recording updates it as rows and frames are written, so listing sessions
+// and resolving playback frames never touch the directory.
+class SessionCatalog : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int sessionCount READ sessionCount NOTIFY sessionsChanged)
+    Q_PROPERTY(bool scanning READ isScanning NOTIFY scanningChanged)
+
+public:
+    explicit SessionCatalog(QObject *parent = nullptr);
+    ~SessionCatalog();
+
+    bool open(const QString &dataDirectory, QString *errorMessage = nullptr);
+    QString journalPath() const;
+
+    int sessionCount() const { return m_sessions.size(); }
+    bool isScanning() const { return m_pendingScans > 0; }
+    bool session(const QString &logFile, SessionInfo &info) const;
+    Q_INVOKABLE QVariantList sessions() const;
+    Q_INVOKABLE void rescan();
+
+    // Recording
+    void beginSession(const QString &logFile);
+    void addRows(const QString &logFile, int rows, qint64 firstMs, qint64 lastMs);
+    void addFrame(const QString &logFile, qint64 timestampMs);
+    void endSession(const QString &logFile, qint64 sizeBytes);
+
+    // Playback
+    void updateSession(const SessionInfo &info);
+    void setActiveSession(const QString &logFile, const FrameIndex &frames);
+    QString resolveFrame(const QString &frameFilename) const;
+
+    static bool scanLogFile(const QString &logFile, SessionInfo &info);
+
+signals:
+    void sessionsChanged();
+    void scanningChanged();
+    void error(const QString &message);
+
+private:
+    QString key(const QString &logFile) const;
+    QString storedName(const QString &logFile) const;
+    void replayJournal();
+    QByteArray journalLine(const SessionInfo &info, bool removed) const;
+    void appendJournal(const SessionInfo &info, bool removed = false);
+    void compactJournal();
+    void checkpoint();
+    void reconcile();
+    void scanInBackground(const QStringList &logFiles);
+
+    QString m_dataDirectory;
+    QHash<QString, SessionInfo> m_sessions;
+    QFile m_journal;
+    int m_journalLines;
+    QSet<QString> m_dirty;
+    QTimer *m_checkpointTimer;
+    QThreadPool m_pool;
+    int m_pendingScans;
+    QString m_activeFrameDirectory;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QObject>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVariantList>
+#include <QVariantMap>
+#include <QVector>
+#include "Resampler.h"
+#include "RollupStore.h"
+#include "SensorDataset.h"
+
+struct ComparedSession {
+    QString logFile;
+    QString name;
+    qint64 startMs = 0;
+    qint64 durationMs = 0;
+    int rows = 0;
+    qint64 loadMs = 0;
+    QString error;
+    RollupStats temperature;
+    RollupStats pressure;
+    // Values on the shared grid: point i is i * intervalMs after the
+    // session's first reading.
+    QVector<double> alignedTemperature;
+    QVector<double> alignedPressure;
+};
+
+// Loads several recorded sessions side by side for comparison. Each log is
+// read, summarised and resampled on its own pool thread, so the load takes
+// about as long as the slowest session. Sessions are aligned on time since
+// their first reading and resampled onto one grid, which gives every
+// series the same x axis.
+class SessionComparison : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool loading READ isLoading NOTIFY loadingChanged)
+    Q_PROPERTY(int sessionCount READ sessionCount NOTIFY sessionsChanged)
+    Q_PROPERTY(int intervalMs READ intervalMs NOTIFY sessionsChanged)
+    Q_PROPERTY(QString method READ method NOTIFY sessionsChanged)
+    Q_PROPERTY(qint64 durationMs READ durationMs NOTIFY sessionsChanged)
+
+public:
+    explicit SessionComparison(QObject *parent = nullptr);
+    ~SessionComparison();
+
+    bool isLoading() const { return m_pending > 0; }
+    int sessionCount() const { return m_sessions.size(); }
+    int intervalMs() const { return m_intervalMs; }
+    QString method() const { return Resampler::methodName(m_method); }
+    qint64 durationMs() const;
+
+    Q_INVOKABLE bool load(const QStringList &logFiles, int intervalMs, const QString &method = "linear");
+    Q_INVOKABLE void clear();
+    Q_INVOKABLE QVariantList sessions() const;
+    Q_INVOKABLE QVariantList series(int session, const QString &role, int maxPoints) const;
+    Q_INVOKABLE QVariantList meanSeries(const QString &role, int maxPoints) const;
+    Q_INVOKABLE QVariantMap statistics() const;
+
+    static ComparedSession loadSession(const QString &logFile, int intervalMs, ResampleMethod method);
+
+signals:
+    void loadingChanged();
+    void sessionsChanged();
+    void error(const QString &message);
+
+private:
+    const QVector<double> *column(int session, const QString &role) const;
+    static QVariantList decimate(const QVector<double> &values, int intervalMs, int maxPoints);
+
+    QThreadPool m_pool;
+    QVector<ComparedSession> m_sessions;
+    int m_intervalMs;
+    ResampleMethod m_method;
+    int m_pending;
+    quint64 m_request;
+    QElapsedTimer m_loadTimer;
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Memory layout of the shared-memory bus, used by the dashboard (writer)
+// and by reader processes. Plain C++ so readers need neither Qt nor OpenCV.
+//
+// Each stream is one POSIX shm object "/<bus>.<stream>", e.g.
+// "/dashboard.frames.cam0" or "/dashboard.samples". It holds a Header
+// (with the reader table) followed by slotCount slots of slotStride bytes.
+// Message n (counting from 1) lives in slot (n - 1) % slotCount.
+//
+// Every slot is guarded by a seqlock. The writer stores 2n - 1 in
+// SlotHeader::lock, writes the slot and then stores 2n. A reader that sees
+// the same even value 2n before and after looking at the slot has read
+// message n intact. The writer never waits for readers: a reader that falls
+// more than slotCount messages behind loses the overwritten ones.
+namespace SharedBus {
+
+constexpr uint32_t Magic = 0x42445343; // "CSDB"
+constexpr uint32_t Version = 1;
+constexpr int MaxReaders = 16;
+constexpr std::size_t Alignment = 64;
+
+enum StreamKind : uint32_t {
+    FrameStream = 1,
+    SampleStream = 2
+};
+
+// SlotHeader::format for frames, matching FramePixelFormat
+enum PixelFormat : uint32_t {
+    BGR = 0,
+    BGRA = 1,
+    Gray = 2,
+    YUYV = 3,
+    MJPEG = 4
+};
+
+enum ReaderFlag : uint32_t {
+    ReaderSlow = 1,   // more than half the ring behind
+    ReaderLapped = 2  // messages were overwritten before it read them
+};
+
+struct alignas(Alignment) ReaderEntry {
+    std::atomic<uint32_t> pid;         // 0 when the entry is free
+    std::atomic<uint32_t> flags;       // ReaderFlag bits, set by the writer
+    std::atomic<uint64_t> readSeq;     // last message the reader consumed
+    std::atomic<uint64_t> heartbeatMs; // updated by the reader on every poll
+};
+
+struct alignas(Alignment) Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t kind;
+    uint32_t slotCount;
+    uint64_t slotSize;    // payload bytes per slot
+    uint64_t slotStride;  // SlotHeader plus payload, aligned
+    uint64_t slotsOffset; // from the start of the segment
+    std::atomic<uint32_t> writerPid;
+    std::atomic<uint32_t> closed; // the writer stopped or replaced the segment
+
+    alignas(Alignment) std::atomic<uint64_t> writeSeq; // last published message, 0 for none
+
+    ReaderEntry readers[MaxReaders];
+};
+
+struct alignas(Alignment) SlotHeader {
+    std::atomic<uint64_t> lock;
+    int64_t timestampMs;
+    uint32_t width;  // frames: pixels; samples: number of samples in the block
+    uint32_t height;
+    uint32_t stride; // bytes per row, 0 for compressed frames
+    uint32_t format; // PixelFormat for frames
+    uint64_t size;   // payload bytes
+};
+
+// Sample streams carry blocks of up to SamplesPerBlock readings per message.
+struct Sample {
+    int64_t timestampMs;
+    double temperature;
+    double pressure;
+};
+
+constexpr uint32_t SamplesPerBlock = 64;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the bus needs lock-free 64-bit atomics");
+
+inline std::string segmentName(const std::string &bus, const std::string &stream)
+{
+    return "/" + bus + "." + stream;
+}
+
+inline std::size_t alignUp(std::size_t value)
+{
+    return (value + Alignment - 1) / Alignment * Alignment;
+}
+
+inline SlotHeader *slotAt(void *segment, const Header *header, uint64_t seq)
+{
+    auto *base = static_cast<char *>(segment) + header->slotsOffset;
+    return reinterpret_cast<SlotHeader *>(base + ((seq - 1) % header->slotCount) * header->slotStride);
+}
+
+inline uint8_t *payload(SlotHeader *slot)
+{
+    return reinterpret_cast<uint8_t *>(slot) + alignUp(sizeof(SlotHeader));
+}
+
+}
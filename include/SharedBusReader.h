@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "SharedBusLayout.h"
+
+// Reader side of the shared-memory bus, for analysis processes on the same
+// host. Depends only on the C++ standard library and POSIX; link against
+// the csd_bus_reader library.
+//
+//   SharedBusReader reader;
+//   reader.open("dashboard", "frames.cam0");
+//   SharedBusReader::Message message;
+//   while (reader.next(message)) {
+//       process(message.data, message.size);
+//       if (!reader.isValid(message)) { /* overwritten while in use */ }
+//   }
+class SharedBusReader
+{
+public:
+    enum StartPosition {
+        StartAtLatest, // only messages published after open()
+        StartAtOldest  // everything still in the ring
+    };
+
+    struct Message {
+        uint64_t seq = 0;
+        int64_t timestampMs = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t stride = 0;
+        uint32_t format = 0;
+        const uint8_t *data = nullptr; // points into the ring, no copy
+        uint64_t size = 0;
+    };
+
+    SharedBusReader() = default;
+    ~SharedBusReader();
+
+    SharedBusReader(const SharedBusReader &) = delete;
+    SharedBusReader &operator=(const SharedBusReader &) = delete;
+
+    bool open(const std::string &bus, const std::string &stream,
+              StartPosition start = StartAtLatest, std::string *errorMessage = nullptr);
+    void close();
+
+    bool isOpen() const { return m_header != nullptr; }
+    uint32_t kind() const { return m_header ? m_header->kind : 0; }
+    uint32_t slotCount() const { return m_header ? m_header->slotCount : 0; }
+
+    // False once the writer has stopped, exited or replaced the segment;
+    // reopen to follow a new one.
+    bool writerAlive() const;
+
+    // Takes the next message without copying. The data stays in the ring
+    // and can be overwritten once the writer laps this reader, so check
+    // isValid() after using it. Returns false when there is nothing new.
+    bool next(Message &message);
+    bool isValid(const Message &message) const;
+
+    // Like next(), but copies the payload into buffer and only returns
+    // messages that were read intact.
+    bool copyNext(std::vector<uint8_t> &buffer, Message &message);
+
+    // Sample streams: the readings in a message (SlotHeader::width of them).
+    static const SharedBus::Sample *samples(const Message &message)
+    {
+        return reinterpret_cast<const SharedBus::Sample *>(message.data);
+    }
+
+    // Slow-reader policy: the writer flags readers that fall more than half
+    // a ring behind. A reader that cannot keep up can drop its backlog.
+    bool isSlow() const;
+    void skipToLatest();
+
+    uint64_t latestSeq() const;
+    uint64_t lastSeq() const { return m_readSeq; }
+    uint64_t lost() const { return m_lost; }
+
+private:
+    void acknowledge(uint64_t seq);
+
+    void *m_segment = nullptr;
+    std::size_t m_segmentSize = 0;
+    SharedBus::Header *m_header = nullptr;
+    SharedBus::ReaderEntry *m_entry = nullptr;
+    uint64_t m_readSeq = 0;
+    uint64_t m_lost = 0;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QString>
+#include <QVariantMap>
+#include <QElapsedTimer>
+#include <atomic>
+#include "SharedBusLayout.h"
+
+// Publishes one stream of the shared-memory bus (see SharedBusLayout.h).
+// Single producer: publish() must always be called from the same thread.
+class SharedBusWriter
+{
+public:
+    SharedBusWriter();
+    ~SharedBusWriter();
+
+    SharedBusWriter(const SharedBusWriter &) = delete;
+    SharedBusWriter &operator=(const SharedBusWriter &) = delete;
+
+    static bool isValidBusName(const QString &bus);
+
+    bool create(const QString &bus, const QString &stream, SharedBus::StreamKind kind,
+                int slotCount, quint64 slotSize, QString *errorMessage = nullptr);
+    void destroy();
+
+    bool isOpen() const { return m_header != nullptr; }
+    QString name() const { return m_name; }
+    quint64 slotSize() const { return m_header ? m_header->slotSize : 0; }
+
+    bool publish(qint64 timestampMs, quint32 width, quint32 height, quint32 stride, quint32 format,
+                 const void *data, quint64 size);
+
+    QVariantMap metrics() const;
+
+private:
+    void checkReaders(quint64 seq);
+
+    QString m_name;
+    void *m_segment;
+    size_t m_segmentSize;
+    SharedBus::Header *m_header;
+    QElapsedTimer m_livenessTimer;
+    std::atomic<quint64> m_published;
+    std::atomic<quint64> m_oversized;
+    std::atomic<quint64> m_slowReaderEvents;
+    std::atomic<quint64> m_lappedReaderEvents;
+    std::atomic<quint64> m_readersReclaimed;
+    std::atomic<int> m_readers;
+    std::atomic<int> m_slowReaders;
+    std::atomic<quint64> m_maxLag;
+};
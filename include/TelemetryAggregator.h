@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHash>
+#include <QFile>
+#include <QVariantMap>
+#include <memory>
+
+// Minimal stand-in for the central aggregator: accepts TelemetryStreamer
+// connections, acknowledges batches and appends what it receives to one
+// CSV per station. Enough to exercise streaming, spill and resume on a
+// single host.
+class TelemetryAggregator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TelemetryAggregator(QObject *parent = nullptr);
+    ~TelemetryAggregator();
+
+    bool listen(const QString &host, quint16 port, const QString &outputDirectory, QString *errorMessage = nullptr);
+    void close();
+    bool isListening() const { return m_server.isListening(); }
+    quint16 port() const { return m_server.serverPort(); }
+    Q_INVOKABLE QVariantMap metrics() const;
+
+signals:
+    void batchReceived(const QString &station, quint64 seq, int samples, int frames);
+
+private slots:
+    void acceptConnections();
+
+private:
+    struct Station {
+        quint64 lastSeq = 0;
+        quint64 batches = 0;
+        quint64 samples = 0;
+        quint64 frames = 0;
+        quint64 duplicates = 0;
+        std::unique_ptr<QFile> output;
+    };
+
+    void readMessages(QTcpSocket *socket);
+    bool handleMessage(QTcpSocket *socket, quint8 type, const QByteArray &payload);
+    bool storeBatch(const QString &stationId, Station &station, const QByteArray &body, int &samples, int &frames);
+    void send(QTcpSocket *socket, quint8 type, quint64 seq);
+
+    QTcpServer m_server;
+    QString m_outputDirectory;
+    QHash<QTcpSocket *, QByteArray> m_buffers;
+    QHash<QTcpSocket *, QString> m_socketStations;
+    QHash<QString, std::shared_ptr<Station>> m_stations;
+    quint64 m_connections;
+    quint64 m_rejected;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QtGlobal>
+
+// Wire format shared by TelemetryStreamer and TelemetryAggregator. Every
+// message is a little-endian quint32 length (of what follows), a quint8
+// type, and the payload:
+//
+//   Hello    (client)  char[4] "CSDS", quint16 version, quint16 n, n bytes station id (UTF-8)
+//   Batch    (client)  quint64 seq, quint16 samples, quint16 frames, qint64 baseMs,
+//                      samples x (quint32 deltaMs, double temperature, double pressure),
+//                      frames  x (quint32 deltaMs, quint16 n, n bytes file name (UTF-8))
+//   Welcome  (server)  quint64 last acknowledged seq for the station
+//   Ack      (server)  quint64 seq, cumulative
+//
+// Sequence numbers are per station and only grow, so a client that
+// reconnects resends everything after the Welcome seq. Delivery is at least
+// once; the aggregator drops batches it has already acknowledged.
+namespace TelemetryProtocol {
+
+const char Magic[4] = {'C', 'S', 'D', 'S'};
+const quint16 Version = 1;
+
+enum MessageType : quint8 {
+    Hello = 0x01,
+    Batch = 0x02,
+    Welcome = 0x81,
+    Ack = 0x82
+};
+
+const int MaxMessageBytes = 16 * 1024 * 1024;
+const int MaxBatchEntries = 0xFFFF;
+
+}
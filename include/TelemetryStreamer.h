@@ -0,0 +1,127 @@
+#pragma once
+
+#include <QObject>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QQueue>
+#include <QVariantMap>
+#include <QVector>
+
+class QCommandLineParser;
+
+struct TelemetryConfig {
+    QString host;
+    quint16 port = 0;
+    QString stationId;
+    int batchSize = 256;
+    int maxLatencyMs = 500;
+    qint64 maxBufferedBytes = 4 * 1024 * 1024;
+    qint64 maxSpillBytes = 256 * 1024 * 1024;
+    bool includeFrames = false;
+
+    bool isEnabled() const { return !host.isEmpty() && port != 0; }
+};
+
+// Streams sensor readings (and optionally saved frame names) to a
+// TelemetryAggregator as compact binary batches. Batches stay queued until
+// acknowledged. Past maxBufferedBytes they spill to a file in the data
+// directory, and after a reconnect everything past the aggregator's last
+// acknowledged sequence is sent again.
+class TelemetryStreamer : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool connected READ isConnected NOTIFY connectedChanged)
+
+public:
+    explicit TelemetryStreamer(QObject *parent = nullptr);
+    ~TelemetryStreamer();
+
+    static void addCommandLineOptions(QCommandLineParser &parser);
+    static bool applyCommandLineOptions(const QCommandLineParser &parser, TelemetryConfig &config, QString *errorMessage);
+    static bool parseEndpoint(const QString &text, QString &host, quint16 &port);
+
+    bool start(const TelemetryConfig &config, const QString &spillDirectory, QString *errorMessage = nullptr);
+    void stop();
+    bool isConnected() const { return m_connected; }
+    const TelemetryConfig &config() const { return m_config; }
+    Q_INVOKABLE QVariantMap metrics() const;
+
+public slots:
+    void addSample(qint64 timestampMs, double temperature, double pressure);
+    void addFrame(const QString &frameFilename, qint64 timestampMs);
+    void flush();
+
+signals:
+    void connectedChanged();
+    void error(const QString &message);
+
+private slots:
+    void connectToAggregator();
+    void onConnected();
+    void onDisconnected();
+    void onReadyRead();
+    void sendPending();
+
+private:
+    struct Sample {
+        qint64 timestampMs;
+        double temperature;
+        double pressure;
+    };
+
+    struct FrameRef {
+        qint64 timestampMs;
+        QString filename;
+    };
+
+    struct QueuedBatch {
+        quint64 seq = 0; // 0 until first sent
+        QByteArray body;
+    };
+
+    QByteArray encodeBatch() const;
+    void enqueue(QueuedBatch batch);
+    bool spill(const QueuedBatch &batch);
+    void refillFromSpill();
+    void resetSpill();
+    void acknowledge(quint64 seq);
+    void scheduleReconnect();
+    void setConnected(bool connected);
+
+    TelemetryConfig m_config;
+    QTcpSocket *m_socket;
+    QTimer *m_latencyTimer;
+    QTimer *m_reconnectTimer;
+    int m_reconnectDelayMs;
+    bool m_running;
+    bool m_connected;
+    bool m_welcomed;
+    bool m_everWelcomed;
+    QByteArray m_readBuffer;
+
+    QVector<Sample> m_samples;
+    QVector<FrameRef> m_frames;
+
+    // Oldest first: unacknowledged batches in memory, then any in the spill file.
+    QQueue<QueuedBatch> m_queue;
+    int m_sentCount;
+    qint64 m_queuedBytes;
+    QFile m_spillFile;
+    qint64 m_spillReadOffset;
+    quint64 m_lastSeq;
+    quint64 m_lastAckedSeq;
+
+    QElapsedTimer m_ackTimer;
+    quint64 m_batchesSent;
+    quint64 m_batchesAcked;
+    quint64 m_batchesResent;
+    quint64 m_batchesSpilled;
+    quint64 m_batchesDropped;
+    quint64 m_samplesQueued;
+    quint64 m_bytesSent;
+    quint64 m_reconnects;
+    double m_ackLatencyMs;
+    bool m_dropReported;
+};
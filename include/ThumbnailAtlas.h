@@ -0,0 +1,77 @@
+#pragma once
+
+#include <QObject>
+#include <QFile>
+#include <QImage>
+#include <QReadWriteLock>
+#include <QThreadPool>
+#include <QVector>
+#include <atomic>
+#include <opencv2/opencv.hpp>
+#include "FrameIndex.h"
+
+// Fixed-size thumbnails of a session's saved frames, packed into one
+// sidecar file next to the log:
+//
+//   header   "CSDT", uint32 version, uint32 width, uint32 height, uint32 reserved x2
+//   records  int64 timestampMs, width * height * 3 bytes of RGB888
+//
+// Records are appended while recording. For playback the file is
+// memory-mapped, and a thumbnail is served straight from the mapping.
+class ThumbnailAtlas : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool ready READ isReady NOTIFY readyChanged)
+    Q_PROPERTY(int count READ count NOTIFY readyChanged)
+    Q_PROPERTY(bool building READ isBuilding NOTIFY buildingChanged)
+
+public:
+    static const int ThumbnailWidth = 96;
+    static const int ThumbnailHeight = 72;
+
+    explicit ThumbnailAtlas(QObject *parent = nullptr);
+    ~ThumbnailAtlas();
+
+    static QString sidecarPath(const QString &logFilename);
+    static bool makeThumbnail(const QString &framePath, qint64 timestampMs, QByteArray &record);
+
+    // Recording
+    bool startRecording(const QString &logFilename, QString *errorMessage = nullptr);
+    void addFrame(const QString &framePath, qint64 timestampMs);
+    void stopRecording();
+
+    // Playback. A live session's sidecar may still be appended to by its
+    // recorder, so it is only mapped as far as it has been written and is
+    // never rebuilt.
+    void open(const QString &logFilename, const FrameIndex &frames, bool live = false);
+    void close();
+
+    bool isReady() const;
+    bool isBuilding() const { return m_building.load(); }
+    int count() const;
+    QImage thumbnailAt(qint64 timestampMs) const;
+
+signals:
+    void readyChanged();
+    void buildingChanged();
+    void buildProgress(int done, int total);
+    void error(const QString &message);
+
+private:
+    static int recordSize();
+    static QByteArray header();
+    bool map(const QString &path, int expectedFrames, QString *errorMessage);
+    void build(const QString &logFilename, const FrameIndex &frames, const QString &path, int generation);
+    void setBuilding(bool building);
+
+    QThreadPool m_pool;
+    int m_recordFileId;
+    std::atomic<bool> m_building;
+    std::atomic<int> m_generation;
+
+    mutable QReadWriteLock m_lock;
+    QFile m_file;
+    const uchar *m_records;
+    QVector<qint64> m_timestamps;
+    QVector<int> m_order;
+};
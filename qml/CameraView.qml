@@ -10,23 +10,24 @@ Rectangle {
 
     property alias imageSource: cameraImage.source
     property bool isPlaybackMode: false
+    property string cameraId: "current"
 
     Image {
         id: cameraImage
         anchors.fill: parent
         anchors.margins: 2
         fillMode: Image.PreserveAspectFit
-        source: "image://camera/current"
+        source: "image://camera/" + root.cameraId
         cache: false
         
         Timer {
             id: liveRefreshTimer
             interval: 33
-            running: cameraCapture.isRunning && !root.isPlaybackMode
+            running: cameraManager.isRunning && !root.isPlaybackMode
             repeat: true
             onTriggered: {
                 var timestamp = Date.now()
-                cameraImage.source = "image://camera/current?" + timestamp
+                cameraImage.source = "image://camera/" + root.cameraId + "?" + timestamp
             }
         }
         
@@ -37,17 +38,27 @@ Rectangle {
                 if (root.isPlaybackMode) {
                     // Force image refresh by changing source
                     var refreshTimestamp = Date.now()
-                    cameraImage.source = "image://camera/current?" + refreshTimestamp
+                    cameraImage.source = "image://camera/" + root.cameraId + "?" + refreshTimestamp
                 }
             }
         }
         
         Text {
             anchors.centerIn: parent
-            text: "No Camera Feed"
+            text: {
+                if (root.isPlaybackMode || !cameraManager.isRunning)
+                    return "No Camera Feed"
+                switch (cameraManager.cameraState) {
+                case "opening": return "Opening camera..."
+                case "warming": return "Waiting for first frame..."
+                case "failed": return "Camera unavailable, retrying..."
+                default: return "No Camera Feed"
+                }
+            }
             color: "#888888"
             font.pointSize: 14
             visible: cameraImage.status !== Image.Ready
+                     || (!root.isPlaybackMode && cameraManager.isRunning && cameraManager.cameraState !== "live")
         }
     }
 
@@ -60,7 +71,7 @@ Rectangle {
         anchors.top: parent.top
         anchors.right: parent.right
         anchors.margins: 10
-        visible: cameraCapture.isRunning
+        visible: cameraManager.isRunning
 
         SequentialAnimation on opacity {
             running: recordingIndicator.visible
@@ -78,6 +89,6 @@ Rectangle {
         color: "#ff0000"
         font.bold: true
         font.pointSize: 10
-        visible: cameraCapture.isRunning
+        visible: cameraManager.isRunning
     }
 }
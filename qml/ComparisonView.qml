@@ -0,0 +1,224 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import QtQuick.Layouts 1.15
+
+Dialog {
+    id: root
+    modal: true
+    anchors.centerIn: parent
+    width: 900
+    height: 640
+    title: "Compare Sessions"
+
+    property var catalogSessions: []
+    property var selected: ({})
+    property var compared: []
+    property var stats: ({})
+    readonly property var seriesColors: ["#0066cc", "#dc3545", "#28a745", "#ff9800", "#6f42c1",
+                                    "#17a2b8", "#e83e8c", "#795548", "#607d8b", "#333333"]
+
+    function refresh() {
+        catalogSessions = sessionCatalog.sessions()
+    }
+
+    function selectedFiles() {
+        var files = []
+        for (var i = 0; i < catalogSessions.length; i++) {
+            if (selected[catalogSessions[i].logFile]) {
+                files.push(catalogSessions[i].logFile)
+            }
+        }
+        return files
+    }
+
+    function updateResults() {
+        compared = sessionComparison.sessions()
+        stats = sessionComparison.statistics()
+        temperatureOverlay.requestPaint()
+        pressureOverlay.requestPaint()
+    }
+
+    onOpened: refresh()
+
+    Connections {
+        target: sessionComparison
+        function onSessionsChanged() {
+            if (!sessionComparison.loading) {
+                root.updateResults()
+            }
+        }
+    }
+
+    component Overlay: Canvas {
+        property string role: "temperature"
+        property string label: ""
+
+        onPaint: {
+            var ctx = getContext("2d")
+            ctx.clearRect(0, 0, width, height)
+            ctx.fillStyle = "#333333"
+            ctx.fillText(label, 4, 12)
+
+            var duration = sessionComparison.durationMs / 1000
+            if (duration <= 0) {
+                return
+            }
+
+            var all = []
+            var low = Number.MAX_VALUE
+            var high = -Number.MAX_VALUE
+            for (var s = 0; s < root.compared.length; s++) {
+                var points = sessionComparison.series(s, role, Math.max(2, Math.floor(width)))
+                all.push(points)
+                for (var i = 0; i < points.length; i++) {
+                    low = Math.min(low, points[i].y)
+                    high = Math.max(high, points[i].y)
+                }
+            }
+            if (high <= low) {
+                high = low + 1
+            }
+
+            for (var k = 0; k < all.length; k++) {
+                var series = all[k]
+                if (series.length < 2) {
+                    continue
+                }
+                ctx.strokeStyle = root.seriesColors[k % root.seriesColors.length]
+                ctx.lineWidth = 1.5
+                ctx.beginPath()
+                for (var p = 0; p < series.length; p++) {
+                    var x = series[p].x / duration * width
+                    var y = height - (series[p].y - low) / (high - low) * (height - 20) - 4
+                    if (p === 0) {
+                        ctx.moveTo(x, y)
+                    } else {
+                        ctx.lineTo(x, y)
+                    }
+                }
+                ctx.stroke()
+            }
+
+            ctx.fillStyle = "#666666"
+            ctx.fillText(high.toFixed(2), width - 50, 24)
+            ctx.fillText(low.toFixed(2), width - 50, height - 6)
+        }
+    }
+
+    RowLayout {
+        anchors.fill: parent
+        spacing: 10
+
+        ColumnLayout {
+            Layout.preferredWidth: 260
+            Layout.fillHeight: true
+
+            ListView {
+                id: catalogList
+                Layout.fillWidth: true
+                Layout.fillHeight: true
+                clip: true
+                model: root.catalogSessions
+                ScrollBar.vertical: ScrollBar {}
+
+                delegate: CheckDelegate {
+                    width: catalogList.width
+                    text: modelData.name
+                    checked: root.selected[modelData.logFile] === true
+                    onToggled: {
+                        var copy = root.selected
+                        copy[modelData.logFile] = checked
+                        root.selected = copy
+                    }
+                }
+            }
+
+            RowLayout {
+                Label { text: "Grid (ms)" }
+                SpinBox {
+                    id: intervalBox
+                    from: 10
+                    to: 60000
+                    stepSize: 100
+                    value: 1000
+                    editable: true
+                }
+            }
+
+            RowLayout {
+                Label { text: "Method" }
+                ComboBox {
+                    id: methodBox
+                    Layout.fillWidth: true
+                    model: ["linear", "previous", "mean"]
+                }
+            }
+
+            Button {
+                text: sessionComparison.loading ? "Loading..." : "Compare"
+                Layout.fillWidth: true
+                highlighted: true
+                enabled: !sessionComparison.loading && root.selectedFiles().length > 0
+                onClicked: sessionComparison.load(root.selectedFiles(), intervalBox.value, methodBox.currentText)
+            }
+        }
+
+        ColumnLayout {
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+
+            Overlay {
+                id: temperatureOverlay
+                role: "temperature"
+                label: "Temperature (C) vs. time since start"
+                Layout.fillWidth: true
+                Layout.fillHeight: true
+            }
+
+            Overlay {
+                id: pressureOverlay
+                role: "pressure"
+                label: "Pressure (hPa) vs. time since start"
+                Layout.fillWidth: true
+                Layout.fillHeight: true
+            }
+
+            Flow {
+                Layout.fillWidth: true
+                spacing: 12
+
+                Repeater {
+                    model: root.compared
+                    Row {
+                        spacing: 4
+                        Rectangle {
+                            width: 10
+                            height: 10
+                            color: root.seriesColors[index % root.seriesColors.length]
+                            anchors.verticalCenter: parent.verticalCenter
+                        }
+                        Label {
+                            text: modelData.name + (modelData.error ? " (failed)" : "")
+                            font.pointSize: 9
+                        }
+                    }
+                }
+            }
+
+            Label {
+                Layout.fillWidth: true
+                visible: root.stats.loadedSessions > 0
+                wrapMode: Text.WordWrap
+                font.pointSize: 9
+                color: "#666666"
+                text: root.stats.loadedSessions > 0
+                      ? "Pooled temperature " + root.stats.temperatureMean.toFixed(2) + " ± " + root.stats.temperatureStdDev.toFixed(2)
+                        + " C, pressure " + root.stats.pressureMean.toFixed(2) + " ± " + root.stats.pressureStdDev.toFixed(2)
+                        + " hPa  |  mean spread between sessions " + root.stats.temperatureMeanSpread.toFixed(2) + " C, "
+                        + root.stats.pressureMeanSpread.toFixed(2) + " hPa over the first "
+                        + (root.stats.overlapMs / 1000).toFixed(0) + " s"
+                      : ""
+            }
+        }
+    }
+}
@@ -12,6 +12,7 @@ Rectangle {
     signal startRecording()
     signal stopRecording()
     signal loadData()
+    signal reviewRecording()
 
     ColumnLayout {
         anchors.fill: parent
@@ -32,7 +33,7 @@ Rectangle {
             Button {
                 id: startButton
                 text: "Start Acquisition"
-                enabled: !cameraCapture.isRunning && !sensorGenerator.isRunning
+                enabled: !cameraManager.isRunning && !sensorGenerator.isRunning
                 Layout.fillWidth: true
                 
                 background: Rectangle {
@@ -56,7 +57,7 @@ Rectangle {
             Button {
                 id: stopButton
                 text: "Stop Acquisition"
-                enabled: cameraCapture.isRunning || sensorGenerator.isRunning
+                enabled: cameraManager.isRunning || sensorGenerator.isRunning
                 Layout.fillWidth: true
                 
                 background: Rectangle {
@@ -81,7 +82,7 @@ Rectangle {
         Button {
             text: "Load Recorded Data"
             Layout.fillWidth: true
-            enabled: !cameraCapture.isRunning && !sensorGenerator.isRunning
+            enabled: !cameraManager.isRunning && !sensorGenerator.isRunning
             
             background: Rectangle {
                 color: parent.enabled ? "#2196F3" : "#cccccc"
@@ -101,6 +102,54 @@ Rectangle {
             onClicked: root.loadData()
         }
 
+        Button {
+            text: "Review Recording"
+            Layout.fillWidth: true
+            visible: dataLogger.isLogging
+            enabled: !dataLogger.isFollowing
+
+            background: Rectangle {
+                color: parent.enabled ? "#2196F3" : "#cccccc"
+                radius: 5
+                border.color: parent.enabled ? "#0b7dda" : "#999999"
+                border.width: 1
+            }
+
+            contentItem: Text {
+                text: parent.text
+                color: "white"
+                font.bold: true
+                horizontalAlignment: Text.AlignHCenter
+                verticalAlignment: Text.AlignVCenter
+            }
+
+            onClicked: root.reviewRecording()
+        }
+
+        Button {
+            text: "Capture Event"
+            Layout.fillWidth: true
+            visible: cameraManager.preTriggerEnabled
+            enabled: cameraManager.isRunning
+
+            background: Rectangle {
+                color: parent.enabled ? "#FF9800" : "#cccccc"
+                radius: 5
+                border.color: parent.enabled ? "#e68a00" : "#999999"
+                border.width: 1
+            }
+
+            contentItem: Text {
+                text: parent.text
+                color: "white"
+                font.bold: true
+                horizontalAlignment: Text.AlignHCenter
+                verticalAlignment: Text.AlignVCenter
+            }
+
+            onClicked: cameraManager.trigger("manual")
+        }
+
         Rectangle {
             Layout.fillWidth: true
             Layout.fillHeight: true
@@ -128,7 +177,7 @@ Rectangle {
                         width: 14
                         height: 14
                         radius: 7
-                        color: cameraCapture.isRunning ? "#4CAF50" : "#cccccc"
+                        color: cameraManager.isRunning ? "#4CAF50" : "#cccccc"
                     }
                     Text {
                         text: "Camera"
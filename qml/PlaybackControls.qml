@@ -162,40 +162,142 @@ Rectangle {
                 font.pointSize: 10
             }
 
-            SpinBox {
-                from: 1
-                to: 100
-                stepSize: 1
-                value: playbackController.playbackSpeed * 10
-                Layout.preferredWidth: 80
-                
-                property int decimals: 1
-                property real realValue: value / 10.0
+            ComboBox {
+                id: speedCombo
+                model: [0.1, 0.25, 0.5, 1, 2, 5, 10, 30, 60, 100, 300, 1000, 3600, 10000]
+                Layout.preferredWidth: 90
+                currentIndex: Math.max(0, model.indexOf(playbackController.playbackSpeed))
+                displayText: (model[currentIndex] < 1 ? model[currentIndex].toFixed(2) : model[currentIndex]) + "x"
+
+                onActivated: function(index) {
+                    playbackController.playbackSpeed = model[index]
+                }
+            }
+
+            Button {
+                text: "🔖"
+                ToolTip.text: "Add Bookmark"
+                ToolTip.visible: hovered
+                Layout.preferredWidth: 35
+                onClicked: addBookmark()
+            }
+        }
 
-                validator: DoubleValidator {
-                    bottom: Math.min(0.1, 10.0)
-                    top: Math.max(0.1, 10.0)
+        // Whole-session overview drawn from the rollups: one bucket per
+        // pixel at most, so its cost does not grow with the session.
+        Canvas {
+            id: sessionOverview
+            Layout.fillWidth: true
+            Layout.leftMargin: 35
+            Layout.rightMargin: 35
+            Layout.preferredHeight: 36
+            visible: playbackController.totalReadings > 0
+
+            property var buckets: []
+            property var summary: ({})
+            property var hoverStatistics: null
+
+            function refresh() {
+                summary = playbackController.getStatistics()
+                if (!summary.startTime) {
+                    buckets = []
+                } else {
+                    buckets = playbackController.rollupSeries(summary.startTime,
+                                                              new Date(summary.endTime.getTime() + 1),
+                                                              Math.max(1, Math.floor(width)))
+                }
+                requestPaint()
+            }
+
+            function bucketAt(x) {
+                if (buckets.length === 0) {
+                    return null
+                }
+                var start = summary.startTime.getTime()
+                var span = Math.max(1, summary.endTime.getTime() - start)
+                var t = start + x / width * span
+                for (var i = buckets.length - 1; i >= 0; i--) {
+                    if (buckets[i].startTime.getTime() <= t) {
+                        return buckets[i]
+                    }
                 }
+                return buckets[0]
+            }
+
+            onWidthChanged: refresh()
 
-                textFromValue: function(value, locale) {
-                    return (value / 10.0).toFixed(decimals) + "x"
+            onPaint: {
+                var ctx = getContext("2d")
+                ctx.clearRect(0, 0, width, height)
+                if (buckets.length === 0) {
+                    return
                 }
 
-                valueFromText: function(text, locale) {
-                    return Math.round(parseFloat(text) * 10)
+                var start = summary.startTime.getTime()
+                var span = Math.max(1, summary.endTime.getTime() - start)
+                var low = summary.temperatureMin
+                var range = Math.max(1e-9, summary.temperatureMax - low)
+                function xAt(ms) { return (ms - start) / span * width }
+                function yAt(value) { return height - 2 - (value - low) / range * (height - 4) }
+
+                ctx.fillStyle = "#ffd6d6"
+                for (var i = 0; i < buckets.length; i++) {
+                    var bucket = buckets[i]
+                    var x = xAt(bucket.startTime.getTime())
+                    var w = Math.max(1, bucket.intervalMs / span * width)
+                    var top = yAt(bucket.temperatureMax)
+                    ctx.fillRect(x, top, w, Math.max(1, yAt(bucket.temperatureMin) - top))
                 }
 
-                onRealValueChanged: {
-                    playbackController.playbackSpeed = realValue
+                ctx.strokeStyle = "#ff6b6b"
+                ctx.lineWidth = 1
+                ctx.beginPath()
+                for (var j = 0; j < buckets.length; j++) {
+                    var mean = buckets[j].temperatureMean
+                    var mx = xAt(buckets[j].startTime.getTime() + buckets[j].intervalMs / 2)
+                    if (j === 0) {
+                        ctx.moveTo(mx, yAt(mean))
+                    } else {
+                        ctx.lineTo(mx, yAt(mean))
+                    }
                 }
+                ctx.stroke()
             }
 
-            Button {
-                text: "🔖"
-                ToolTip.text: "Add Bookmark"
-                ToolTip.visible: hovered
-                Layout.preferredWidth: 35
-                onClicked: addBookmark()
+            HoverHandler {
+                id: overviewHover
+                onHoveredChanged: {
+                    if (!hovered) {
+                        sessionOverview.hoverStatistics = null
+                    }
+                }
+                onPointChanged: {
+                    var bucket = sessionOverview.bucketAt(point.position.x)
+                    if (bucket) {
+                        var start = bucket.startTime
+                        sessionOverview.hoverStatistics = playbackController.getRangeStatistics(
+                                    start, new Date(start.getTime() + bucket.intervalMs))
+                    }
+                }
+            }
+
+            ToolTip.visible: overviewHover.hovered && hoverStatistics !== null
+            ToolTip.text: hoverStatistics
+                          ? Qt.formatDateTime(hoverStatistics.startTime, "hh:mm:ss") + "  "
+                            + hoverStatistics.count + " readings\n"
+                            + "Temperature " + hoverStatistics.temperatureMin.toFixed(1) + " – "
+                            + hoverStatistics.temperatureMax.toFixed(1) + " (mean "
+                            + hoverStatistics.temperatureMean.toFixed(1) + ")\n"
+                            + "Pressure " + hoverStatistics.pressureMin.toFixed(1) + " – "
+                            + hoverStatistics.pressureMax.toFixed(1) + " (mean "
+                            + hoverStatistics.pressureMean.toFixed(1) + ")"
+                          : ""
+
+            Connections {
+                target: playbackController
+                function onStatisticsChanged() {
+                    sessionOverview.refresh()
+                }
             }
         }
 
@@ -210,16 +312,51 @@ Rectangle {
             }
 
             Slider {
+                id: timelineSlider
                 Layout.fillWidth: true
                 from: 0
                 to: Math.max(1, playbackController.totalReadings - 1)
                 value: playbackController.currentIndex
                 stepSize: 1
+
+                // Reading under the pointer while hovering, or the handle while dragging
+                property real previewPosition: pressed ? visualPosition
+                                                       : Math.max(0, Math.min(1, (timelineHover.point.position.x - leftPadding) / availableWidth))
+                property int previewIndex: Math.round(from + previewPosition * (to - from))
                 
                 onMoved: {
                     playbackController.seekToIndex(Math.round(value))
                 }
 
+                HoverHandler {
+                    id: timelineHover
+                }
+
+                Rectangle {
+                    id: thumbnailPreview
+                    visible: thumbnailAtlas.ready && (timelineHover.hovered || timelineSlider.pressed)
+                    width: previewImage.width + 4
+                    height: previewImage.height + 4
+                    x: Math.max(0, Math.min(timelineSlider.width - width,
+                                            timelineSlider.leftPadding + timelineSlider.previewPosition * timelineSlider.availableWidth - width / 2))
+                    y: -height - 4
+                    z: 10
+                    color: "#333333"
+                    radius: 2
+
+                    Image {
+                        id: previewImage
+                        anchors.centerIn: parent
+                        width: 96
+                        height: 72
+                        cache: false
+                        asynchronous: true
+                        source: thumbnailPreview.visible
+                                ? "image://camera/thumb/" + playbackController.timestampAt(timelineSlider.previewIndex)
+                                : ""
+                    }
+                }
+
                 background: Rectangle {
                     x: parent.leftPadding
                     y: parent.topPadding + parent.availableHeight / 2 - height / 2
@@ -286,11 +423,27 @@ Rectangle {
                 
                 Item { Layout.fillWidth: true }
                 
+                ProgressBar {
+                    visible: exportEngine.isRunning
+                    value: exportEngine.progress
+                    Layout.preferredWidth: 80
+                }
+                
                 Button {
-                    text: "📷"
-                    ToolTip.text: "Export Current View"
+                    text: exportEngine.isRunning ? "✖" : "📷"
+                    ToolTip.text: exportEngine.isRunning ? "Cancel Export" : "Export Session"
                     ToolTip.visible: hovered
                     Layout.preferredWidth: 30
+                    enabled: exportEngine.isRunning || dataLogger.loadedLogFile !== ""
+                    onClicked: {
+                        if (exportEngine.isRunning) {
+                            exportEngine.cancel()
+                            return
+                        }
+                        var stats = playbackController.getStatistics()
+                        exportEngine.exportRange(dataLogger.loadedLogFile, "", stats.startTime, stats.endTime,
+                                                 "csv", "copy", 0)
+                    }
                 }
             }
             
@@ -14,6 +14,37 @@ Rectangle {
     property int maxDataPoints: 50
     property var dataPoints: []
 
+    // Live charts read from a SensorSampleModel and repaint once per
+    // committed batch; dataPoints is used while sampleModel is null.
+    property var sampleModel: null
+    property string valueRole: "temperature"
+    readonly property var points: sampleModel ? modelPoints : dataPoints
+    property var modelPoints: []
+
+    function refreshFromModel() {
+        modelPoints = sampleModel.values(valueRole, maxDataPoints)
+        canvas.requestPaint()
+    }
+
+    onSampleModelChanged: {
+        if (sampleModel) {
+            refreshFromModel()
+        } else {
+            canvas.requestPaint()
+        }
+    }
+
+    Connections {
+        target: root.sampleModel
+        enabled: root.sampleModel !== null
+        function onLatestChanged() {
+            root.refreshFromModel()
+        }
+        function onCountChanged() {
+            root.refreshFromModel()
+        }
+    }
+
     function addDataPoint(value) {
         dataPoints.push(value)
         if (dataPoints.length > maxDataPoints) {
@@ -47,7 +78,7 @@ Rectangle {
             var ctx = getContext("2d")
             ctx.clearRect(0, 0, width, height)
 
-            if (root.dataPoints.length === 0) {
+            if (root.points.length === 0) {
                 return
             }
 
@@ -70,7 +101,7 @@ Rectangle {
                 ctx.stroke()
             }
 
-            if (root.dataPoints.length > 1) {
+            if (root.points.length > 1) {
                 ctx.strokeStyle = root.lineColor
                 ctx.lineWidth = 2
                 ctx.beginPath()
@@ -79,9 +110,9 @@ Rectangle {
                 var maxVal = root.valueRange[1]
                 var valRange = maxVal - minVal
 
-                for (var k = 0; k < root.dataPoints.length; k++) {
+                for (var k = 0; k < root.points.length; k++) {
                     var xPos = (k / (root.maxDataPoints - 1)) * width
-                    var normalizedValue = (root.dataPoints[k] - minVal) / valRange
+                    var normalizedValue = (root.points[k] - minVal) / valRange
                     var yPos = height - (normalizedValue * height)
 
                     if (k === 0) {
@@ -94,9 +125,9 @@ Rectangle {
                 ctx.stroke()
 
                 ctx.fillStyle = root.lineColor
-                for (var l = 0; l < root.dataPoints.length; l++) {
+                for (var l = 0; l < root.points.length; l++) {
                     var xPos2 = (l / (root.maxDataPoints - 1)) * width
-                    var normalizedValue2 = (root.dataPoints[l] - minVal) / valRange
+                    var normalizedValue2 = (root.points[l] - minVal) / valRange
                     var yPos2 = height - (normalizedValue2 * height)
 
                     ctx.beginPath()
@@ -136,7 +167,7 @@ Rectangle {
 
         Text {
             anchors.centerIn: parent
-            text: root.dataPoints.length > 0 ? root.dataPoints[root.dataPoints.length - 1].toFixed(1) : "---"
+            text: root.points.length > 0 ? root.points[root.points.length - 1].toFixed(1) : "---"
             font.bold: true
             font.pointSize: 10
             color: root.lineColor
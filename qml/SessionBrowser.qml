@@ -0,0 +1,145 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import QtQuick.Layouts 1.15
+
+Dialog {
+    id: root
+    modal: true
+    anchors.centerIn: parent
+    width: 560
+    height: 460
+    title: "Recorded Sessions"
+
+    signal sessionSelected(string logFile, bool follow)
+    signal browseRequested()
+    signal compareRequested()
+
+    property var sessions: []
+
+    function refresh() {
+        sessions = sessionCatalog.sessions()
+    }
+
+    function formatDuration(ms) {
+        var seconds = Math.floor(ms / 1000)
+        var h = Math.floor(seconds / 3600)
+        var m = Math.floor((seconds % 3600) / 60)
+        var s = seconds % 60
+        return (h > 0 ? h + "h " : "") + m + "m " + s + "s"
+    }
+
+    function formatSize(bytes) {
+        if (bytes >= 1024 * 1024) return (bytes / (1024 * 1024)).toFixed(1) + " MB"
+        if (bytes >= 1024) return (bytes / 1024).toFixed(1) + " KB"
+        return bytes + " B"
+    }
+
+    onOpened: refresh()
+
+    Connections {
+        target: sessionCatalog
+        function onSessionsChanged() {
+            if (root.visible) {
+                root.refresh()
+            }
+        }
+    }
+
+    ColumnLayout {
+        anchors.fill: parent
+        spacing: 8
+
+        Label {
+            text: sessionCatalog.scanning ? "Updating catalog..." : root.sessions.length + " sessions"
+            color: "#666666"
+        }
+
+        ListView {
+            id: sessionList
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            clip: true
+            model: root.sessions
+            currentIndex: -1
+            ScrollBar.vertical: ScrollBar {}
+
+            delegate: ItemDelegate {
+                width: sessionList.width
+                highlighted: ListView.isCurrentItem
+                onClicked: sessionList.currentIndex = index
+                onDoubleClicked: {
+                    root.sessionSelected(modelData.logFile, modelData.recording)
+                    root.close()
+                }
+
+                contentItem: ColumnLayout {
+                    spacing: 2
+                    Label {
+                        text: modelData.name + (modelData.recording ? "  (recording)" : "")
+                        font.bold: true
+                    }
+                    Label {
+                        text: (modelData.startMs >= 0 ? Qt.formatDateTime(modelData.start, "yyyy-MM-dd hh:mm:ss") : "Unknown start")
+                              + "  |  " + root.formatDuration(modelData.durationMs)
+                              + "  |  " + modelData.rows + " rows, " + modelData.frames + " frames"
+                              + "  |  " + root.formatSize(modelData.sizeBytes)
+                        color: "#666666"
+                        font.pointSize: 9
+                    }
+                }
+            }
+        }
+
+        RowLayout {
+            Layout.fillWidth: true
+
+            Button {
+                text: "Browse..."
+                onClicked: {
+                    root.close()
+                    root.browseRequested()
+                }
+            }
+
+            Button {
+                text: "Compare..."
+                onClicked: {
+                    root.close()
+                    root.compareRequested()
+                }
+            }
+
+            Button {
+                text: "Rescan"
+                enabled: !sessionCatalog.scanning
+                onClicked: sessionCatalog.rescan()
+            }
+
+            Item { Layout.fillWidth: true }
+
+            Button {
+                text: "Cancel"
+                onClicked: root.close()
+            }
+
+            Button {
+                text: "Follow"
+                enabled: sessionList.currentIndex >= 0
+                onClicked: {
+                    root.sessionSelected(root.sessions[sessionList.currentIndex].logFile, true)
+                    root.close()
+                }
+            }
+
+            Button {
+                text: "Load"
+                highlighted: true
+                enabled: sessionList.currentIndex >= 0 && !root.sessions[sessionList.currentIndex].recording
+                onClicked: {
+                    root.sessionSelected(root.sessions[sessionList.currentIndex].logFile, false)
+                    root.close()
+                }
+            }
+        }
+    }
+}
@@ -53,7 +53,7 @@ Rectangle {
                         onActivated: {
                             var resolution = currentText.split('x')
                             if (resolution.length === 2) {
-                                cameraCapture.resolution = Qt.size(parseInt(resolution[0]), parseInt(resolution[1]))
+                                cameraManager.setResolution(Qt.size(parseInt(resolution[0]), parseInt(resolution[1])))
                             }
                         }
                     }
@@ -18,33 +18,49 @@ import QtQuick.Dialogs
         isPlayback = false
         temperatureChart.clearData()
         pressureChart.clearData()
+        sensorSamples.clear()
         console.log("All data and states reset successfully")
     }
     
+    function loadSession(filePath, follow) {
+        console.log("Attempting to", follow ? "follow" : "load", "file:", filePath)
+        
+        try {
+            if (follow ? dataLogger.followLogFile(filePath) : dataLogger.loadLogFile(filePath)) {
+                imageProvider.setPlaybackMode(true)
+                isPlayback = true
+                console.log("Successfully loaded data file and entered playback mode")
+            } else {
+                console.error("Failed to load data file:", filePath)
+            }
+        } catch (error) {
+            errorDialog.showError("File Load Error", "Unexpected error while loading file: " + error.toString())
+        }
+    }
+    
     ErrorDialog {
         id: errorDialog
     }
     
+    SessionBrowser {
+        id: sessionBrowser
+        onSessionSelected: function(logFile, follow) {
+            loadSession(logFile, follow)
+        }
+        onBrowseRequested: loadFileDialog.open()
+        onCompareRequested: comparisonView.open()
+    }
+
+    ComparisonView {
+        id: comparisonView
+    }
+    
     FileDialog {
         id: loadFileDialog
         title: "Load sensor data file"
         nameFilters: ["CSV files (*.csv)"]
         onAccepted: {
-            console.log("Attempting to load file:", selectedFile)
-            
-            try {
-                var filePath = selectedFile.toString().replace("file://", "")
-                if (dataLogger.loadLogFile(filePath)) {
-                    playbackController.loadData(dataLogger.getReadings())
-                    imageProvider.setPlaybackMode(true)
-                    isPlayback = true
-                    console.log("Successfully loaded data file and entered playback mode")
-                } else {
-                    console.error("Failed to load data file:", filePath)
-                }
-            } catch (error) {
-                errorDialog.showError("File Load Error", "Unexpected error while loading file: " + error.toString())
-            }
+            loadSession(selectedFile.toString().replace("file://", ""), false)
         }
         
         onRejected: {
@@ -53,10 +69,10 @@ import QtQuick.Dialogs
     }
 
     Connections {
-        target: cameraCapture
-        function onError(message) {
-            errorDialog.showError("Camera Error", message)
-            console.error("Camera Error:", message)
+        target: cameraManager
+        function onError(cameraId, message) {
+            errorDialog.showError("Camera Error", cameraId + ": " + message)
+            console.error("Camera Error:", cameraId, message)
         }
     }
     
@@ -67,6 +83,35 @@ import QtQuick.Dialogs
             console.error("Data Logger Error:", message)
         }
     }
+
+    Connections {
+        target: sessionComparison
+        function onError(message) {
+            errorDialog.showError("Comparison Error", message)
+            console.error("Comparison Error:", message)
+        }
+    }
+    
+    Connections {
+        target: ruleEngine
+        function onAlertRaised(rule, value, timestampMs) {
+            console.warn("Alert:", rule, "value", value, "at", new Date(timestampMs).toISOString())
+        }
+        function onError(message) {
+            errorDialog.showError("Rule Error", message)
+        }
+    }
+    
+    Connections {
+        target: exportEngine
+        function onError(message) {
+            errorDialog.showError("Export Error", message)
+            console.error("Export Error:", message)
+        }
+        function onFinished(success, outputFile, message) {
+            console.log("Export finished:", outputFile, message)
+        }
+    }
     
     Connections {
         target: loadFileDialog
@@ -99,6 +144,39 @@ import QtQuick.Dialogs
                 isPlaybackMode: isPlayback
             }
 
+            Rectangle {
+                Layout.fillWidth: true
+                Layout.preferredHeight: 28
+                visible: ruleEngine.activeAlerts.length > 0 && !isPlayback
+                color: "#ffe0e0"
+                border.color: "#ff6b6b"
+                radius: 3
+
+                Text {
+                    anchors.centerIn: parent
+                    text: "Alert: " + ruleEngine.activeAlerts.join(", ")
+                    color: "#b00020"
+                    font.bold: true
+                }
+            }
+
+            RowLayout {
+                Layout.fillWidth: true
+                Layout.preferredHeight: 90
+                visible: cameraManager.cameraCount > 1 && !isPlayback
+                spacing: 5
+
+                Repeater {
+                    model: cameraManager.cameraIds.slice(1)
+
+                    CameraView {
+                        Layout.fillWidth: true
+                        Layout.fillHeight: true
+                        cameraId: modelData
+                    }
+                }
+            }
+
             ControlPanel {
                 id: controlPanel
                 Layout.fillWidth: true
@@ -107,11 +185,13 @@ import QtQuick.Dialogs
                 onStartRecording: {
                     console.log("Start Acquisition clicked - starting camera, sensors, and data logging")
                     
-                    var cameraStarted = cameraCapture.start()
+                    var cameraStarted = cameraManager.startAll()
                     var sensorStarted = sensorGenerator.start()
                     var loggerStarted = dataLogger.startLogging()
                     
-                    console.log("Camera started:", cameraStarted)
+                    // Cameras open in the background; failures arrive through
+                    // cameraManager.error.
+                    console.log("Camera start requested:", cameraStarted)
                     console.log("Sensor started:", sensorStarted)
                     console.log("Logger started:", loggerStarted)
                     
@@ -120,32 +200,39 @@ import QtQuick.Dialogs
                         isPlayback = false
                         console.log("Recording started successfully - Sensor:", sensorStarted, "Logger:", loggerStarted, "Camera:", cameraStarted)
                         if (!cameraStarted) {
-                            console.log("Note: Camera failed to start, but sensor logging is active")
+                            console.log("Note: No camera is configured, but sensor logging is active")
                         }
                     } else {
                         console.log("Critical systems failed - Sensor:", sensorStarted, "Logger:", loggerStarted)
                         if (sensorStarted) sensorGenerator.stop()
                         if (loggerStarted) dataLogger.stopLogging()
-                        if (cameraStarted) cameraCapture.stop()
+                        if (cameraStarted) cameraManager.stopAll()
                     }
                 }
                 
                 onStopRecording: {
-                    cameraCapture.stop()
+                    cameraManager.stopAll()
                     sensorGenerator.stop()
                     dataLogger.stopLogging()
                     resetAll()
                 }
                 
                 onLoadData: {
-                    loadFileDialog.open()
+                    sessionBrowser.open()
+                }
+
+                onReviewRecording: {
+                    if (dataLogger.reviewRecording()) {
+                        imageProvider.setPlaybackMode(true)
+                        isPlayback = true
+                    }
                 }
             }
 
             PlaybackControls {
                 id: playbackControls
                 Layout.fillWidth: true
-                Layout.preferredHeight: 150
+                Layout.preferredHeight: 190
                 visible: isPlayback
                 
                 Connections {
@@ -180,6 +267,7 @@ import QtQuick.Dialogs
                 }
                 
                 onClicked: {
+                    dataLogger.stopFollowing()
                     playbackController.stop()
                     imageProvider.setPlaybackMode(false)
                     isPlayback = false
@@ -223,24 +311,17 @@ import QtQuick.Dialogs
                 chartTitle: "Temperature (°C)"
                 valueRange: [10, 40]
                 lineColor: "#ff6b6b"
+                sampleModel: isPlayback ? null : sensorSamples
+                valueRole: "temperature"
                 
-                property real lastTemperature: 20.0
-                
-                Connections {
-                    target: sensorGenerator
-                    function onDataReady(temperature, pressure, timestamp) {
-                        if (!isPlayback) {
-                            temperatureChart.lastTemperature = temperature
-                            temperatureChart.addDataPoint(temperature)
-                        }
-                    }
-                }
+                property real lastTemperature: isPlayback ? playbackTemperature : sensorSamples.latestTemperature
+                property real playbackTemperature: 20.0
                 
                 Connections {
                     target: playbackController
                     function onDataPoint(temperature, pressure, timestamp, frameFile) {
                         if (isPlayback) {
-                            temperatureChart.lastTemperature = temperature
+                            temperatureChart.playbackTemperature = temperature
                             temperatureChart.addDataPoint(temperature)
                         }
                     }
@@ -254,24 +335,17 @@ import QtQuick.Dialogs
                 chartTitle: "Pressure (hPa)"
                 valueRange: [980, 1040]
                 lineColor: "#4ecdc4"
+                sampleModel: isPlayback ? null : sensorSamples
+                valueRole: "pressure"
                 
-                property real lastPressure: 1013.25
-                
-                Connections {
-                    target: sensorGenerator
-                    function onDataReady(temperature, pressure, timestamp) {
-                        if (!isPlayback) {
-                            pressureChart.lastPressure = pressure
-                            pressureChart.addDataPoint(pressure)
-                        }
-                    }
-                }
+                property real lastPressure: isPlayback ? playbackPressure : sensorSamples.latestPressure
+                property real playbackPressure: 1013.25
                 
                 Connections {
                     target: playbackController
                     function onDataPoint(temperature, pressure, timestamp, frameFile) {
                         if (isPlayback) {
-                            pressureChart.lastPressure = pressure
+                            pressureChart.playbackPressure = pressure
                             pressureChart.addDataPoint(pressure)
                         }
                     }
@@ -327,7 +401,7 @@ import QtQuick.Dialogs
                         Text {
                             text: {
                                 if (isRecording) return "Recording"
-                                if (isPlayback) return "Playback"
+                                if (isPlayback) return dataLogger.isFollowing ? "Following" : "Playback"
                                 return "Stopped"
                             }
                             font.pointSize: 12
@@ -0,0 +1,24 @@
+#include "AcquisitionClock.h"
+#include <QDateTime>
+#include <QElapsedTimer>
+
+namespace {
+
+struct ClockAnchor {
+    ClockAnchor()
+        : epochMs(QDateTime::currentMSecsSinceEpoch())
+    {
+        elapsed.start();
+    }
+
+    qint64 epochMs;
+    QElapsedTimer elapsed;
+};
+
+}
+
+qint64 AcquisitionClock::nowMs()
+{
+    static const ClockAnchor anchor;
+    return anchor.epochMs + anchor.elapsed.elapsed();
+}
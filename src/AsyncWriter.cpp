@@ -0,0 +1,632 @@
+#include "AsyncWriter.h"
+#include <QDebug>
+#include <QFile>
+#include <QMutexLocker>
+#include <QThread>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#include <thread>
+#endif
+
+static const int BatchSize = 32;
+
+static qint64 nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#ifdef HAVE_LIBURING
+struct AsyncWriter::UringState {
+    struct io_uring ring;
+    std::thread thread;
+    // Cleared if the ring could not be recreated after a failure; batches
+    // then go through the synchronous path.
+    bool usable = true;
+};
+#endif
+
+AsyncWriter::AsyncWriter(int maxInFlight, qint64 maxInFlightBytes, QObject *parent)
+    : QObject(parent)
+    , m_maxInFlight(maxInFlight > 0 ? maxInFlight : 256)
+    , m_maxInFlightBytes(maxInFlightBytes > 0 ? maxInFlightBytes : qint64(64) * 1024 * 1024)
+    , m_nextFileId(0)
+    , m_inFlight(0)
+    , m_inFlightBytes(0)
+    , m_activeWorkers(0)
+    , m_maxWorkers(std::max(2, QThread::idealThreadCount() / 2))
+    , m_stopping(false)
+    , m_requests(0)
+    , m_batches(0)
+    , m_syncs(0)
+    , m_bytesWritten(0)
+    , m_rejected(0)
+    , m_failed(0)
+    , m_maxLatencyNs(0)
+{
+    m_pool.setMaxThreadCount(m_maxWorkers);
+
+#ifdef HAVE_LIBURING
+    if (!startUring()) {
+        qDebug() << "io_uring unavailable, using thread pool writer";
+    }
+#endif
+    qDebug() << "AsyncWriter backend:" << backendName() << "max in flight:" << m_maxInFlight;
+}
+
+AsyncWriter::~AsyncWriter()
+{
+    waitForIdle();
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_workAvailable.wakeAll();
+    }
+
+#ifdef HAVE_LIBURING
+    if (m_uring) {
+        m_uring->thread.join();
+        io_uring_queue_exit(&m_uring->ring);
+        m_uring.reset();
+    }
+#endif
+    m_pool.waitForDone();
+
+    for (FileState &state : m_files) {
+        state.file->close();
+    }
+    m_files.clear();
+}
+
+AsyncWriter *AsyncWriter::shared()
+{
+    static AsyncWriter writer;
+    return &writer;
+}
+
+QString AsyncWriter::backendName() const
+{
+#ifdef HAVE_LIBURING
+    if (m_uring) {
+        return "io_uring";
+    }
+#endif
+    return "threadpool";
+}
+
+int AsyncWriter::inFlight() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_inFlight;
+}
+
+QVariantMap AsyncWriter::metrics() const
+{
+    QVariantMap result;
+    result["backend"] = backendName();
+    result["inFlight"] = inFlight();
+    result["maxInFlight"] = m_maxInFlight;
+    result["requests"] = m_requests.load();
+    result["batches"] = m_batches.load();
+    result["syncs"] = m_syncs.load();
+    result["bytesWritten"] = m_bytesWritten.load();
+    result["rejected"] = m_rejected.load();
+    result["failed"] = m_failed.load();
+    result["maxLatencyMs"] = m_maxLatencyNs.load() / 1e6;
+    return result;
+}
+
+int AsyncWriter::openAppend(const QString &path, bool truncate, QString *errorMessage)
+{
+    // ReadWrite rather than Append: O_APPEND would make positioned writes
+    // ignore their offsets.
+    auto file = std::make_shared<QFile>(path);
+    QIODevice::OpenMode mode = truncate ? QIODevice::WriteOnly | QIODevice::Truncate : QIODevice::ReadWrite;
+    if (!file->open(mode)) {
+        if (errorMessage) {
+            *errorMessage = "Cannot open " + path + ". Error: " + file->errorString();
+        }
+        return -1;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    FileState state;
+    state.file = file;
+    state.mutex = std::make_shared<QMutex>();
+    state.nextOffset = file->size();
+    int fileId = m_nextFileId++;
+    m_files.insert(fileId, state);
+    return fileId;
+}
+
+bool AsyncWriter::append(int fileId, const QByteArray &data, bool durable, QObject *context, Completion completion)
+{
+    Request request;
+    request.fileId = fileId;
+    request.data = data;
+    request.durable = durable;
+    request.context = context;
+    request.hasContext = context != nullptr;
+    request.completion = std::move(completion);
+    return enqueue(std::move(request));
+}
+
+bool AsyncWriter::writeFile(const QString &path, const QByteArray &data, bool durable, QObject *context, Completion completion)
+{
+    Request request;
+    request.path = path;
+    request.data = data;
+    request.durable = durable;
+    request.context = context;
+    request.hasContext = context != nullptr;
+    request.completion = std::move(completion);
+    return enqueue(std::move(request));
+}
+
+void AsyncWriter::close(int fileId)
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_files.find(fileId);
+    if (it == m_files.end()) {
+        return;
+    }
+
+    if (it->pending == 0) {
+        it->file->close();
+        m_files.erase(it);
+    } else {
+        it->closing = true;
+    }
+}
+
+void AsyncWriter::waitForIdle()
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_inFlight > 0) {
+        m_idle.wait(&m_mutex);
+    }
+}
+
+bool AsyncWriter::enqueue(Request request)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_stopping) {
+        return false;
+    }
+
+    qint64 size = request.data.size();
+    if (m_inFlight >= m_maxInFlight || (m_inFlight > 0 && m_inFlightBytes + size > m_maxInFlightBytes)) {
+        m_rejected++;
+        return false;
+    }
+
+    if (request.fileId >= 0) {
+        auto it = m_files.find(request.fileId);
+        if (it == m_files.end() || it->closing) {
+            return false;
+        }
+        // The offset is reserved here, in submission order, so the writes
+        // themselves can complete in any order.
+        request.file = it->file;
+        request.fileMutex = it->mutex;
+        request.offset = it->nextOffset;
+        it->nextOffset += size;
+        it->pending++;
+    }
+
+    m_inFlight++;
+    m_inFlightBytes += size;
+    m_requests++;
+    request.submittedNs = nowNs();
+    m_queue.enqueue(std::move(request));
+
+#ifdef HAVE_LIBURING
+    if (m_uring) {
+        m_workAvailable.wakeOne();
+        return true;
+    }
+#endif
+
+    if (m_activeWorkers < m_maxWorkers) {
+        m_activeWorkers++;
+        m_pool.start([this]() { runPoolWorker(); });
+    }
+    return true;
+}
+
+QList<AsyncWriter::Request> AsyncWriter::takeBatch()
+{
+    QMutexLocker locker(&m_mutex);
+    QList<Request> batch;
+    while (!m_queue.isEmpty() && batch.size() < BatchSize) {
+        batch.append(m_queue.dequeue());
+    }
+    if (batch.isEmpty()) {
+        m_activeWorkers--;
+    }
+    return batch;
+}
+
+void AsyncWriter::runPoolWorker()
+{
+    for (;;) {
+        QList<Request> batch = takeBatch();
+        if (batch.isEmpty()) {
+            return;
+        }
+        executeBatch(batch);
+        complete(batch);
+    }
+}
+
+bool AsyncWriter::openForWrite(Request &request)
+{
+    request.file = std::make_shared<QFile>(request.path);
+    request.fileMutex = std::make_shared<QMutex>();
+    if (!request.file->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        request.ok = false;
+        request.errorMessage = "Cannot create " + request.path + ". Error: " + request.file->errorString();
+        return false;
+    }
+    return true;
+}
+
+bool AsyncWriter::writeAt(Request &request)
+{
+#ifdef Q_OS_UNIX
+    int fd = request.file->handle();
+    const char *data = request.data.constData();
+    qint64 remaining = request.data.size();
+    qint64 offset = request.offset;
+    while (remaining > 0) {
+        ssize_t written = ::pwrite(fd, data, size_t(remaining), off_t(offset));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            request.ok = false;
+            request.errorMessage = QString("Write failed: %1").arg(QString::fromLocal8Bit(strerror(errno)));
+            return false;
+        }
+        data += written;
+        remaining -= written;
+        offset += written;
+    }
+    return true;
+#else
+    QMutexLocker locker(request.fileMutex.get());
+    if (!request.file->seek(request.offset) || request.file->write(request.data) != request.data.size()) {
+        request.ok = false;
+        request.errorMessage = "Write failed: " + request.file->errorString();
+        return false;
+    }
+    return true;
+#endif
+}
+
+bool AsyncWriter::syncFile(QFile *file, QMutex *mutex)
+{
+#if defined(Q_OS_LINUX)
+    Q_UNUSED(mutex)
+    return ::fdatasync(file->handle()) == 0;
+#elif defined(Q_OS_UNIX)
+    Q_UNUSED(mutex)
+    return ::fsync(file->handle()) == 0;
+#else
+    QMutexLocker locker(mutex);
+    return file->flush();
+#endif
+}
+
+void AsyncWriter::executeBatch(QList<Request> &batch)
+{
+    for (Request &request : batch) {
+        if (request.fileId < 0 && !openForWrite(request)) {
+            continue;
+        }
+        writeAt(request);
+    }
+
+    // Group commit: one sync per file covers every durable write in the batch.
+    QList<QFile *> synced;
+    for (Request &request : batch) {
+        if (!request.durable || !request.ok || synced.contains(request.file.get())) {
+            continue;
+        }
+        synced.append(request.file.get());
+        m_syncs++;
+        if (!syncFile(request.file.get(), request.fileMutex.get())) {
+            for (Request &other : batch) {
+                if (other.file == request.file && other.ok) {
+                    other.ok = false;
+                    other.errorMessage = "Sync failed for " + request.file->fileName();
+                }
+            }
+        }
+    }
+
+    for (Request &request : batch) {
+        if (request.fileId < 0 && request.file) {
+            request.file->close();
+        }
+    }
+}
+
+void AsyncWriter::complete(QList<Request> &batch)
+{
+    m_batches++;
+    qint64 finishedNs = nowNs();
+
+    // Callbacks run before the request leaves the in-flight count, so
+    // waitForIdle() also covers completions invoked on this thread.
+    for (Request &request : batch) {
+        qint64 latencyNs = finishedNs - request.submittedNs;
+        qint64 previous = m_maxLatencyNs.load();
+        while (latencyNs > previous && !m_maxLatencyNs.compare_exchange_weak(previous, latencyNs)) {
+        }
+
+        if (request.ok) {
+            m_bytesWritten += request.data.size();
+        } else {
+            m_failed++;
+            qDebug() << "AsyncWriter:" << request.errorMessage;
+        }
+
+        if (!request.completion) {
+            continue;
+        }
+        if (request.hasContext) {
+            if (QObject *context = request.context.data()) {
+                Completion completion = std::move(request.completion);
+                bool ok = request.ok;
+                QString errorMessage = request.errorMessage;
+                QMetaObject::invokeMethod(context, [completion, ok, errorMessage]() {
+                    completion(ok, errorMessage);
+                }, Qt::QueuedConnection);
+            }
+        } else {
+            request.completion(request.ok, request.errorMessage);
+        }
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        for (const Request &request : batch) {
+            m_inFlight--;
+            m_inFlightBytes -= request.data.size();
+            if (request.fileId < 0) {
+                continue;
+            }
+            auto it = m_files.find(request.fileId);
+            if (it != m_files.end() && --it->pending == 0 && it->closing) {
+                it->file->close();
+                m_files.erase(it);
+            }
+        }
+        if (m_inFlight == 0) {
+            m_idle.wakeAll();
+        }
+    }
+}
+
+#ifdef HAVE_LIBURING
+
+bool AsyncWriter::startUring()
+{
+    auto state = std::make_unique<UringState>();
+    if (io_uring_queue_init(BatchSize * 2, &state->ring, 0) != 0) {
+        return false;
+    }
+    m_uring = std::move(state);
+    m_uring->thread = std::thread([this]() { runUringLoop(); });
+    return true;
+}
+
+void AsyncWriter::runUringLoop()
+{
+    for (;;) {
+        QList<Request> batch;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (m_queue.isEmpty() && !m_stopping) {
+                m_workAvailable.wait(&m_mutex);
+            }
+            if (m_queue.isEmpty()) {
+                return;
+            }
+            while (!m_queue.isEmpty() && batch.size() < BatchSize) {
+                batch.append(m_queue.dequeue());
+            }
+        }
+        if (m_uring->usable) {
+            executeUringBatch(batch);
+        } else {
+            executeBatch(batch);
+        }
+        complete(batch);
+    }
+}
+
+bool AsyncWriter::driveUring(int prepared, const std::function<void(int, int)> &onComplete)
+{
+    struct io_uring *ring = &m_uring->ring;
+
+    int submitted;
+    do {
+        submitted = io_uring_submit_and_wait(ring, unsigned(prepared));
+    } while (submitted == -EINTR);
+    if (submitted < 0) {
+        qWarning() << "io_uring submit failed:" << strerror(-submitted);
+        return false;
+    }
+
+    for (int reaped = 0; reaped < submitted; ++reaped) {
+        struct io_uring_cqe *cqe = nullptr;
+        int result;
+        do {
+            result = io_uring_wait_cqe(ring, &cqe);
+        } while (result == -EINTR);
+        if (result != 0 || !cqe) {
+            qWarning() << "io_uring wait failed:" << strerror(-result);
+            return false;
+        }
+        int index = int(intptr_t(io_uring_cqe_get_data(cqe)));
+        int status = cqe->res;
+        io_uring_cqe_seen(ring, cqe);
+        onComplete(index, status);
+    }
+
+    if (submitted < prepared) {
+        // The rest are still queued in the ring and would be sent with the
+        // next batch.
+        qWarning() << "io_uring submitted" << submitted << "of" << prepared << "requests";
+        return false;
+    }
+    return true;
+}
+
+void AsyncWriter::resetUring()
+{
+    // Anything still queued or unreaped belongs to a batch that has been
+    // failed already, so a new ring is the only safe place to continue.
+    io_uring_queue_exit(&m_uring->ring);
+    if (io_uring_queue_init(BatchSize * 2, &m_uring->ring, 0) != 0) {
+        qWarning() << "Cannot recreate io_uring, using synchronous writes";
+        m_uring->usable = false;
+    }
+}
+
+void AsyncWriter::executeUringBatch(QList<Request> &batch)
+{
+    struct io_uring *ring = &m_uring->ring;
+
+    // A request stays pending until its completion has been reaped; any
+    // still pending when the ring fails is reported as not written.
+    QVector<bool> pending(batch.size(), false);
+    auto failPending = [&batch, &pending](const QString &message) {
+        for (int i = 0; i < batch.size(); ++i) {
+            if (pending[i] && batch[i].ok) {
+                batch[i].ok = false;
+                batch[i].errorMessage = message;
+            }
+        }
+    };
+
+    int submitted = 0;
+    for (int i = 0; i < batch.size(); ++i) {
+        Request &request = batch[i];
+        if (request.fileId < 0 && !openForWrite(request)) {
+            continue;
+        }
+        struct io_uring_sqe *sqe = io_uring_get_sqe(ring);
+        if (!sqe) {
+            writeAt(request);
+            continue;
+        }
+        io_uring_prep_write(sqe, request.file->handle(), request.data.constData(),
+                            unsigned(request.data.size()), __u64(request.offset));
+        io_uring_sqe_set_data(sqe, reinterpret_cast<void *>(intptr_t(i)));
+        pending[i] = true;
+        submitted++;
+    }
+
+    bool ringOk = submitted == 0 || driveUring(submitted, [&batch, &pending](int index, int result) {
+        Request &request = batch[index];
+        pending[index] = false;
+        if (result < 0) {
+            request.ok = false;
+            request.errorMessage = QString("Write failed: %1").arg(QString::fromLocal8Bit(strerror(-result)));
+        } else if (result < request.data.size()) {
+            Request tail = request;
+            tail.data = request.data.mid(result);
+            tail.offset += result;
+            if (!writeAt(tail)) {
+                request.ok = false;
+                request.errorMessage = tail.errorMessage;
+            }
+        }
+    });
+    if (!ringOk) {
+        failPending("Write was not completed by io_uring");
+        resetUring();
+    }
+
+    // Group commit, as in the thread pool path, issued through the ring.
+    // Files the ring cannot take are synced directly, so a request is only
+    // reported durable once its file has actually been synced.
+    QList<int> syncRequests;
+    QList<int> directSyncs;
+    for (int i = 0; i < batch.size(); ++i) {
+        const Request &request = batch[i];
+        bool seen = false;
+        for (int j : syncRequests + directSyncs) {
+            seen = seen || batch[j].file == request.file;
+        }
+        if (!request.durable || !request.ok || seen) {
+            continue;
+        }
+        struct io_uring_sqe *sqe = ringOk && m_uring->usable ? io_uring_get_sqe(ring) : nullptr;
+        if (!sqe) {
+            directSyncs.append(i);
+            continue;
+        }
+        io_uring_prep_fsync(sqe, request.file->handle(), IORING_FSYNC_DATASYNC);
+        io_uring_sqe_set_data(sqe, reinterpret_cast<void *>(intptr_t(i)));
+        syncRequests.append(i);
+    }
+
+    auto markSynced = [this, &batch](const Request &synced, bool ok) {
+        m_syncs++;
+        for (Request &other : batch) {
+            if (other.file == synced.file && other.ok && !ok) {
+                other.ok = false;
+                other.errorMessage = "Sync failed for " + synced.file->fileName();
+            }
+        }
+    };
+
+    if (!syncRequests.isEmpty()) {
+        pending.fill(false);
+        for (int j : syncRequests) {
+            pending[j] = true;
+        }
+        bool synced = driveUring(syncRequests.size(), [&batch, &pending, &markSynced](int index, int result) {
+            pending[index] = false;
+            markSynced(batch[index], result >= 0);
+        });
+        if (!synced) {
+            // Every durable request on a file whose sync was not reaped.
+            for (int i = 0; i < batch.size(); ++i) {
+                for (int j : syncRequests) {
+                    if (pending[j] && batch[i].durable && batch[i].file == batch[j].file) {
+                        pending[i] = true;
+                    }
+                }
+            }
+            failPending("Sync was not completed by io_uring");
+            resetUring();
+        }
+    }
+
+    for (int i : directSyncs) {
+        markSynced(batch[i], syncFile(batch[i].file.get(), batch[i].fileMutex.get()));
+    }
+
+    for (Request &request : batch) {
+        if (request.fileId < 0 && request.file) {
+            request.file->close();
+        }
+    }
+}
+
+#endif
@@ -1,187 +1,657 @@
 #include "CameraCapture.h"
+#include "AcquisitionClock.h"
+#include "FrameWriter.h"
 #include <QDebug>
 #include <QImage>
 #include <QApplication>
+#include <QFileInfo>
 #include <QStandardPaths>
 #include <QThread>
+#include <QMutexLocker>
+#include <algorithm>
+
+static const int IdleAfterMs = 2000;
+static const int WarmupPollMs = 20;
+static const int WarmupTimeoutMs = 3000;
+static const int ReconnectMinMs = 1000;
+static const int ReconnectMaxMs = 10000;
+static const int BusFrameSlots = 8;
+
+static_assert(int(FramePixelFormat::BGR) == SharedBus::BGR && int(FramePixelFormat::MJPEG) == SharedBus::MJPEG,
+              "bus pixel formats must match FramePixelFormat");
 
 CameraCapture::CameraCapture(QObject *parent)
+    : CameraCapture(QString(), parent)
+{
+}
+
+CameraCapture::CameraCapture(const QString &cameraId, QObject *parent)
     : QObject(parent)
+    , m_cameraId(cameraId)
+    , m_preTrigger(new PreTriggerRecorder(this))
+    , m_preTriggerMs(0)
+    , m_frameWriter(nullptr)
     , m_timer(new QTimer(this))
     , m_frameSaveTimer(new QTimer(this))
+    , m_reconnectTimer(new QTimer(this))
     , m_isRunning(false)
+    , m_state(Stopped)
+    , m_reconnectDelayMs(ReconnectMinMs)
+    , m_failureReported(false)
+    , m_openMs(-1)
+    , m_firstFrameMs(-1)
+    , m_reconnects(0)
+    , m_previewEnabled(true)
+    , m_idle(false)
+    , m_keepAliveIntervalMs(500)
     , m_resolution(640, 480)
+    , m_framesCaptured(0)
+    , m_framesSaved(0)
+    , m_framesDropped(0)
+    , m_framesUnchanged(0)
+    , m_lastChangePercent(0.0)
+    , m_readFailures(0)
+    , m_previewFrames(0)
+    , m_previewSkipped(0)
+    , m_captureFps(0.0)
+    , m_captureMs(0.0)
+    , m_consecutiveFailures(0)
+    , m_rateFrames(0)
+    , m_currentFrameFormat(FramePixelFormat::BGR)
+    , m_currentFrameTimestampMs(0)
 {
     m_timer->setInterval(33);
     connect(m_timer, &QTimer::timeout, this, &CameraCapture::captureFrame);
     m_frameSaveTimer->setInterval(5000);
     m_frameSaveTimer->setSingleShot(false);
     connect(m_frameSaveTimer, &QTimer::timeout, this, &CameraCapture::saveCurrentFrame);
+    m_reconnectTimer->setSingleShot(true);
+    connect(m_reconnectTimer, &QTimer::timeout, this, [this]() {
+        m_reconnects++;
+        beginOpen();
+    });
     m_dataDirectory = QApplication::applicationDirPath() + "/data";
     QDir().mkpath(m_dataDirectory);
+
+    connect(m_preTrigger, &PreTriggerRecorder::eventRecorded, this, &CameraCapture::eventRecorded);
+    connect(m_preTrigger, &PreTriggerRecorder::error, this, &CameraCapture::error);
 }
 
 CameraCapture::~CameraCapture()
 {
-    stop();
+    if (isOwnThread()) {
+        stop();
+    } else {
+        closeCamera();
+    }
+}
+
+bool CameraCapture::isOwnThread() const
+{
+    return QThread::currentThread() == thread();
 }
 
 void CameraCapture::setResolution(const QSize &resolution)
 {
+    if (!isOwnThread()) {
+        QMetaObject::invokeMethod(this, [this, resolution]() { setResolution(resolution); }, Qt::QueuedConnection);
+        return;
+    }
+
     if (m_resolution != resolution) {
         m_resolution = resolution;
-        if (m_capture.isOpened()) {
-            m_capture.set(cv::CAP_PROP_FRAME_WIDTH, resolution.width());
-            m_capture.set(cv::CAP_PROP_FRAME_HEIGHT, resolution.height());
+        m_sourceConfig.resolution = resolution;
+        if (m_source) {
+            m_source->setResolution(resolution);
         }
+        m_framePool.clear();
         emit resolutionChanged();
     }
 }
 
+void CameraCapture::setFrameSaveInterval(int intervalMs)
+{
+    if (!isOwnThread()) {
+        QMetaObject::invokeMethod(this, [this, intervalMs]() { setFrameSaveInterval(intervalMs); }, Qt::QueuedConnection);
+        return;
+    }
+
+    if (intervalMs > 0) {
+        m_frameSaveTimer->setInterval(intervalMs);
+    }
+}
+
+void CameraCapture::setBusName(const QString &busName)
+{
+    if (!isOwnThread()) {
+        QMetaObject::invokeMethod(this, [this, busName]() { setBusName(busName); }, Qt::QueuedConnection);
+        return;
+    }
+
+    if (busName != m_busName) {
+        m_busWriter.destroy();
+        m_busName = busName;
+    }
+}
+
+void CameraCapture::setPreTriggerConfig(const PreTriggerConfig &config)
+{
+    if (!isOwnThread()) {
+        QMetaObject::invokeMethod(this, [this, config]() { setPreTriggerConfig(config); }, Qt::QueuedConnection);
+        return;
+    }
+
+    m_preTrigger->configure(config, m_cameraId, m_dataDirectory);
+    m_preTriggerMs = config.preTriggerMs;
+    if (config.isEnabled() && m_idle) {
+        // The ring needs every frame, viewer or not.
+        m_idle = false;
+        m_timer->setInterval(captureInterval());
+    }
+}
+
+void CameraCapture::trigger(const QString &reason)
+{
+    qint64 timestampMs = AcquisitionClock::nowMs();
+    QMetaObject::invokeMethod(this, [this, reason, timestampMs]() {
+        m_preTrigger->trigger(reason, timestampMs);
+    }, isOwnThread() ? Qt::DirectConnection : Qt::QueuedConnection);
+}
+
+void CameraCapture::setKeepAliveInterval(int intervalMs)
+{
+    if (!isOwnThread()) {
+        QMetaObject::invokeMethod(this, [this, intervalMs]() { setKeepAliveInterval(intervalMs); }, Qt::QueuedConnection);
+        return;
+    }
+
+    if (intervalMs > 0) {
+        m_keepAliveIntervalMs = intervalMs;
+        if (m_idle) {
+            m_timer->setInterval(std::max(m_keepAliveIntervalMs, captureInterval()));
+        }
+    }
+}
+
+void CameraCapture::setFrameWriter(FrameWriter *frameWriter)
+{
+    if (m_frameWriter) {
+        disconnect(m_frameWriter, nullptr, this, nullptr);
+    }
+
+    m_frameWriter = frameWriter;
+    if (!m_frameWriter) {
+        return;
+    }
+
+    connect(m_frameWriter, &FrameWriter::frameWritten, this,
+            [this](const QString &cameraId, const QString &filename, qint64 timestampMs) {
+        if (cameraId != m_cameraId) {
+            return;
+        }
+        m_framesSaved++;
+        emit frameSaved(filename, timestampMs);
+        qDebug() << "Saved camera frame:" << filename;
+    });
+    connect(m_frameWriter, &FrameWriter::writeFailed, this,
+            [this](const QString &cameraId, const QString &filename, const QString &message) {
+        Q_UNUSED(filename)
+        if (cameraId == m_cameraId) {
+            emit error(message);
+        }
+    });
+}
+
+QString CameraCapture::source() const
+{
+    return m_sourceConfig.type + ":" + m_sourceConfig.location;
+}
+
+void CameraCapture::setSourceConfig(const FrameSourceConfig &config)
+{
+    if (!isOwnThread()) {
+        QMetaObject::invokeMethod(this, [this, config]() { setSourceConfig(config); }, Qt::QueuedConnection);
+        return;
+    }
+
+    bool wasRunning = m_isRunning;
+    if (wasRunning) {
+        stop();
+    }
+
+    m_sourceConfig = config;
+    m_sourceConfig.resolution = m_resolution;
+    m_changeDetector.configure(config.changeThreshold, config.changeKeepAliveMs);
+    m_timer->setInterval(captureInterval());
+    emit sourceChanged();
+
+    if (wasRunning) {
+        start();
+    }
+}
+
+bool CameraCapture::setSource(const QString &spec)
+{
+    FrameSourceConfig config = m_sourceConfig;
+    QString errorMessage;
+    if (!FrameSource::parseSpec(spec, config, &errorMessage)) {
+        emit error(errorMessage);
+        return false;
+    }
+    setSourceConfig(config);
+    return true;
+}
+
+int CameraCapture::captureInterval() const
+{
+    if (m_sourceConfig.unthrottled) {
+        return 0;
+    }
+    return std::max(1, static_cast<int>(1000.0 / m_sourceConfig.fps));
+}
+
 bool CameraCapture::start()
 {
-    if (m_isRunning) {
+    if (!isOwnThread()) {
+        QMetaObject::invokeMethod(this, [this]() { start(); }, Qt::QueuedConnection);
         return true;
     }
 
-    if (!openCamera()) {
-        emit error("Camera is not available. Please check if a camera is connected and not being used by another application. The system will continue with placeholder frames.");
-        qDebug() << "Camera failed to open, will generate placeholder frames";
+    if (m_isRunning) {
+        return true;
     }
 
     m_isRunning = true;
-    m_timer->start();
+    m_consecutiveFailures = 0;
+    m_rateFrames = 0;
+    m_reconnectDelayMs = ReconnectMinMs;
+    m_failureReported = false;
+    m_openMs = -1;
+    m_firstFrameMs = -1;
+    m_changeDetector.reset();
+    m_startTimer.start();
+    m_rateTimer.start();
+    m_demandTimer.start();
+    m_idle = false;
     m_frameSaveTimer->start(); 
     emit runningChanged();
+
+    // Open and warm up from the event loop, one step at a time, so stop()
+    // and other queued calls never wait behind a slow device.
+    QMetaObject::invokeMethod(this, &CameraCapture::beginOpen, Qt::QueuedConnection);
     return true;
 }
 
+void CameraCapture::beginOpen()
+{
+    if (!m_isRunning) {
+        return;
+    }
+
+    if (!sourcePresent()) {
+        enterFailed("Camera " + source() + " is not connected. Waiting for it to appear; placeholder frames are saved meanwhile.");
+        return;
+    }
+
+    setState(Opening);
+    QElapsedTimer openTimer;
+    openTimer.start();
+    if (!openCamera()) {
+        enterFailed("Camera is not available. Please check if a camera is connected and not being used by another application. The system will continue with placeholder frames.");
+        return;
+    }
+    m_openMs = openTimer.elapsed();
+
+    setState(Warming);
+    m_warmupTimer.start();
+    m_timer->start(WarmupPollMs);
+}
+
+void CameraCapture::becomeLive()
+{
+    if (m_firstFrameMs < 0) {
+        m_firstFrameMs = m_startTimer.elapsed();
+    }
+    m_reconnectDelayMs = ReconnectMinMs;
+    m_failureReported = false;
+    m_timer->setInterval(m_idle ? std::max(m_keepAliveIntervalMs, captureInterval()) : captureInterval());
+    setState(Live);
+
+    qDebug() << "Camera" << m_cameraId << "live: open" << m_openMs.load() << "ms, warm-up"
+             << m_warmupTimer.elapsed() << "ms, first frame" << m_firstFrameMs.load() << "ms after start";
+}
+
+void CameraCapture::enterFailed(const QString &message)
+{
+    m_timer->stop();
+    closeCamera();
+    {
+        QMutexLocker locker(&m_frameMutex);
+        m_currentFrame.release();
+    }
+    setState(Failed);
+
+    if (!message.isEmpty() && !m_failureReported) {
+        emit error(message);
+        qDebug() << message;
+    }
+    m_failureReported = true;
+
+    // Only devices come back on their own; files and patterns that fail stay failed.
+    if (m_isRunning && m_sourceConfig.type == "device") {
+        m_reconnectTimer->start(m_reconnectDelayMs);
+        m_reconnectDelayMs = std::min(m_reconnectDelayMs * 2, ReconnectMaxMs);
+    }
+}
+
+bool CameraCapture::sourcePresent() const
+{
+    // Checking the device node is cheap, so an unplugged camera can be
+    // polled for without repeatedly going through a full open.
+#ifdef Q_OS_LINUX
+    if (m_sourceConfig.type == "device") {
+        return QFileInfo::exists("/dev/video" + m_sourceConfig.location);
+    }
+#endif
+    return true;
+}
+
+QString CameraCapture::stateName(CameraState state)
+{
+    switch (state) {
+    case Stopped: return "stopped";
+    case Opening: return "opening";
+    case Warming: return "warming";
+    case Live: return "live";
+    case Failed: return "failed";
+    }
+    return "stopped";
+}
+
+void CameraCapture::setState(CameraState state)
+{
+    if (m_state.exchange(state) != state) {
+        emit stateChanged();
+    }
+}
+
 void CameraCapture::stop()
 {
+    if (!isOwnThread()) {
+        QMetaObject::invokeMethod(this, [this]() { stop(); }, Qt::QueuedConnection);
+        return;
+    }
+
     if (!m_isRunning) {
         return;
     }
 
     m_timer->stop();
+    m_reconnectTimer->stop();
     m_frameSaveTimer->stop(); 
+    m_preTrigger->finish();
     closeCamera();
+    m_busWriter.destroy();
     m_isRunning = false;
+    m_idle = false;
+    m_captureFps = 0.0;
+    setState(Stopped);
     emit runningChanged();
 }
 
 bool CameraCapture::saveFrame(const QString &filename)
 {
-    if (!m_currentFrame.empty()) {
-        return cv::imwrite(filename.toStdString(), m_currentFrame);
+    cv::Mat frame;
+    FramePixelFormat format;
+    {
+        QMutexLocker locker(&m_frameMutex);
+        frame = m_currentFrame;
+        format = m_currentFrameFormat;
+    }
+
+    if (frame.empty()) {
+        return false;
     }
-    return false;
+
+    if (filename.endsWith(".jpg", Qt::CaseInsensitive) || filename.endsWith(".jpeg", Qt::CaseInsensitive)) {
+        return FrameWriter::writeJpeg(frame, format, filename, nullptr);
+    }
+
+    cv::Mat bgr;
+    return FrameSource::decodeToBgr(frame, format, bgr) && cv::imwrite(filename.toStdString(), bgr);
+}
+
+QVariantMap CameraCapture::metrics() const
+{
+    QVariantMap result;
+    result["cameraId"] = m_cameraId;
+    result["source"] = source();
+    result["running"] = m_isRunning.load();
+    result["state"] = stateName();
+    result["openMs"] = m_openMs.load();
+    result["firstFrameMs"] = m_firstFrameMs.load();
+    result["reconnects"] = m_reconnects.load();
+    result["framesCaptured"] = m_framesCaptured.load();
+    result["framesSaved"] = m_framesSaved.load();
+    result["framesDropped"] = m_framesDropped.load();
+    result["framesUnchanged"] = m_framesUnchanged.load();
+    result["lastChangePercent"] = m_lastChangePercent.load();
+    result["readFailures"] = m_readFailures.load();
+    result["previewFrames"] = m_previewFrames.load();
+    result["previewSkipped"] = m_previewSkipped.load();
+    result["idle"] = m_idle.load();
+    result["fps"] = m_captureFps.load();
+    result["captureMs"] = m_captureMs.load();
+    result.insert(m_framePool.metrics());
+    result.insert(m_busWriter.metrics());
+    result.insert(m_preTrigger->metrics());
+    return result;
+}
+
+void CameraCapture::updateRateMetrics(qint64 captureUs)
+{
+    double captureMs = captureUs / 1000.0;
+    double previous = m_captureMs.load();
+    m_captureMs = previous > 0.0 ? previous * 0.9 + captureMs * 0.1 : captureMs;
+
+    m_rateFrames++;
+    qint64 elapsedMs = m_rateTimer.elapsed();
+    if (elapsedMs >= 1000) {
+        m_captureFps = m_rateFrames * 1000.0 / elapsedMs;
+        m_rateFrames = 0;
+        m_rateTimer.restart();
+    }
+}
+
+void CameraCapture::updateIdleState()
+{
+    bool idle = !m_preTrigger->isEnabled() && m_demandTimer.isValid() && m_demandTimer.elapsed() >= IdleAfterMs;
+    if (idle == m_idle) {
+        return;
+    }
+
+    m_idle = idle;
+    m_timer->setInterval(idle ? std::max(m_keepAliveIntervalMs, captureInterval()) : captureInterval());
+    qDebug() << "Camera" << m_cameraId << (idle ? "has no viewer, capturing at keep-alive rate" : "has a viewer again, capturing at full rate");
 }
 
 void CameraCapture::captureFrame()
 {
-    if (!m_capture.isOpened()) {
+    if (!m_source || !m_source->isOpened()) {
         return;
     }
 
     try {
-        cv::Mat frame;
-        if (m_capture.read(frame) && !frame.empty()) {
-            m_currentFrame = frame.clone();
-            QImage qimg = matToQImage(frame);
-            emit frameReady(qimg);
+        QElapsedTimer captureTimer;
+        captureTimer.start();
+
+        // Sources write into the pooled buffer in place. MJPEG frames vary in
+        // size, so they are not pooled.
+        FramePixelFormat format = m_source->pixelFormat();
+        bool pooled = format != FramePixelFormat::MJPEG;
+        cv::Mat frame = pooled ? m_framePool.acquire() : cv::Mat();
+        const uchar *buffer = frame.data;
+
+        if (m_source->read(frame) && !frame.empty()) {
+            // A device falls back to BGR on its first frame if it refuses
+            // the requested format.
+            format = m_source->pixelFormat();
+            if (state() == Warming) {
+                becomeLive();
+            }
+            if (pooled && frame.data != buffer) {
+                // First frame, or the source delivers a different size than
+                // the pool holds: size the pool to what it actually produces.
+                m_framePool.configure(frame.rows, frame.cols, frame.type());
+            }
+            qint64 timestampMs = AcquisitionClock::nowMs();
+            {
+                QMutexLocker locker(&m_frameMutex);
+                m_currentFrame = frame;
+                m_currentFrameFormat = format;
+                m_currentFrameTimestampMs = timestampMs;
+            }
+            m_framesCaptured++;
+            publishFrame(frame, format, timestampMs);
+            m_preTrigger->addFrame(frame, format, timestampMs);
+            m_consecutiveFailures = 0;
+
+            if (m_previewEnabled) {
+                if (!m_displayDemand || m_displayDemand()) {
+                    QImage qimg = matToQImage(frame, format);
+                    if (!qimg.isNull()) {
+                        m_previewFrames++;
+                        emit frameReady(qimg);
+                    }
+                    m_demandTimer.restart();
+                } else {
+                    m_previewSkipped++;
+                }
+                updateIdleState();
+            }
+            updateRateMetrics(captureTimer.nsecsElapsed() / 1000);
+        } else if (state() == Warming) {
+            if (m_warmupTimer.elapsed() > WarmupTimeoutMs) {
+                enterFailed("Camera opened but delivered no frames within " + QString::number(WarmupTimeoutMs) + " ms.");
+            }
         } else {
-            static int failureCount = 0;
-            failureCount++;
-            if (failureCount > 10) {
-                emit error("Camera disconnected or cannot read frames. Please check camera connection.");
-                closeCamera();
-                failureCount = 0;
+            m_readFailures++;
+            m_consecutiveFailures++;
+            if (m_consecutiveFailures > 10) {
+                m_consecutiveFailures = 0;
+                enterFailed("Camera disconnected or cannot read frames. Please check camera connection.");
             }
         }
     } catch (const cv::Exception &e) {
-        emit error("Camera capture error: " + QString(e.what()));
-        closeCamera();
+        enterFailed("Camera capture error: " + QString(e.what()));
     } catch (const std::exception &e) {
-        emit error("Camera error: " + QString(e.what()));
-        closeCamera();
+        enterFailed("Camera error: " + QString(e.what()));
     } catch (...) {
-        emit error("Unknown camera error occurred during frame capture");
-        closeCamera();
+        enterFailed("Unknown camera error occurred during frame capture");
     }
 }
 
 bool CameraCapture::openCamera()
 {
     try {
-        qDebug() << "Attempting to open camera device...";
-        
-        m_capture.open(0, cv::CAP_V4L2);
-        if (!m_capture.isOpened()) {
-            qDebug() << "Failed to open camera device 0 with V4L2, trying default backend...";
-            m_capture.open(0);
-            if (!m_capture.isOpened()) {
-                qDebug() << "Failed to open camera device 0";
-                return false;
-            }
-        }
-        
-        qDebug() << "Camera opened, configuring settings...";
-        
-        m_capture.set(cv::CAP_PROP_FRAME_WIDTH, m_resolution.width());
-        m_capture.set(cv::CAP_PROP_FRAME_HEIGHT, m_resolution.height());
-        m_capture.set(cv::CAP_PROP_BUFFERSIZE, 1);
-        m_capture.set(cv::CAP_PROP_FPS, 30);
-        
-        QThread::msleep(500);
-        
-        cv::Mat testFrame;
-        int retries = 5;
-        bool frameRead = false;
-        
-        for (int i = 0; i < retries; i++) {
-            if (m_capture.read(testFrame) && !testFrame.empty()) {
-                qDebug() << "Successfully read test frame on attempt" << (i + 1);
-                frameRead = true;
-                break;
-            }
-            qDebug() << "Test frame read attempt" << (i + 1) << "failed, retrying...";
-            QThread::msleep(200);
-        }
-        
-        if (!frameRead) {
-            qDebug() << "Camera opened but cannot read frames after" << retries << "attempts";
-            m_capture.release();
+        FrameSourceConfig config = m_sourceConfig;
+        config.resolution = m_resolution;
+        m_source = FrameSource::create(config);
+
+        if (!m_source->open()) {
+            qDebug() << "Failed to open" << m_source->description();
+            m_source.reset();
             return false;
         }
-        
-        qDebug() << "Camera successfully opened and configured";
-        qDebug() << "Frame size:" << testFrame.cols << "x" << testFrame.rows;
-        qDebug() << "Frame type:" << testFrame.type();
-        
+
+        qDebug() << "Frame source ready:" << m_source->description()
+                 << "format:" << FrameSource::pixelFormatName(m_source->pixelFormat());
         return true;
     } catch (const cv::Exception &e) {
         qDebug() << "OpenCV exception:" << e.what();
+        m_source.reset();
         return false;
     } catch (const std::exception &e) {
         qDebug() << "Standard exception in openCamera:" << e.what();
+        m_source.reset();
         return false;
     } catch (...) {
         qDebug() << "Unknown exception in openCamera";
+        m_source.reset();
         return false;
     }
 }
 
 void CameraCapture::closeCamera()
 {
-    if (m_capture.isOpened()) {
-        m_capture.release();
+    if (m_source) {
+        m_source->close();
+        m_source.reset();
     }
 }
 
+void CameraCapture::publishFrame(const cv::Mat &frame, FramePixelFormat format, qint64 timestampMs)
+{
+    if (m_busName.isEmpty() || !frame.isContinuous()) {
+        return;
+    }
+
+    quint64 size = frame.total() * frame.elemSize();
+    if (!m_busWriter.isOpen() || size > m_busWriter.slotSize()) {
+        // Raw frames have a fixed size. Compressed ones vary, so leave room
+        // for them to grow before the segment has to be replaced.
+        quint64 slotSize = size;
+        if (format == FramePixelFormat::MJPEG) {
+            slotSize = std::max(size * 2, quint64(m_resolution.width()) * m_resolution.height() * 2);
+        }
+        QString stream = m_cameraId.isEmpty() ? QString("frames") : "frames." + m_cameraId;
+        QString errorMessage;
+        if (!m_busWriter.create(m_busName, stream, SharedBus::FrameStream, BusFrameSlots, slotSize, &errorMessage)) {
+            m_busName.clear();
+            emit error(errorMessage);
+            return;
+        }
+    }
+
+    bool compressed = format == FramePixelFormat::MJPEG;
+    m_busWriter.publish(timestampMs,
+                        compressed ? 0 : quint32(frame.cols), compressed ? 0 : quint32(frame.rows),
+                        compressed ? 0 : quint32(frame.step[0]), quint32(format),
+                        frame.data, size);
+}
+
+cv::Mat CameraCapture::placeholderFrame() const
+{
+    cv::Mat placeholder = cv::Mat::zeros(m_resolution.height(), m_resolution.width(), CV_8UC3);
+
+    std::string timestampText = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss").toStdString();
+    cv::putText(placeholder, "No Camera Available", cv::Point(50, m_resolution.height()/2 - 40), 
+               cv::FONT_HERSHEY_SIMPLEX, 1, cv::Scalar(255, 255, 255), 2);
+    cv::putText(placeholder, timestampText, cv::Point(50, m_resolution.height()/2 + 20), 
+               cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(200, 200, 200), 1);
+    return placeholder;
+}
+
 void CameraCapture::saveCurrentFrame()
 {
-    QString timestamp = QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss");
-    QString filename = m_dataDirectory + "/frame_" + timestamp + ".jpg";
+    cv::Mat frame;
+    FramePixelFormat format;
+    qint64 timestampMs;
+    {
+        QMutexLocker locker(&m_frameMutex);
+        frame = m_currentFrame;
+        format = m_currentFrameFormat;
+        timestampMs = m_currentFrameTimestampMs;
+    }
+
+    bool isPlaceholder = frame.empty();
+    if (isPlaceholder) {
+        timestampMs = AcquisitionClock::nowMs();
+    }
+
+    QString timestamp = QDateTime::fromMSecsSinceEpoch(timestampMs).toString("yyyyMMdd_hhmmss_zzz");
+    QString prefix = m_cameraId.isEmpty() ? QString("frame_") : "frame_" + m_cameraId + "_";
+    QString filename = m_dataDirectory + "/" + prefix + timestamp + ".jpg";
     
     QDir dir(m_dataDirectory);
     if (!dir.exists()) {
@@ -192,28 +662,31 @@ void CameraCapture::saveCurrentFrame()
     }
     
     try {
-        if (!m_currentFrame.empty()) {
-            if (cv::imwrite(filename.toStdString(), m_currentFrame)) {
-                emit frameSaved(filename);
-                qDebug() << "Saved camera frame:" << filename;
-            } else {
-                emit error("Failed to save camera frame to: " + filename + ". Please check disk space and write permissions.");
+        if (isPlaceholder) {
+            frame = placeholderFrame();
+            format = FramePixelFormat::BGR;
+        }
+
+        bool store = m_changeDetector.shouldStore(frame, format, timestampMs);
+        m_lastChangePercent = m_changeDetector.lastChangePercent();
+        if (!store) {
+            m_framesUnchanged++;
+            return;
+        }
+
+        if (m_frameWriter) {
+            if (!m_frameWriter->submit(m_cameraId, frame, format, filename, timestampMs)) {
+                m_framesDropped++;
             }
+            return;
+        }
+
+        if (FrameWriter::writeJpeg(frame, format, filename, nullptr)) {
+            m_framesSaved++;
+            emit frameSaved(filename, timestampMs);
+            qDebug() << (isPlaceholder ? "Saved placeholder frame:" : "Saved camera frame:") << filename;
         } else {
-            cv::Mat placeholderFrame = cv::Mat::zeros(m_resolution.height(), m_resolution.width(), CV_8UC3);
-            
-            std::string timestampText = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss").toStdString();
-            cv::putText(placeholderFrame, "No Camera Available", cv::Point(50, m_resolution.height()/2 - 40), 
-                       cv::FONT_HERSHEY_SIMPLEX, 1, cv::Scalar(255, 255, 255), 2);
-            cv::putText(placeholderFrame, timestampText, cv::Point(50, m_resolution.height()/2 + 20), 
-                       cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(200, 200, 200), 1);
-            
-            if (cv::imwrite(filename.toStdString(), placeholderFrame)) {
-                emit frameSaved(filename);
-                qDebug() << "Saved placeholder frame:" << filename;
-            } else {
-                emit error("Failed to save placeholder frame to: " + filename + ". Please check disk space and write permissions.");
-            }
+            emit error("Failed to save camera frame to: " + filename + ". Please check disk space and write permissions.");
         }
     } catch (const cv::Exception &e) {
         emit error("OpenCV error while saving frame: " + QString(e.what()));
@@ -224,24 +697,46 @@ void CameraCapture::saveCurrentFrame()
     }
 }
 
-QImage CameraCapture::matToQImage(const cv::Mat &mat)
+QImage CameraCapture::matToQImage(const cv::Mat &mat, FramePixelFormat format)
 {
-    switch (mat.type()) {
-    case CV_8UC4: {
-        QImage image(mat.data, mat.cols, mat.rows, mat.step, QImage::Format_ARGB32);
-        return image.rgbSwapped();
+    // Convert straight into the QImage's buffer with a single cvtColor pass,
+    // so each frame costs one vectorized conversion and no intermediate copies.
+    cv::Mat source = mat;
+    int code;
+    switch (format) {
+    case FramePixelFormat::BGR:
+        code = cv::COLOR_BGR2RGBA;
+        break;
+    case FramePixelFormat::BGRA:
+        code = cv::COLOR_BGRA2RGBA;
+        break;
+    case FramePixelFormat::Gray:
+        code = cv::COLOR_GRAY2RGBA;
+        break;
+    case FramePixelFormat::YUYV:
+        code = cv::COLOR_YUV2RGBA_YUYV;
+        break;
+    case FramePixelFormat::MJPEG: {
+        int flags = m_resolution.width() >= 1280 ? cv::IMREAD_REDUCED_COLOR_2 : cv::IMREAD_COLOR;
+        cv::imdecode(mat, flags, &m_decoded);
+        source = m_decoded;
+        code = cv::COLOR_BGR2RGBA;
+        break;
     }
-    case CV_8UC3: {
-        QImage image(mat.data, mat.cols, mat.rows, mat.step, QImage::Format_RGB888);
-        return image.rgbSwapped();
+    default:
+        return QImage();
     }
-    case CV_8UC1: {
-        QImage image(mat.data, mat.cols, mat.rows, mat.step, QImage::Format_Grayscale8);
-        return image;
+
+    if (source.empty() || source.depth() != CV_8U) {
+        return QImage();
     }
-    default:
-        break;
+
+    QImage image = m_framePool.acquireImage(source.cols, source.rows, QImage::Format_RGBX8888);
+    if (image.isNull()) {
+        return QImage();
     }
 
-    return QImage();
+    cv::Mat target(image.height(), image.width(), CV_8UC4, image.bits(), image.bytesPerLine());
+    cv::cvtColor(source, target, code);
+    return image;
 }
@@ -0,0 +1,235 @@
+#include "CameraManager.h"
+#include "ImageProvider.h"
+#include <QCoreApplication>
+#include <QDebug>
+
+CameraManager::CameraManager(ImageProvider *imageProvider, QObject *parent)
+    : QObject(parent)
+    , m_imageProvider(imageProvider)
+{
+}
+
+CameraManager::~CameraManager()
+{
+    shutdown();
+}
+
+void CameraManager::shutdown()
+{
+    for (const CameraSlot &slot : m_cameras) {
+        stopAndWait(slot.capture);
+    }
+    m_frameWriter.waitForDone();
+
+    for (const CameraSlot &slot : m_cameras) {
+        slot.thread->quit();
+        slot.thread->wait();
+        delete slot.capture;
+        delete slot.thread;
+    }
+    m_cameras.clear();
+    emit camerasChanged();
+}
+
+CameraCapture *CameraManager::addCamera(const FrameSourceConfig &config)
+{
+    QString cameraId = QString("cam%1").arg(m_cameras.size());
+
+    CameraCapture *capture = new CameraCapture(cameraId);
+    capture->setSourceConfig(config);
+    capture->setResolution(config.resolution);
+    capture->setFrameWriter(&m_frameWriter);
+    capture->setPreTriggerConfig(m_preTriggerConfig);
+
+    if (m_imageProvider) {
+        ImageProvider *provider = m_imageProvider;
+        connect(capture, &CameraCapture::frameReady, capture, [provider, cameraId](const QImage &image) {
+            provider->updateImage(cameraId, image);
+        }, Qt::DirectConnection);
+        capture->setDisplayDemand([provider, cameraId]() {
+            return provider->wantsFrame(cameraId);
+        });
+
+        if (m_cameras.isEmpty()) {
+            m_imageProvider->setPrimarySlot(cameraId);
+        }
+    }
+
+    connect(capture, &CameraCapture::runningChanged, this, &CameraManager::runningChanged);
+    if (m_cameras.isEmpty()) {
+        connect(capture, &CameraCapture::stateChanged, this, &CameraManager::cameraStateChanged);
+    }
+    connect(capture, &CameraCapture::error, this, [this, cameraId](const QString &message) {
+        emit error(cameraId, message);
+    });
+    connect(capture, &CameraCapture::eventRecorded, this, [this, cameraId](const QString &directory, int frames) {
+        emit eventRecorded(cameraId, directory, frames);
+    });
+    connect(capture, &CameraCapture::frameSaved, this, [this, cameraId](const QString &filename, qint64 timestampMs) {
+        emit frameSaved(filename, timestampMs, cameraId);
+    });
+
+    QThread *thread = new QThread(this);
+    thread->setObjectName("capture-" + cameraId);
+    capture->moveToThread(thread);
+    thread->start();
+
+    m_cameras.append({capture, thread});
+    emit camerasChanged();
+
+    qDebug() << "Added camera" << cameraId << "with source" << capture->source();
+    return capture;
+}
+
+CameraCapture *CameraManager::primaryCamera() const
+{
+    return m_cameras.isEmpty() ? nullptr : m_cameras.first().capture;
+}
+
+CameraCapture *CameraManager::camera(const QString &cameraId) const
+{
+    for (const CameraSlot &slot : m_cameras) {
+        if (slot.capture->cameraId() == cameraId) {
+            return slot.capture;
+        }
+    }
+    return nullptr;
+}
+
+QList<CameraCapture *> CameraManager::cameras() const
+{
+    QList<CameraCapture *> result;
+    for (const CameraSlot &slot : m_cameras) {
+        result.append(slot.capture);
+    }
+    return result;
+}
+
+QStringList CameraManager::cameraIds() const
+{
+    QStringList ids;
+    for (const CameraSlot &slot : m_cameras) {
+        ids.append(slot.capture->cameraId());
+    }
+    return ids;
+}
+
+bool CameraManager::isRunning() const
+{
+    for (const CameraSlot &slot : m_cameras) {
+        if (slot.capture->isRunning()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QString CameraManager::cameraState() const
+{
+    CameraCapture *capture = primaryCamera();
+    return capture ? capture->stateName() : CameraCapture::stateName(CameraCapture::Stopped);
+}
+
+void CameraManager::setResolution(const QSize &resolution)
+{
+    for (const CameraSlot &slot : m_cameras) {
+        slot.capture->setResolution(resolution);
+    }
+}
+
+void CameraManager::setPreviewEnabled(bool enabled)
+{
+    for (const CameraSlot &slot : m_cameras) {
+        slot.capture->setPreviewEnabled(enabled);
+    }
+}
+
+void CameraManager::setBusName(const QString &busName)
+{
+    for (const CameraSlot &slot : m_cameras) {
+        slot.capture->setBusName(busName);
+    }
+}
+
+void CameraManager::setPreTriggerConfig(const PreTriggerConfig &config)
+{
+    m_preTriggerConfig = config;
+    for (const CameraSlot &slot : m_cameras) {
+        slot.capture->setPreTriggerConfig(config);
+    }
+    emit camerasChanged();
+}
+
+void CameraManager::trigger(const QString &reason)
+{
+    for (const CameraSlot &slot : m_cameras) {
+        slot.capture->trigger(reason);
+    }
+}
+
+void CameraManager::setKeepAliveInterval(int intervalMs)
+{
+    for (const CameraSlot &slot : m_cameras) {
+        slot.capture->setKeepAliveInterval(intervalMs);
+    }
+}
+
+void CameraManager::setFrameSaveInterval(int intervalMs)
+{
+    for (const CameraSlot &slot : m_cameras) {
+        slot.capture->setFrameSaveInterval(intervalMs);
+    }
+}
+
+void CameraManager::waitForSavedFrames()
+{
+    m_frameWriter.waitForDone();
+
+    // frameWritten is queued to each camera's thread, which re-emits it as
+    // frameSaved queued to this one. A blocking call on every camera thread
+    // runs after what is already queued there; what they re-emitted is then
+    // delivered here.
+    for (const CameraSlot &slot : m_cameras) {
+        if (slot.thread->isRunning()) {
+            QMetaObject::invokeMethod(slot.capture, []() {}, Qt::BlockingQueuedConnection);
+        }
+    }
+    QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+}
+
+bool CameraManager::startAll()
+{
+    for (const CameraSlot &slot : m_cameras) {
+        slot.capture->start();
+    }
+    return !m_cameras.isEmpty();
+}
+
+void CameraManager::stopAll()
+{
+    for (const CameraSlot &slot : m_cameras) {
+        stopAndWait(slot.capture);
+    }
+}
+
+QVariantList CameraManager::metrics() const
+{
+    QVariantList result;
+    for (const CameraSlot &slot : m_cameras) {
+        QVariantMap cameraMetrics = slot.capture->metrics();
+        if (m_imageProvider) {
+            QString cameraId = slot.capture->cameraId();
+            cameraMetrics["displayDelivered"] = m_imageProvider->framesDelivered(cameraId);
+            cameraMetrics["displayDropped"] = m_imageProvider->framesDropped(cameraId);
+        }
+        result.append(cameraMetrics);
+    }
+    return result;
+}
+
+void CameraManager::stopAndWait(CameraCapture *capture)
+{
+    if (capture->thread()->isRunning()) {
+        QMetaObject::invokeMethod(capture, "stop", Qt::BlockingQueuedConnection);
+    }
+}
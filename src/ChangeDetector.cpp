@@ -0,0 +1,91 @@
+#include "ChangeDetector.h"
+#include <QDebug>
+#include <algorithm>
+#include <utility>
+
+ChangeDetector::ChangeDetector(double thresholdPercent, int keepAliveMs)
+    : m_thresholdPercent(thresholdPercent)
+    , m_keepAliveMs(keepAliveMs)
+    , m_lastStoredMs(0)
+    , m_lastChangePercent(0.0)
+{
+}
+
+void ChangeDetector::configure(double thresholdPercent, int keepAliveMs)
+{
+    m_thresholdPercent = std::max(0.0, thresholdPercent);
+    m_keepAliveMs = std::max(0, keepAliveMs);
+    reset();
+}
+
+void ChangeDetector::reset()
+{
+    m_reference.release();
+    m_lastStoredMs = 0;
+    m_lastChangePercent = 0.0;
+}
+
+bool ChangeDetector::makeThumbnail(const cv::Mat &frame, FramePixelFormat format)
+{
+    // Shrink before converting where the format allows it, so the colour
+    // conversion only touches a few thousand pixels.
+    const cv::Size size(ThumbnailWidth, ThumbnailHeight);
+    switch (format) {
+    case FramePixelFormat::BGR:
+        cv::resize(frame, m_scratch, size, 0, 0, cv::INTER_AREA);
+        cv::cvtColor(m_scratch, m_thumbnail, cv::COLOR_BGR2GRAY);
+        return true;
+    case FramePixelFormat::BGRA:
+        cv::resize(frame, m_scratch, size, 0, 0, cv::INTER_AREA);
+        cv::cvtColor(m_scratch, m_thumbnail, cv::COLOR_BGRA2GRAY);
+        return true;
+    case FramePixelFormat::Gray:
+        cv::resize(frame, m_thumbnail, size, 0, 0, cv::INTER_AREA);
+        return true;
+    case FramePixelFormat::YUYV:
+        cv::cvtColor(frame, m_scratch, cv::COLOR_YUV2GRAY_YUYV);
+        cv::resize(m_scratch, m_thumbnail, size, 0, 0, cv::INTER_AREA);
+        return true;
+    case FramePixelFormat::MJPEG:
+        cv::imdecode(frame, cv::IMREAD_REDUCED_GRAYSCALE_8, &m_scratch);
+        if (m_scratch.empty()) {
+            return false;
+        }
+        cv::resize(m_scratch, m_thumbnail, size, 0, 0, cv::INTER_AREA);
+        return true;
+    }
+    return false;
+}
+
+bool ChangeDetector::shouldStore(const cv::Mat &frame, FramePixelFormat format, qint64 timestampMs)
+{
+    if (!isEnabled()) {
+        return true;
+    }
+
+    try {
+        if (frame.empty() || !makeThumbnail(frame, format)) {
+            return true;
+        }
+    } catch (const cv::Exception &e) {
+        qDebug() << "Change detection failed, storing frame:" << e.what();
+        return true;
+    }
+
+    bool keepAliveDue = m_keepAliveMs > 0 && timestampMs - m_lastStoredMs >= m_keepAliveMs;
+    if (m_reference.empty() || m_reference.size() != m_thumbnail.size()) {
+        m_lastChangePercent = 100.0;
+    } else {
+        // Mean absolute difference, as a percentage of full scale.
+        double total = cv::norm(m_thumbnail, m_reference, cv::NORM_L1);
+        m_lastChangePercent = total * 100.0 / (255.0 * m_thumbnail.total());
+    }
+
+    if (m_lastChangePercent < m_thresholdPercent && !keepAliveDue) {
+        return false;
+    }
+
+    std::swap(m_reference, m_thumbnail);
+    m_lastStoredMs = timestampMs;
+    return true;
+}
@@ -1,15 +1,35 @@
 #include "DataLogger.h"
+#include "AsyncWriter.h"
 #include <QDebug>
 #include <QFileInfo>
 #include <QDir>
 #include <QApplication>
+#include <algorithm>
+
+// Rounds of waiting for the writer to go idle before the rows still
+// pending at stopLogging() are given up.
+static const int StopFlushAttempts = 50;
 
 DataLogger::DataLogger(QObject *parent)
     : QObject(parent)
-    , m_logFile(nullptr)
-    , m_stream(nullptr)
+    , m_logFileId(-1)
+    , m_frameIndexFileId(-1)
+    , m_pendingRowCount(0)
+    , m_flushTimer(new QTimer(this))
+    , m_rowsDurable(0)
+    , m_logBytes(0)
+    , m_backlogReported(false)
     , m_isLogging(false)
     , m_frameTimer(new QTimer(this))
+    , m_logFollower(new LogFollower(this))
+    , m_frameFollower(new LogFollower(this))
+    , m_isFollowing(false)
+    , m_isReviewing(false)
+    , m_reviewedReadings(0)
+    , m_reviewedFrames(0)
+    , m_followLoaded(false)
+    , m_fileFrameStart(0)
+    , m_followSkipped(0)
 {
     m_dataDirectory = QApplication::applicationDirPath() + "/data";
     
@@ -22,14 +42,28 @@ DataLogger::DataLogger(QObject *parent)
             qDebug() << "Warning: Data directory is not writable:" << m_dataDirectory;
         }
     }
+
+    QString catalogError;
+    if (!m_catalog.open(m_dataDirectory, &catalogError)) {
+        qDebug() << "Warning:" << catalogError;
+    }
     
     m_frameTimer->setInterval(5000);
     m_frameTimer->setSingleShot(false);
+
+    m_flushTimer->setInterval(200);
+    connect(m_flushTimer, &QTimer::timeout, this, &DataLogger::flushPending);
+
+    m_logFollower->setRotationPattern("sensor_log_*.csv");
+    connect(m_logFollower, &LogFollower::linesAppended, this, &DataLogger::appendFollowedRows);
+    connect(m_logFollower, &LogFollower::rotated, this, &DataLogger::followedFileRotated);
+    connect(m_frameFollower, &LogFollower::linesAppended, this, &DataLogger::appendFollowedFrames);
 }
 
 DataLogger::~DataLogger()
 {
     stopLogging();
+    AsyncWriter::shared()->waitForIdle();
 }
 
 bool DataLogger::startLogging()
@@ -38,11 +72,35 @@ bool DataLogger::startLogging()
         return true;
     }
 
+    stopFollowing();
+    m_readings.clear();
+    m_frameIndex.clear();
+    m_rollups.clear();
+    m_pendingFrameFilename.clear();
+    m_pendingRows.clear();
+    m_pendingRowCount = 0;
+    m_pendingFrameRows.clear();
+    m_rowsDurable = 0;
+    m_logBytes = 0;
+    m_backlogReported = false;
+
     if (!createLogFile()) {
         emit error("Failed to create log file");
         return false;
     }
 
+    QString rollupError;
+    if (!m_rollups.openOutput(RollupStore::sidecarPath(m_currentLogFile), &rollupError)) {
+        emit error(rollupError);
+    }
+
+    QString thumbnailError;
+    if (!m_thumbnails.startRecording(m_currentLogFile, &thumbnailError)) {
+        emit error("Cannot create thumbnail atlas: " + thumbnailError);
+    }
+
+    m_catalog.beginSession(m_currentLogFile);
+
     m_isLogging = true;
     emit loggingChanged();
     
@@ -56,15 +114,39 @@ void DataLogger::stopLogging()
         return;
     }
 
-    if (m_stream) {
-        delete m_stream;
-        m_stream = nullptr;
+    m_flushTimer->stop();
+    flushPending();
+
+    // Other files can keep the writer saturated, so wait for room until the
+    // tail is submitted. If it never is, say what was lost.
+    AsyncWriter *writer = AsyncWriter::shared();
+    for (int attempt = 0; attempt < StopFlushAttempts && (!m_pendingRows.isEmpty() || !m_pendingFrameRows.isEmpty()); ++attempt) {
+        writer->waitForIdle();
+        flushPending();
+    }
+    if (!m_pendingRows.isEmpty() || !m_pendingFrameRows.isEmpty()) {
+        emit error(QString("The writer had no room for the last %1 log rows and %2 frame index rows; they were not saved.")
+                       .arg(m_pendingRowCount).arg(m_pendingFrameRows.count('\n')));
+        m_pendingRows.clear();
+        m_pendingRowCount = 0;
+        m_pendingFrameRows.clear();
+    }
+
+    if (m_logFileId >= 0) {
+        writer->close(m_logFileId);
+        m_logFileId = -1;
+        m_catalog.endSession(m_currentLogFile, m_logBytes);
+    }
+    if (m_frameIndexFileId >= 0) {
+        writer->close(m_frameIndexFileId);
+        m_frameIndexFileId = -1;
     }
 
-    if (m_logFile) {
-        m_logFile->close();
-        delete m_logFile;
-        m_logFile = nullptr;
+    m_rollups.closeOutput();
+    m_thumbnails.stopRecording();
+    if (m_isReviewing) {
+        publishRecorded();
+        stopFollowing();
     }
 
     m_isLogging = false;
@@ -75,47 +157,87 @@ void DataLogger::stopLogging()
 
 bool DataLogger::loadLogFile(const QString &filename)
 {
-    if (!QFile::exists(filename)) {
-        emit error("File does not exist: " + filename);
+    stopFollowing();
+
+    QString readError;
+    if (!readLogFile(filename, m_readings, &readError)) {
+        m_frameIndex.clear();
+        emit error(readError);
         return false;
     }
+
+    QString frameIndexPath = FrameIndex::sidecarPath(filename);
+    QString frameIndexError;
+    m_frameIndex.clear();
+    if (!QFile::exists(frameIndexPath) || !m_frameIndex.load(frameIndexPath, &frameIndexError)) {
+        if (!frameIndexError.isEmpty()) {
+            qDebug() << frameIndexError;
+        }
+        buildFrameIndexFromReadings();
+    }
+
+    loadRollups(filename);
+
+    QFileInfo fileInfo(filename);
+    m_loadedLogFile = fileInfo.absoluteFilePath();
+
+    SessionInfo session;
+    session.logFile = m_loadedLogFile;
+    session.startMs = m_readings.first().timestampMs;
+    session.endMs = m_readings.last().timestampMs;
+    session.rows = m_readings.size();
+    session.frames = m_frameIndex.size();
+    session.sizeBytes = fileInfo.size();
+    m_catalog.updateSession(session);
+    m_catalog.setActiveSession(m_loadedLogFile, m_frameIndex);
+
+    emit dataLoaded();
+    qDebug() << "Successfully loaded" << m_readings.size() << "readings from" << filename;
+    return true;
+}
+
+bool DataLogger::readLogFile(const QString &filename, SensorDataset &readings, QString *errorMessage)
+{
+    auto fail = [errorMessage](const QString &message) {
+        if (errorMessage) {
+            *errorMessage = message;
+        }
+        return false;
+    };
+
+    readings.clear();
+
+    if (!QFile::exists(filename)) {
+        return fail("File does not exist: " + filename);
+    }
     
     QFileInfo fileInfo(filename);
     if (!fileInfo.isReadable()) {
-        emit error("File is not readable: " + filename + ". Please check file permissions.");
-        return false;
+        return fail("File is not readable: " + filename + ". Please check file permissions.");
     }
     
     if (fileInfo.size() == 0) {
-        emit error("File is empty: " + filename);
-        return false;
+        return fail("File is empty: " + filename);
     }
     
     QFile file(filename);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        emit error("Cannot open file: " + filename + ". Error: " + file.errorString());
-        return false;
+        return fail("Cannot open file: " + filename + ". Error: " + file.errorString());
     }
 
-    m_readings.clear();
     QTextStream in(&file);
     
     try {
         if (in.atEnd()) {
-            file.close();
-            emit error("File appears to be empty or corrupted: " + filename);
-            return false;
+            return fail("File appears to be empty or corrupted: " + filename);
         }
         
         QString header = in.readLine();
-        if (!header.contains("Timestamp") || !header.contains("Temperature") || !header.contains("Pressure")) {
-            emit error("Invalid file format. Expected CSV with Timestamp, Temperature, and Pressure columns: " + filename);
-            file.close();
-            return false;
+        if (!isValidHeader(header)) {
+            return fail("Invalid file format. Expected CSV with Timestamp, Temperature, and Pressure columns: " + filename);
         }
         
         int lineNumber = 1;
-        int validReadings = 0;
         int invalidLines = 0;
         
         while (!in.atEnd()) {
@@ -124,70 +246,314 @@ bool DataLogger::loadLogFile(const QString &filename)
             
             if (line.isEmpty()) continue;
             
-            QStringList parts = line.split(',');
-            
-            if (parts.size() >= 3) {
-                SensorReading reading;
-                
-                reading.timestamp = QDateTime::fromString(parts[0].trimmed(), Qt::ISODate);
-                if (!reading.timestamp.isValid()) {
-                    invalidLines++;
-                    qDebug() << "Invalid timestamp on line" << lineNumber << ":" << parts[0];
-                    continue;
-                }
-                
-                bool tempOk;
-                reading.temperature = parts[1].trimmed().toDouble(&tempOk);
-                if (!tempOk) {
-                    invalidLines++;
-                    qDebug() << "Invalid temperature on line" << lineNumber << ":" << parts[1];
-                    continue;
-                }
-                
-                bool pressOk;
-                reading.pressure = parts[2].trimmed().toDouble(&pressOk);
-                if (!pressOk) {
-                    invalidLines++;
-                    qDebug() << "Invalid pressure on line" << lineNumber << ":" << parts[2];
-                    continue;
-                }
-                
-                if (parts.size() > 3) {
-                    reading.frameFilename = parts[3].trimmed();
-                }
-                
-                m_readings.append(reading);
-                validReadings++;
-            } else {
+            SensorReading reading;
+            QString parseError;
+            if (!parseReading(line, reading, &parseError)) {
                 invalidLines++;
-                qDebug() << "Invalid line format on line" << lineNumber << ":" << line;
+                qDebug() << parseError << "on line" << lineNumber << ":" << line;
+                continue;
             }
+            
+            readings.append(reading);
         }
         
-        file.close();
-        
-        if (validReadings == 0) {
-            emit error("No valid data found in file: " + filename);
-            return false;
+        if (readings.isEmpty()) {
+            return fail("No valid data found in file: " + filename);
         }
         
         if (invalidLines > 0) {
             qDebug() << "Warning: Skipped" << invalidLines << "invalid lines while loading" << filename;
         }
-        
-        emit dataLoaded();
-        qDebug() << "Successfully loaded" << validReadings << "readings from" << filename;
         return true;
         
     } catch (const std::exception &e) {
-        file.close();
-        emit error("Error reading file " + filename + ": " + QString(e.what()));
-        return false;
+        return fail("Error reading file " + filename + ": " + QString(e.what()));
     } catch (...) {
-        file.close();
-        emit error("Unknown error occurred while reading file: " + filename);
+        return fail("Unknown error occurred while reading file: " + filename);
+    }
+}
+
+bool DataLogger::followLogFile(const QString &filename)
+{
+    if (m_isLogging) {
+        emit error("Stop recording before following a log file");
+        return false;
+    }
+
+    QFileInfo fileInfo(filename);
+    if (!fileInfo.exists() || !fileInfo.isReadable()) {
+        emit error("File does not exist or is not readable: " + filename);
+        return false;
+    }
+
+    stopFollowing();
+    m_readings.clear();
+    m_frameIndex.clear();
+    m_rollups.clear();
+    m_followedFrame.clear();
+    m_fileFrameStart = 0;
+    m_followSkipped = 0;
+    m_loadedLogFile = fileInfo.absoluteFilePath();
+
+    QString followError;
+    if (!m_logFollower->open(m_loadedLogFile, &followError)) {
+        emit error(followError);
+        return false;
+    }
+    openFrameFollower();
+
+    // The existing contents are read in one pass like loadLogFile(); only
+    // what arrives after this is reported incrementally.
+    m_followLoaded = false;
+    m_frameFollower->readAvailable();
+    m_logFollower->readAvailable();
+    m_followLoaded = true;
+
+    m_catalog.setActiveSession(m_loadedLogFile, m_frameIndex);
+
+    m_isFollowing = true;
+    emit followingChanged();
+    emit dataLoaded();
+    qDebug() << "Following" << m_loadedLogFile << "from" << m_readings.size() << "readings";
+    return true;
+}
+
+void DataLogger::stopFollowing()
+{
+    if (!m_isFollowing) {
+        return;
+    }
+
+    m_logFollower->close();
+    m_frameFollower->close();
+    m_isReviewing = false;
+    m_isFollowing = false;
+    emit followingChanged();
+    qDebug() << "Stopped following" << m_loadedLogFile;
+}
+
+bool DataLogger::reviewRecording()
+{
+    if (!m_isLogging) {
+        emit error("Nothing is being recorded");
+        return false;
+    }
+
+    // Playback shares the rows being recorded rather than reloading them;
+    // each flush hands it a newer snapshot of the same dataset.
+    stopFollowing();
+    m_loadedLogFile = m_currentLogFile;
+    m_reviewedReadings = m_readings.size();
+    m_reviewedFrames = m_frameIndex.size();
+    m_catalog.setActiveSession(m_loadedLogFile, m_frameIndex);
+
+    m_isReviewing = true;
+    m_isFollowing = true;
+    emit followingChanged();
+    emit dataLoaded();
+    qDebug() << "Reviewing" << m_loadedLogFile << "while recording," << m_reviewedReadings << "readings so far";
+    return true;
+}
+
+void DataLogger::publishRecorded()
+{
+    if (!m_isReviewing) {
+        return;
+    }
+
+    if (m_frameIndex.size() > m_reviewedFrames) {
+        int first = m_reviewedFrames;
+        m_reviewedFrames = m_frameIndex.size();
+        if (first == 0) {
+            m_catalog.setActiveSession(m_loadedLogFile, m_frameIndex);
+        }
+        emit framesAppended(first);
+    }
+    if (m_readings.size() > m_reviewedReadings) {
+        int first = m_reviewedReadings;
+        m_reviewedReadings = m_readings.size();
+        emit readingsAppended(first);
+    }
+}
+
+QVariantMap DataLogger::followStatus() const
+{
+    QVariantMap status;
+    status["following"] = m_isFollowing;
+    status["reviewingRecording"] = m_isReviewing;
+    status["logFile"] = m_logFollower->fileName();
+    status["bytesRead"] = m_logFollower->bytesRead() + m_frameFollower->bytesRead();
+    status["offset"] = m_logFollower->offset();
+    status["rotations"] = m_logFollower->rotations();
+    status["readings"] = m_readings.size();
+    status["frames"] = m_frameIndex.size();
+    status["skippedRows"] = m_followSkipped;
+    return status;
+}
+
+void DataLogger::openFrameFollower()
+{
+    QString frameIndexPath = FrameIndex::sidecarPath(m_logFollower->fileName());
+    if (!QFile::exists(frameIndexPath)) {
+        return;
+    }
+
+    QString followError;
+    if (!m_frameFollower->open(frameIndexPath, &followError)) {
+        qDebug() << followError;
+    }
+}
+
+void DataLogger::appendFollowedRows(const QList<QByteArray> &lines)
+{
+    int first = m_readings.size();
+    int firstFrame = m_frameIndex.size();
+
+    for (const QByteArray &line : lines) {
+        QString text = QString::fromUtf8(line);
+        if (isValidHeader(text)) {
+            continue;
+        }
+
+        SensorReading reading;
+        QString parseError;
+        if (!parseReading(text, reading, &parseError)) {
+            m_followSkipped++;
+            qDebug() << parseError << "while following" << m_logFollower->fileName() << ":" << text;
+            continue;
+        }
+        // Playback searches by time, so rows must stay ordered. A rewritten
+        // or truncated file replays rows that are already held; drop them.
+        if (!m_readings.isEmpty() && reading.timestampMs < m_readings.last().timestampMs) {
+            m_followSkipped++;
+            continue;
+        }
+
+        m_readings.append(reading);
+        m_rollups.add(reading.timestampMs, reading.temperature, reading.pressure);
+
+        // Until the writer creates its frame index, frames come from the
+        // log's frame column.
+        if (!m_frameFollower->isOpen() && !reading.frameFilename.isEmpty()
+            && reading.frameFilename != m_followedFrame) {
+            m_frameIndex.append(reading.timestampMs, reading.frameFilename);
+            m_followedFrame = reading.frameFilename;
+        }
+    }
+
+    if (!m_frameFollower->isOpen() && QFile::exists(FrameIndex::sidecarPath(m_logFollower->fileName()))) {
+        // The sidecar has exact frame times; replace what the frame column
+        // gave for this file with its contents.
+        FrameIndex earlier;
+        for (int i = 0; i < m_fileFrameStart && i < m_frameIndex.size(); ++i) {
+            earlier.append(m_frameIndex.at(i).timestampMs, m_frameIndex.at(i).filename);
+        }
+        m_frameIndex = earlier;
+        openFrameFollower();
+        m_frameFollower->readAvailable();
+        if (m_followLoaded) {
+            emit frameIndexReset();
+        }
+        firstFrame = m_frameIndex.size();
+    }
+
+    if (!m_followLoaded) {
+        return;
+    }
+    if (firstFrame == 0 && !m_frameIndex.isEmpty()) {
+        m_catalog.setActiveSession(m_loadedLogFile, m_frameIndex);
+    }
+    if (m_readings.size() > first) {
+        emit readingsAppended(first);
+    }
+    if (m_frameIndex.size() > firstFrame) {
+        emit framesAppended(firstFrame);
+    }
+}
+
+void DataLogger::appendFollowedFrames(const QList<QByteArray> &lines)
+{
+    int firstFrame = m_frameIndex.size();
+
+    for (const QByteArray &line : lines) {
+        int separator = line.indexOf(',');
+        if (separator <= 0) continue;
+
+        bool ok;
+        qint64 timestampMs = line.left(separator).toLongLong(&ok);
+        if (!ok) continue;
+
+        QString filename = QString::fromUtf8(line.mid(separator + 1)).trimmed();
+        if (!m_frameIndex.isEmpty()) {
+            const FrameIndexEntry &last = m_frameIndex.at(m_frameIndex.size() - 1);
+            if (timestampMs < last.timestampMs || (timestampMs == last.timestampMs && filename == last.filename)) {
+                continue;
+            }
+        }
+        m_frameIndex.append(timestampMs, filename);
+    }
+
+    if (m_followLoaded && m_frameIndex.size() > firstFrame) {
+        if (firstFrame == 0) {
+            m_catalog.setActiveSession(m_loadedLogFile, m_frameIndex);
+        }
+        emit framesAppended(firstFrame);
+    }
+}
+
+void DataLogger::followedFileRotated(const QString &filename)
+{
+    // A log replaced under the same name keeps its sidecar follower, which
+    // notices the replacement itself.
+    if (filename == m_loadedLogFile) {
+        return;
+    }
+
+    // The writer moved on to a new log; keep the dataset growing across it.
+    m_frameFollower->close();
+    m_fileFrameStart = m_frameIndex.size();
+    m_followedFrame.clear();
+    m_loadedLogFile = filename;
+    openFrameFollower();
+    qDebug() << "Following rotated log" << filename;
+}
+
+bool DataLogger::isValidHeader(const QString &header)
+{
+    return header.contains("Timestamp") && header.contains("Temperature") && header.contains("Pressure");
+}
+
+bool DataLogger::parseReading(const QString &line, SensorReading &reading, QString *errorMessage)
+{
+    QStringList parts = line.split(',');
+    if (parts.size() < 3) {
+        if (errorMessage) *errorMessage = "Invalid line format";
+        return false;
+    }
+    
+    reading.timestamp = QDateTime::fromString(parts[0].trimmed(), Qt::ISODate);
+    if (!reading.timestamp.isValid()) {
+        if (errorMessage) *errorMessage = "Invalid timestamp";
         return false;
     }
+    reading.timestampMs = reading.timestamp.toMSecsSinceEpoch();
+    
+    bool tempOk;
+    reading.temperature = parts[1].trimmed().toDouble(&tempOk);
+    if (!tempOk) {
+        if (errorMessage) *errorMessage = "Invalid temperature";
+        return false;
+    }
+    
+    bool pressOk;
+    reading.pressure = parts[2].trimmed().toDouble(&pressOk);
+    if (!pressOk) {
+        if (errorMessage) *errorMessage = "Invalid pressure";
+        return false;
+    }
+    
+    reading.frameFilename = parts.size() > 3 ? parts[3].trimmed() : QString();
+    return true;
 }
 
 QString DataLogger::getDataDirectory()
@@ -197,49 +563,170 @@ QString DataLogger::getDataDirectory()
 
 void DataLogger::logSensorData(double temperature, double pressure, const QString &timestamp)
 {
-    if (!m_isLogging || !m_stream) {
+    QDateTime dateTime = QDateTime::fromString(timestamp, Qt::ISODate);
+    qint64 timestampMs = dateTime.isValid() ? dateTime.toMSecsSinceEpoch() : QDateTime::currentMSecsSinceEpoch();
+    logSample(timestampMs, temperature, pressure);
+}
+
+void DataLogger::logSample(qint64 timestampMs, double temperature, double pressure)
+{
+    if (!m_isLogging || m_logFileId < 0) {
         return;
     }
 
-    try {
-        QString isoTimestamp = timestamp;
-        if (!timestamp.contains('T')) {
-            isoTimestamp = QDateTime::currentDateTime().toString(Qt::ISODate);
-        }
-        
-        QString frameFile = m_lastFrameFilename.isEmpty() ? "" : m_lastFrameFilename;
-        *m_stream << isoTimestamp << "," << QString::number(temperature, 'f', 4) << "," 
-                  << QString::number(pressure, 'f', 3) << "," << frameFile << "\n";
-        
-        if (m_stream->status() != QTextStream::Ok) {
-            emit error("Error writing to log file. The disk may be full or the file may be locked.");
-            return;
+    // Rows are batched and handed to the asynchronous writer; the caller
+    // never waits on the disk.
+    QDateTime timestamp = QDateTime::fromMSecsSinceEpoch(timestampMs);
+    QString frameFile = m_pendingFrameFilename;
+    m_pendingRows += timestamp.toString(Qt::ISODateWithMs).toUtf8() + ','
+                     + QByteArray::number(temperature, 'f', 4) + ','
+                     + QByteArray::number(pressure, 'f', 3) + ','
+                     + frameFile.toUtf8() + '\n';
+    m_pendingRowCount++;
+
+    if (m_pendingRows.size() >= 64 * 1024) {
+        flushPending();
+    } else if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+
+    m_pendingFrameFilename.clear();
+    m_rollups.add(timestampMs, temperature, pressure);
+
+    SensorReading reading;
+    reading.timestamp = timestamp;
+    reading.timestampMs = timestampMs;
+    reading.temperature = temperature;
+    reading.pressure = pressure;
+    reading.frameFilename = frameFile;
+    m_readings.append(reading);
+}
+
+void DataLogger::logFrame(const QString &frameFilename, qint64 timestampMs)
+{
+    // Frames saved while nothing is recorded belong to no session; the
+    // index may hold a loaded or followed one.
+    if (!m_isLogging) {
+        return;
+    }
+
+    m_frameIndex.append(timestampMs, frameFilename);
+    m_pendingFrameFilename = frameFilename;
+    if (!openFrameIndexFile()) {
+        return;
+    }
+
+    m_pendingFrameRows += QByteArray::number(timestampMs) + "," + frameFilename.toUtf8() + "\n";
+    m_thumbnails.addFrame(frameFilename, timestampMs);
+    m_catalog.addFrame(m_currentLogFile, timestampMs);
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void DataLogger::flushPending()
+{
+    publishRecorded();
+
+    qint64 logBytes = m_pendingRows.size();
+    bool logDone = submitRows(m_logFileId, m_pendingRows, m_pendingRowCount);
+    if (logDone) {
+        m_logBytes += logBytes;
+        if (m_pendingRowCount > 0 && !m_readings.isEmpty()) {
+            m_catalog.addRows(m_currentLogFile, m_pendingRowCount, m_readings.first().timestampMs, m_readings.last().timestampMs);
         }
-        
-        m_stream->flush();
-        
-        if (m_logFile && m_logFile->error() != QFile::NoError) {
-            emit error("Log file error: " + m_logFile->errorString() + ". Logging may be incomplete.");
-            return;
+        m_pendingRowCount = 0;
+    }
+    bool indexDone = submitRows(m_frameIndexFileId, m_pendingFrameRows, 0);
+
+    if (logDone && indexDone) {
+        m_flushTimer->stop();
+        m_backlogReported = false;
+        return;
+    }
+
+    // Rejected by the in-flight limit: keep the rows and retry on the next tick.
+    if (!m_backlogReported && m_pendingRows.size() > 8 * 1024 * 1024) {
+        m_backlogReported = true;
+        emit error("Log writes are falling behind the disk. Buffered rows are being held in memory.");
+    }
+    if (m_isLogging && !m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+bool DataLogger::submitRows(int fileId, QByteArray &rows, int rowCount)
+{
+    if (rows.isEmpty() || fileId < 0) {
+        return true;
+    }
+
+    bool submitted = AsyncWriter::shared()->append(fileId, rows, true, this,
+        [this, rowCount](bool ok, const QString &errorMessage) {
+            if (ok) {
+                m_rowsDurable += rowCount;
+            } else {
+                emit error("Log file write error: " + errorMessage + ". Logging may be incomplete.");
+            }
+        });
+    if (submitted) {
+        rows.clear();
+    }
+    return submitted;
+}
+
+bool DataLogger::openFrameIndexFile()
+{
+    if (m_frameIndexFileId >= 0) {
+        return true;
+    }
+
+    QString filename = FrameIndex::sidecarPath(m_currentLogFile);
+    QString errorMessage;
+    m_frameIndexFileId = AsyncWriter::shared()->openAppend(filename, true, &errorMessage);
+    if (m_frameIndexFileId < 0) {
+        emit error("Cannot create frame index: " + errorMessage);
+        return false;
+    }
+
+    m_pendingFrameRows = "TimestampMs,FrameFile\n" + m_pendingFrameRows;
+    return true;
+}
+
+void DataLogger::buildFrameIndexFromReadings()
+{
+    m_frameIndex.clear();
+
+    QString previousFrame;
+    for (const SensorReading &reading : m_readings.snapshot()) {
+        if (!reading.frameFilename.isEmpty() && reading.frameFilename != previousFrame) {
+            m_frameIndex.append(reading.timestampMs, reading.frameFilename);
+            previousFrame = reading.frameFilename;
         }
-        
-        SensorReading reading;
-        reading.timestamp = QDateTime::fromString(isoTimestamp, Qt::ISODate);
-        reading.temperature = temperature;
-        reading.pressure = pressure;
-        reading.frameFilename = frameFile;
-        m_readings.append(reading);
-        
-    } catch (const std::exception &e) {
-        emit error("Error logging sensor data: " + QString(e.what()));
-    } catch (...) {
-        emit error("Unknown error occurred while logging sensor data");
     }
 }
 
-void DataLogger::logFrame(const QString &frameFilename)
+void DataLogger::loadRollups(const QString &logFilename)
 {
-    m_lastFrameFilename = frameFilename;
+    // The persisted rollups are trusted only if they cover every reading;
+    // a session that ended without stopLogging() is rebuilt and rewritten.
+    QString rollupPath = RollupStore::sidecarPath(logFilename);
+    QString rollupError;
+    if (QFile::exists(rollupPath) && m_rollups.load(rollupPath, &rollupError)
+        && m_rollups.sampleCount() == quint64(m_readings.size())) {
+        return;
+    }
+    if (!rollupError.isEmpty()) {
+        qDebug() << rollupError;
+    }
+
+    m_rollups.clear();
+    for (const SensorReading &reading : m_readings.snapshot()) {
+        m_rollups.add(reading.timestampMs, reading.temperature, reading.pressure);
+    }
+    if (!m_rollups.save(rollupPath, &rollupError)) {
+        qDebug() << rollupError;
+    }
 }
 
 bool DataLogger::createLogFile()
@@ -261,16 +748,13 @@ bool DataLogger::createLogFile()
     QString timestamp = QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss");
     QString filename = m_dataDirectory + "/sensor_log_" + timestamp + ".csv";
     
-    m_logFile = new QFile(filename);
-    if (!m_logFile->open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QString errorMsg = QString("Cannot create log file: %1. Error: %2").arg(filename, m_logFile->errorString());
-        emit error(errorMsg);
-        delete m_logFile;
-        m_logFile = nullptr;
+    QString errorMessage;
+    m_logFileId = AsyncWriter::shared()->openAppend(filename, true, &errorMessage);
+    if (m_logFileId < 0) {
+        emit error("Cannot create log file: " + errorMessage);
         return false;
     }
 
-    m_stream = new QTextStream(m_logFile);
     m_currentLogFile = filename;
     emit currentLogFileChanged();
     
@@ -281,8 +765,6 @@ bool DataLogger::createLogFile()
 
 void DataLogger::writeHeader()
 {
-    if (m_stream) {
-        *m_stream << "Timestamp,Temperature(C),Pressure(hPa),FrameFile\n";
-        m_stream->flush();
-    }
+    m_pendingRows = "Timestamp,Temperature(C),Pressure(hPa),FrameFile\n" + m_pendingRows;
+    flushPending();
 }
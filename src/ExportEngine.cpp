@@ -0,0 +1,559 @@
+#include "ExportEngine.h"
+#include "FrameIndex.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QDataStream>
+#include <QMutexLocker>
+#include <QThread>
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+static const char BinaryMagic[4] = {'C', 'S', 'D', 'B'};
+static const char CompressedMagic[4] = {'C', 'S', 'D', 'Z'};
+static const quint32 ExportVersion = 1;
+static const qint64 BinaryCountOffset = 8;
+
+ExportEngine::ExportEngine(int maxThreads, QObject *parent)
+    : QObject(parent)
+    , m_isRunning(false)
+    , m_cancelled(false)
+    , m_progress(0.0)
+    , m_rowsWritten(0)
+    , m_framesWritten(0)
+    , m_framesFailed(0)
+    , m_lastPercent(-1)
+    , m_nextSequence(0)
+    , m_nextWrite(0)
+{
+    if (maxThreads <= 0) {
+        maxThreads = std::max(1, QThread::idealThreadCount());
+    }
+    // One extra thread for the reader, which spends most of its time
+    // blocked on the in-flight limit.
+    m_pool.setMaxThreadCount(maxThreads + 1);
+    m_maxInFlight = maxThreads * 2;
+    m_slots.release(m_maxInFlight);
+}
+
+ExportEngine::~ExportEngine()
+{
+    cancel();
+    waitForDone();
+}
+
+bool ExportEngine::parseFormat(const QString &text, ExportFormat &format)
+{
+    QString name = text.trimmed().toLower();
+    if (name.isEmpty() || name == "csv") {
+        format = ExportFormat::Csv;
+    } else if (name == "binary" || name == "bin") {
+        format = ExportFormat::Binary;
+    } else if (name == "compressed" || name == "csvz") {
+        format = ExportFormat::Compressed;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool ExportEngine::parseFrameMode(const QString &text, FrameExportMode &mode)
+{
+    QString name = text.trimmed().toLower();
+    if (name.isEmpty() || name == "none") {
+        mode = FrameExportMode::None;
+    } else if (name == "copy") {
+        mode = FrameExportMode::Copy;
+    } else if (name == "transcode") {
+        mode = FrameExportMode::Transcode;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+QString ExportEngine::formatExtension(ExportFormat format)
+{
+    switch (format) {
+    case ExportFormat::Csv: return "csv";
+    case ExportFormat::Binary: return "bin";
+    case ExportFormat::Compressed: return "csvz";
+    }
+    return "csv";
+}
+
+bool ExportEngine::exportRange(const QString &sourceLogFile, const QString &outputFile,
+                               const QDateTime &startTime, const QDateTime &endTime,
+                               const QString &format, const QString &frameMode, int resampleIntervalMs,
+                               const QString &resampleMethod)
+{
+    ExportOptions options;
+    options.sourceLogFile = sourceLogFile;
+    options.startMs = startTime.isValid() ? startTime.toMSecsSinceEpoch() : 0;
+    options.endMs = endTime.isValid() ? endTime.toMSecsSinceEpoch() : 0;
+    options.resampleIntervalMs = std::max(0, resampleIntervalMs);
+
+    if (!parseFormat(format, options.format)) {
+        emit error("Unknown export format: " + format);
+        return false;
+    }
+    if (!parseFrameMode(frameMode, options.frameMode)) {
+        emit error("Unknown frame export mode: " + frameMode);
+        return false;
+    }
+    if (!Resampler::parseMethod(resampleMethod, options.resampleMethod)) {
+        emit error("Unknown resampling method: " + resampleMethod);
+        return false;
+    }
+
+    options.outputFile = outputFile;
+    if (options.outputFile.isEmpty()) {
+        QFileInfo source(sourceLogFile);
+        QString timestamp = QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss");
+        options.outputFile = source.absolutePath() + "/export_" + source.completeBaseName() + "_" + timestamp
+                             + "." + formatExtension(options.format);
+    }
+
+    return start(options);
+}
+
+bool ExportEngine::start(const ExportOptions &options)
+{
+    if (m_isRunning) {
+        emit error("An export is already running");
+        return false;
+    }
+
+    if (!QFileInfo::exists(options.sourceLogFile)) {
+        emit error("Export source does not exist: " + options.sourceLogFile);
+        return false;
+    }
+
+    m_options = options;
+    m_options.chunkRows = std::max(1, m_options.chunkRows);
+    m_cancelled = false;
+    m_progress = 0.0;
+    m_rowsWritten = 0;
+    m_framesWritten = 0;
+    m_framesFailed = 0;
+    m_lastPercent = -1;
+    m_completed.clear();
+    m_nextSequence = 0;
+    m_nextWrite = 0;
+    m_failure.clear();
+
+    m_isRunning = true;
+    emit runningChanged();
+    emit progressChanged();
+
+    m_pool.start([this]() { run(); });
+    qDebug() << "Export started:" << m_options.sourceLogFile << "->" << m_options.outputFile;
+    return true;
+}
+
+void ExportEngine::cancel()
+{
+    if (m_isRunning) {
+        m_cancelled = true;
+    }
+}
+
+void ExportEngine::waitForDone()
+{
+    m_pool.waitForDone();
+}
+
+void ExportEngine::fail(const QString &message)
+{
+    QMutexLocker locker(&m_writeMutex);
+    if (m_failure.isEmpty()) {
+        m_failure = message;
+    }
+    m_cancelled = true;
+}
+
+void ExportEngine::reportProgress(double fraction)
+{
+    fraction = std::clamp(fraction, 0.0, 1.0);
+    int percent = static_cast<int>(fraction * 100.0);
+    if (percent == m_lastPercent) {
+        return;
+    }
+    m_lastPercent = percent;
+    m_progress = fraction;
+    emit progressChanged();
+    emit progressUpdated(fraction, m_rowsWritten.load(), m_framesWritten.load());
+}
+
+QString ExportEngine::resolveFramePath(const QString &frameFilename) const
+{
+    QFileInfo info(frameFilename);
+    if (info.isAbsolute() && info.exists()) {
+        return frameFilename;
+    }
+
+    QString logDirectory = QFileInfo(m_options.sourceLogFile).absolutePath();
+    QString candidate = logDirectory + "/" + frameFilename;
+    if (QFileInfo::exists(candidate)) {
+        return candidate;
+    }
+    return logDirectory + "/" + info.fileName();
+}
+
+void ExportEngine::run()
+{
+    QFile input(m_options.sourceLogFile);
+    if (!input.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        fail("Cannot open export source: " + m_options.sourceLogFile + ". Error: " + input.errorString());
+    }
+
+    QFileInfo outputInfo(m_options.outputFile);
+    QDir().mkpath(outputInfo.absolutePath());
+    m_output.setFileName(m_options.outputFile);
+    bool outputCreated = !m_cancelled && m_output.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    if (!m_cancelled && !outputCreated) {
+        fail("Cannot create export file: " + m_options.outputFile + ". Error: " + m_output.errorString());
+    }
+
+    if (!m_cancelled && !DataLogger::isValidHeader(QString::fromUtf8(input.readLine()))) {
+        fail("Invalid file format. Expected CSV with Timestamp, Temperature, and Pressure columns: " + m_options.sourceLogFile);
+    }
+
+    if (!m_cancelled && !writeHeader()) {
+        fail("Cannot write export file: " + m_output.errorString());
+    }
+
+    // Frames come from the sidecar index when there is one, otherwise from
+    // the FrameFile column as the rows stream past.
+    FrameIndex frames;
+    QString sidecar = FrameIndex::sidecarPath(m_options.sourceLogFile);
+    bool haveSidecar = QFile::exists(sidecar) && frames.load(sidecar);
+    int nextFrame = 0;
+
+    QString framesDirectory = outputInfo.absolutePath() + "/" + outputInfo.completeBaseName() + "_frames";
+    QFile frameIndexOutput(FrameIndex::sidecarPath(m_options.outputFile));
+    if (!m_cancelled) {
+        if (m_options.frameMode != FrameExportMode::None && !QDir().mkpath(framesDirectory)) {
+            fail("Cannot create frame export directory: " + framesDirectory);
+        } else if (!frameIndexOutput.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            fail("Cannot create export frame index: " + frameIndexOutput.fileName());
+        } else {
+            frameIndexOutput.write("TimestampMs,FrameFile\n");
+        }
+    }
+
+    auto inRange = [this](qint64 timestampMs) {
+        return timestampMs >= m_options.startMs && (m_options.endMs <= 0 || timestampMs <= m_options.endMs);
+    };
+
+    QString previousFrame;
+    auto exportFrame = [&](qint64 timestampMs, const QString &frameFilename) {
+        if (frameFilename.isEmpty() || frameFilename == previousFrame || !inRange(timestampMs)) {
+            return;
+        }
+        previousFrame = frameFilename;
+
+        QString exportedName = frameFilename;
+        if (m_options.frameMode != FrameExportMode::None) {
+            exportedName = framesDirectory + "/" + QFileInfo(frameFilename).fileName();
+            submitFrame(timestampMs, resolveFramePath(frameFilename), exportedName);
+        }
+        frameIndexOutput.write(QByteArray::number(timestampMs) + "," + exportedName.toUtf8() + "\n");
+    };
+
+    qint64 totalBytes = std::max<qint64>(1, input.size());
+    QVector<SensorReading> chunk;
+    chunk.reserve(m_options.chunkRows);
+
+    // Resampled rows carry the last frame seen in the interval that starts
+    // at their timestamp.
+    std::unique_ptr<Resampler> resampler;
+    if (m_options.resampleIntervalMs > 0) {
+        resampler = std::make_unique<Resampler>(m_options.resampleMethod, m_options.resampleIntervalMs, 2);
+    }
+    QHash<qint64, QString> intervalFrames;
+    auto takeResampled = [&]() {
+        qint64 timestampMs;
+        double values[2];
+        while (resampler->takePoint(timestampMs, values)) {
+            QString frameFilename = intervalFrames.take(timestampMs);
+            if (std::isnan(values[0])) {
+                continue;
+            }
+            SensorReading point;
+            point.timestampMs = timestampMs;
+            point.timestamp = QDateTime::fromMSecsSinceEpoch(timestampMs);
+            point.temperature = values[0];
+            point.pressure = values[1];
+            point.frameFilename = frameFilename;
+            chunk.append(point);
+        }
+    };
+
+    while (!m_cancelled && !input.atEnd()) {
+        QString line = QString::fromUtf8(input.readLine()).trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        SensorReading reading;
+        if (!DataLogger::parseReading(line, reading)) {
+            continue;
+        }
+        if (m_options.endMs > 0 && reading.timestampMs > m_options.endMs) {
+            break;
+        }
+
+        if (haveSidecar) {
+            while (nextFrame < frames.size() && frames.at(nextFrame).timestampMs <= reading.timestampMs) {
+                exportFrame(frames.at(nextFrame).timestampMs, frames.at(nextFrame).filename);
+                nextFrame++;
+            }
+        } else {
+            exportFrame(reading.timestampMs, reading.frameFilename);
+        }
+
+        if (!inRange(reading.timestampMs)) {
+            continue;
+        }
+
+        if (resampler) {
+            if (!reading.frameFilename.isEmpty()) {
+                qint64 interval = m_options.resampleIntervalMs;
+                qint64 start = reading.timestampMs - reading.timestampMs % interval;
+                if (m_options.resampleMethod != ResampleMethod::Mean && start < reading.timestampMs) {
+                    start += interval;
+                }
+                intervalFrames.insert(start, reading.frameFilename);
+            }
+            double values[2] = {reading.temperature, reading.pressure};
+            resampler->push(reading.timestampMs, values);
+            takeResampled();
+        } else {
+            chunk.append(reading);
+        }
+
+        if (chunk.size() >= m_options.chunkRows) {
+            submitChunk(std::move(chunk));
+            chunk = QVector<SensorReading>();
+            chunk.reserve(m_options.chunkRows);
+        }
+
+        reportProgress(double(input.pos()) / totalBytes * 0.99);
+    }
+
+    if (!m_cancelled) {
+        while (haveSidecar && nextFrame < frames.size()) {
+            exportFrame(frames.at(nextFrame).timestampMs, frames.at(nextFrame).filename);
+            nextFrame++;
+        }
+        if (resampler) {
+            resampler->finish();
+            takeResampled();
+        }
+        if (!chunk.isEmpty()) {
+            submitChunk(std::move(chunk));
+        }
+    }
+
+    // Every in-flight chunk and frame holds a slot; taking all of them back
+    // means the workers are done.
+    m_slots.acquire(m_maxInFlight);
+    m_slots.release(m_maxInFlight);
+
+    bool success = m_failure.isEmpty() && !m_cancelled;
+    if (success && !finalizeOutput()) {
+        fail("Cannot finalize export file: " + m_output.errorString());
+        success = false;
+    }
+    m_output.close();
+    frameIndexOutput.close();
+
+    QString message;
+    if (success) {
+        reportProgress(1.0);
+        message = QString("Exported %1 rows and %2 frames").arg(m_rowsWritten.load()).arg(m_framesWritten.load());
+        if (m_framesFailed > 0) {
+            message += QString(" (%1 frames could not be exported)").arg(m_framesFailed.load());
+        }
+    } else {
+        message = m_failure.isEmpty() ? QString("Export cancelled") : m_failure;
+        if (outputCreated) {
+            QFile::remove(m_options.outputFile);
+            QFile::remove(frameIndexOutput.fileName());
+            if (m_options.frameMode != FrameExportMode::None) {
+                QDir(framesDirectory).removeRecursively();
+            }
+        }
+    }
+
+    qDebug() << "Export finished:" << message;
+
+    // The engine only becomes idle on its own thread, once this task has
+    // returned, so a new start() cannot reuse the options and state still
+    // in use here.
+    QMetaObject::invokeMethod(this, [this, success, message]() {
+        m_pool.waitForDone();
+        m_isRunning = false;
+        emit runningChanged();
+        if (!m_failure.isEmpty()) {
+            emit error(m_failure);
+        }
+        emit finished(success, m_options.outputFile, message);
+    }, Qt::QueuedConnection);
+}
+
+bool ExportEngine::writeHeader()
+{
+    QByteArray header;
+    switch (m_options.format) {
+    case ExportFormat::Csv:
+        header = "Timestamp,Temperature(C),Pressure(hPa),FrameFile\n";
+        break;
+    case ExportFormat::Binary: {
+        QDataStream stream(&header, QIODevice::WriteOnly);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream.writeRawData(BinaryMagic, 4);
+        stream << ExportVersion << quint64(0);
+        break;
+    }
+    case ExportFormat::Compressed: {
+        QDataStream stream(&header, QIODevice::WriteOnly);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream.writeRawData(CompressedMagic, 4);
+        stream << ExportVersion;
+        break;
+    }
+    }
+    return m_output.write(header) == header.size();
+}
+
+bool ExportEngine::finalizeOutput()
+{
+    if (m_options.format != ExportFormat::Binary) {
+        return m_output.flush();
+    }
+
+    QByteArray count;
+    QDataStream stream(&count, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << quint64(m_rowsWritten.load());
+    return m_output.seek(BinaryCountOffset) && m_output.write(count) == count.size() && m_output.flush();
+}
+
+QByteArray ExportEngine::encodeChunk(const QVector<SensorReading> &rows) const
+{
+    QByteArray data;
+    if (m_options.format == ExportFormat::Binary) {
+        data.reserve(rows.size() * 24);
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+        for (const SensorReading &reading : rows) {
+            stream << qint64(reading.timestampMs) << reading.temperature << reading.pressure;
+        }
+        return data;
+    }
+
+    data.reserve(rows.size() * 64);
+    for (const SensorReading &reading : rows) {
+        data += QDateTime::fromMSecsSinceEpoch(reading.timestampMs).toString(Qt::ISODateWithMs).toUtf8();
+        data += ',';
+        data += QByteArray::number(reading.temperature, 'f', 4);
+        data += ',';
+        data += QByteArray::number(reading.pressure, 'f', 3);
+        data += ',';
+        data += reading.frameFilename.toUtf8();
+        data += '\n';
+    }
+
+    if (m_options.format == ExportFormat::Compressed) {
+        QByteArray compressed = qCompress(data);
+        QByteArray block;
+        QDataStream stream(&block, QIODevice::WriteOnly);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream << quint32(compressed.size());
+        block += compressed;
+        return block;
+    }
+    return data;
+}
+
+void ExportEngine::submitChunk(QVector<SensorReading> rows)
+{
+    m_slots.acquire();
+    quint64 sequence = m_nextSequence++;
+    m_pool.start([this, sequence, rows = std::move(rows)]() {
+        QByteArray data;
+        if (!m_cancelled) {
+            data = encodeChunk(rows);
+        }
+        writeCompleted(sequence, data, rows.size());
+    });
+}
+
+void ExportEngine::writeCompleted(quint64 sequence, const QByteArray &data, int rows)
+{
+    // Chunks are encoded in parallel but must reach the file in order; a
+    // finished chunk waits here until all earlier ones are written.
+    QMutexLocker locker(&m_writeMutex);
+    m_completed.insert(sequence, qMakePair(data, rows));
+
+    while (!m_completed.isEmpty() && m_completed.firstKey() == m_nextWrite) {
+        QPair<QByteArray, int> next = m_completed.take(m_nextWrite);
+        m_nextWrite++;
+
+        if (!m_cancelled && !next.first.isEmpty()) {
+            if (m_output.write(next.first) != next.first.size()) {
+                if (m_failure.isEmpty()) {
+                    m_failure = "Failed to write export file: " + m_output.errorString();
+                }
+                m_cancelled = true;
+            } else {
+                m_rowsWritten += next.second;
+            }
+        }
+        m_slots.release();
+    }
+}
+
+void ExportEngine::submitFrame(qint64 timestampMs, const QString &sourcePath, const QString &targetPath)
+{
+    Q_UNUSED(timestampMs)
+    m_slots.acquire();
+    m_pool.start([this, sourcePath, targetPath]() {
+        bool ok = false;
+        if (!m_cancelled) {
+            try {
+                if (m_options.frameMode == FrameExportMode::Copy) {
+                    QFile::remove(targetPath);
+                    ok = QFile::copy(sourcePath, targetPath);
+                } else {
+                    cv::Mat frame = cv::imread(sourcePath.toStdString(), cv::IMREAD_COLOR);
+                    if (!frame.empty()) {
+                        if (m_options.frameSize.isValid() && !m_options.frameSize.isEmpty()) {
+                            cv::resize(frame, frame, cv::Size(m_options.frameSize.width(), m_options.frameSize.height()),
+                                       0, 0, cv::INTER_AREA);
+                        }
+                        std::vector<int> params = {cv::IMWRITE_JPEG_QUALITY, m_options.jpegQuality};
+                        ok = cv::imwrite(targetPath.toStdString(), frame, params);
+                    }
+                }
+            } catch (const cv::Exception &e) {
+                qDebug() << "OpenCV error while exporting frame" << sourcePath << ":" << e.what();
+            }
+
+            if (ok) {
+                m_framesWritten++;
+            } else {
+                m_framesFailed++;
+                qDebug() << "Failed to export frame:" << sourcePath;
+            }
+        }
+        m_slots.release();
+    });
+}
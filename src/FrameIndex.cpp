@@ -0,0 +1,109 @@
+#include "FrameIndex.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+bool entryBefore(const FrameIndexEntry &entry, qint64 timestampMs)
+{
+    return entry.timestampMs < timestampMs;
+}
+
+}
+
+void FrameIndex::append(qint64 timestampMs, const QString &filename)
+{
+    if (m_entries.isEmpty() || m_entries.last().timestampMs <= timestampMs) {
+        m_entries.append({timestampMs, filename});
+        return;
+    }
+
+    auto it = std::upper_bound(m_entries.begin(), m_entries.end(), timestampMs,
+                               [](qint64 value, const FrameIndexEntry &entry) {
+                                   return value < entry.timestampMs;
+                               });
+    m_entries.insert(it, {timestampMs, filename});
+}
+
+int FrameIndex::nearestFrame(qint64 timestampMs) const
+{
+    if (m_entries.isEmpty()) {
+        return -1;
+    }
+
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), timestampMs, entryBefore);
+    if (it == m_entries.begin()) {
+        return 0;
+    }
+    if (it == m_entries.end()) {
+        return m_entries.size() - 1;
+    }
+
+    auto previous = it - 1;
+    if (timestampMs - previous->timestampMs <= it->timestampMs - timestampMs) {
+        return static_cast<int>(previous - m_entries.begin());
+    }
+    return static_cast<int>(it - m_entries.begin());
+}
+
+QPair<qint64, qint64> FrameIndex::frameWindow(int index) const
+{
+    if (index < 0 || index >= m_entries.size()) {
+        return qMakePair(qint64(0), qint64(0));
+    }
+
+    qint64 timestampMs = m_entries[index].timestampMs;
+    qint64 start = std::numeric_limits<qint64>::min();
+    qint64 end = std::numeric_limits<qint64>::max();
+
+    if (index > 0) {
+        qint64 previous = m_entries[index - 1].timestampMs;
+        start = previous + (timestampMs - previous) / 2 + 1;
+    }
+    if (index < m_entries.size() - 1) {
+        qint64 next = m_entries[index + 1].timestampMs;
+        end = timestampMs + (next - timestampMs) / 2 + 1;
+    }
+
+    return qMakePair(start, end);
+}
+
+bool FrameIndex::load(const QString &filename, QString *errorMessage)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (errorMessage) {
+            *errorMessage = "Cannot open frame index: " + filename + ". Error: " + file.errorString();
+        }
+        return false;
+    }
+
+    m_entries.clear();
+    QTextStream in(&file);
+    in.readLine();
+
+    while (!in.atEnd()) {
+        QString line = in.readLine().trimmed();
+        if (line.isEmpty()) continue;
+
+        int separator = line.indexOf(',');
+        if (separator <= 0) continue;
+
+        bool ok;
+        qint64 timestampMs = line.left(separator).toLongLong(&ok);
+        if (!ok) continue;
+
+        append(timestampMs, line.mid(separator + 1).trimmed());
+    }
+
+    return true;
+}
+
+QString FrameIndex::sidecarPath(const QString &logFilename)
+{
+    QFileInfo info(logFilename);
+    return info.absolutePath() + "/" + info.completeBaseName() + ".frames.csv";
+}
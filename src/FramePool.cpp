@@ -0,0 +1,188 @@
+#include "FramePool.h"
+#include <QDebug>
+#include <algorithm>
+
+// ImageBuffer::state
+static const int ImageFree = 0;
+static const int ImageBusy = 1;
+static const int ImageOrphaned = 2;
+
+FramePool::FramePool(int capacity, int imageCapacity)
+    : m_capacity(std::max(2, capacity))
+    , m_imageCapacity(std::max(1, imageCapacity))
+    , m_rows(0)
+    , m_cols(0)
+    , m_type(0)
+    , m_next(0)
+    , m_acquired(0)
+    , m_exhausted(0)
+    , m_allocations(0)
+    , m_reallocations(0)
+    , m_imagesAcquired(0)
+    , m_imageAllocations(0)
+    , m_imagesExhausted(0)
+    , m_inUse(0)
+{
+}
+
+FramePool::~FramePool()
+{
+    clear();
+}
+
+bool FramePool::matches(int rows, int cols, int type) const
+{
+    return isConfigured() && m_rows == rows && m_cols == cols && m_type == type;
+}
+
+void FramePool::configure(int rows, int cols, int type)
+{
+    if (matches(rows, cols, type)) {
+        return;
+    }
+
+    // Buffers still held elsewhere stay valid; they are freed with their
+    // last reference instead of returning to the pool.
+    bool wasConfigured = isConfigured();
+    m_buffers.clear();
+    m_rows = rows;
+    m_cols = cols;
+    m_type = type;
+    m_next = 0;
+
+    m_buffers.reserve(m_capacity);
+    for (int i = 0; i < m_capacity; ++i) {
+        m_buffers.append(cv::Mat(rows, cols, type));
+    }
+    m_allocations += m_capacity;
+    if (wasConfigured) {
+        m_reallocations++;
+    }
+
+    qDebug() << "Frame pool sized to" << cols << "x" << rows << "type" << type << "with" << m_capacity << "buffers";
+}
+
+void FramePool::clear()
+{
+    m_buffers.clear();
+    m_next = 0;
+
+    for (ImageBuffer *buffer : m_images) {
+        if (buffer->state.exchange(ImageOrphaned) == ImageFree) {
+            destroyImage(buffer);
+        }
+    }
+    m_images.clear();
+}
+
+cv::Mat FramePool::acquire()
+{
+    if (m_buffers.isEmpty()) {
+        return cv::Mat();
+    }
+
+    // The pool holds one reference itself, so a buffer with a count of one
+    // is not referenced by any frame in flight.
+    int count = m_buffers.size();
+    int found = -1;
+    int busy = 0;
+    for (int i = 0; i < count; ++i) {
+        int index = (m_next + i) % count;
+        const cv::Mat &buffer = m_buffers[index];
+        if (buffer.u && buffer.u->refcount > 1) {
+            busy++;
+        } else if (found < 0) {
+            found = index;
+        }
+    }
+
+    if (found >= 0) {
+        m_inUse = busy + 1;
+        m_next = (found + 1) % count;
+        m_acquired++;
+        return m_buffers[found];
+    }
+
+    m_inUse = busy;
+    m_exhausted++;
+    m_allocations++;
+    return cv::Mat(m_rows, m_cols, m_type);
+}
+
+QImage FramePool::acquireImage(int width, int height, QImage::Format format)
+{
+    for (ImageBuffer *buffer : m_images) {
+        if (buffer->width != width || buffer->height != height || buffer->format != format) {
+            continue;
+        }
+        int expected = ImageFree;
+        if (buffer->state.compare_exchange_strong(expected, ImageBusy)) {
+            m_imagesAcquired++;
+            return QImage(buffer->data, width, height, format, &FramePool::releaseImage, buffer);
+        }
+    }
+
+    // Drop a free buffer of the wrong geometry to make room, if the pool is full.
+    if (m_images.size() >= m_imageCapacity) {
+        for (int i = 0; i < m_images.size(); ++i) {
+            ImageBuffer *buffer = m_images[i];
+            bool stale = buffer->width != width || buffer->height != height || buffer->format != format;
+            int expected = ImageFree;
+            if (stale && buffer->state.compare_exchange_strong(expected, ImageOrphaned)) {
+                destroyImage(buffer);
+                m_images.remove(i);
+                break;
+            }
+        }
+    }
+
+    m_imageAllocations++;
+    if (m_images.size() >= m_imageCapacity) {
+        m_imagesExhausted++;
+        return QImage(width, height, format);
+    }
+
+    // QImage needs 32-bit aligned scanlines for an external buffer.
+    int depth = QImage(1, 1, format).depth();
+    qsizetype bytesPerLine = ((qsizetype(width) * depth + 31) / 32) * 4;
+    auto *buffer = new ImageBuffer;
+    buffer->data = new uchar[size_t(bytesPerLine) * height];
+    buffer->width = width;
+    buffer->height = height;
+    buffer->format = format;
+    buffer->state = ImageBusy;
+    m_images.append(buffer);
+    m_imagesAcquired++;
+    return QImage(buffer->data, width, height, format, &FramePool::releaseImage, buffer);
+}
+
+void FramePool::releaseImage(void *info)
+{
+    auto *buffer = static_cast<ImageBuffer *>(info);
+    if (buffer->state.exchange(ImageFree) == ImageOrphaned) {
+        destroyImage(buffer);
+    }
+}
+
+void FramePool::destroyImage(ImageBuffer *buffer)
+{
+    delete[] buffer->data;
+    delete buffer;
+}
+
+QVariantMap FramePool::metrics() const
+{
+    QVariantMap result;
+    result["poolCapacity"] = m_capacity;
+    result["poolWidth"] = m_cols;
+    result["poolHeight"] = m_rows;
+    result["poolAcquired"] = m_acquired.load();
+    result["poolExhausted"] = m_exhausted.load();
+    result["poolAllocations"] = m_allocations.load();
+    result["poolReallocations"] = m_reallocations.load();
+    result["poolInUse"] = m_inUse.load();
+    result["poolImagesAcquired"] = m_imagesAcquired.load();
+    result["poolImageAllocations"] = m_imageAllocations.load();
+    result["poolImagesExhausted"] = m_imagesExhausted.load();
+    return result;
+}
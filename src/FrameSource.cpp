@@ -0,0 +1,625 @@
+#include "FrameSource.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QCommandLineParser>
+#include <algorithm>
+
+namespace {
+
+void packBgrToYuyv(const cv::Mat &bgr, cv::Mat &yuyv)
+{
+    cv::Mat yuv;
+    cv::cvtColor(bgr, yuv, cv::COLOR_BGR2YUV);
+    yuyv.create(yuv.rows, yuv.cols, CV_8UC2);
+
+    for (int y = 0; y < yuv.rows; ++y) {
+        const uchar *src = yuv.ptr<uchar>(y);
+        uchar *dst = yuyv.ptr<uchar>(y);
+        int x = 0;
+        for (; x + 1 < yuv.cols; x += 2) {
+            const uchar *p0 = src + x * 3;
+            const uchar *p1 = p0 + 3;
+            dst[x * 2] = p0[0];
+            dst[x * 2 + 1] = static_cast<uchar>((p0[1] + p1[1] + 1) >> 1);
+            dst[x * 2 + 2] = p1[0];
+            dst[x * 2 + 3] = static_cast<uchar>((p0[2] + p1[2] + 1) >> 1);
+        }
+        if (x < yuv.cols) {
+            const uchar *p0 = src + x * 3;
+            dst[x * 2] = p0[0];
+            dst[x * 2 + 1] = p0[1];
+        }
+    }
+}
+
+}
+
+FrameSource::FrameSource(const FrameSourceConfig &config)
+    : m_config(config)
+{
+}
+
+void FrameSource::setResolution(const QSize &resolution)
+{
+    m_config.resolution = resolution;
+}
+
+std::unique_ptr<FrameSource> FrameSource::create(const FrameSourceConfig &config)
+{
+    if (config.type == "file") {
+        return std::make_unique<VideoFileFrameSource>(config);
+    }
+    if (config.type == "images") {
+        return std::make_unique<ImageSequenceFrameSource>(config);
+    }
+    if (config.type == "pattern") {
+        return std::make_unique<PatternFrameSource>(config);
+    }
+    return std::make_unique<DeviceFrameSource>(config);
+}
+
+bool FrameSource::parseSpec(const QString &spec, FrameSourceConfig &config, QString *errorMessage)
+{
+    QString type = spec;
+    QString location;
+    int separator = spec.indexOf(':');
+    if (separator > 0) {
+        type = spec.left(separator).toLower();
+        location = spec.mid(separator + 1);
+    }
+
+    if (type == "device") {
+        bool ok;
+        location.toInt(&ok);
+        if (!ok) {
+            *errorMessage = "Invalid camera device index: " + location;
+            return false;
+        }
+    } else if (type == "file" || type == "images") {
+        if (!QFileInfo::exists(location)) {
+            *errorMessage = "Frame source does not exist: " + location;
+            return false;
+        }
+    } else if (type == "pattern") {
+        if (location.isEmpty()) {
+            location = "bars";
+        }
+        static const QStringList patterns = {"bars", "gradient", "checker", "noise"};
+        if (!patterns.contains(location)) {
+            *errorMessage = "Unknown test pattern: " + location + ". Expected one of: " + patterns.join(", ");
+            return false;
+        }
+    } else {
+        bool ok;
+        spec.toInt(&ok);
+        if (ok) {
+            type = "device";
+            location = spec;
+        } else if (QFileInfo(spec).isDir()) {
+            type = "images";
+            location = spec;
+        } else if (QFileInfo(spec).isFile()) {
+            type = "file";
+            location = spec;
+        } else {
+            *errorMessage = "Invalid frame source: " + spec + ". Expected device:<n>, file:<path>, images:<dir> or pattern:<name>";
+            return false;
+        }
+    }
+
+    config.type = type;
+    config.location = location;
+    return true;
+}
+
+bool FrameSource::parsePixelFormat(const QString &text, FramePixelFormat &format)
+{
+    QString name = text.toLower();
+    if (name == "bgr") {
+        format = FramePixelFormat::BGR;
+    } else if (name == "bgra") {
+        format = FramePixelFormat::BGRA;
+    } else if (name == "gray" || name == "grey") {
+        format = FramePixelFormat::Gray;
+    } else if (name == "yuyv") {
+        format = FramePixelFormat::YUYV;
+    } else if (name == "mjpeg" || name == "mjpg") {
+        format = FramePixelFormat::MJPEG;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+QString FrameSource::pixelFormatName(FramePixelFormat format)
+{
+    switch (format) {
+    case FramePixelFormat::BGR: return "bgr";
+    case FramePixelFormat::BGRA: return "bgra";
+    case FramePixelFormat::Gray: return "gray";
+    case FramePixelFormat::YUYV: return "yuyv";
+    case FramePixelFormat::MJPEG: return "mjpeg";
+    }
+    return "bgr";
+}
+
+bool FrameSource::decodeToBgr(const cv::Mat &frame, FramePixelFormat format, cv::Mat &bgr)
+{
+    switch (format) {
+    case FramePixelFormat::BGR:
+        bgr = frame;
+        return true;
+    case FramePixelFormat::BGRA:
+        cv::cvtColor(frame, bgr, cv::COLOR_BGRA2BGR);
+        return true;
+    case FramePixelFormat::Gray:
+        cv::cvtColor(frame, bgr, cv::COLOR_GRAY2BGR);
+        return true;
+    case FramePixelFormat::YUYV:
+        cv::cvtColor(frame, bgr, cv::COLOR_YUV2BGR_YUYV);
+        return true;
+    case FramePixelFormat::MJPEG:
+        bgr = cv::imdecode(frame, cv::IMREAD_COLOR);
+        return !bgr.empty();
+    }
+    return false;
+}
+
+bool FrameSource::convertFromBgr(const cv::Mat &bgr, cv::Mat &frame) const
+{
+    switch (m_config.pixelFormat) {
+    case FramePixelFormat::BGR:
+        if (frame.data != bgr.data) {
+            bgr.copyTo(frame);
+        }
+        return true;
+    case FramePixelFormat::BGRA:
+        cv::cvtColor(bgr, frame, cv::COLOR_BGR2BGRA);
+        return true;
+    case FramePixelFormat::Gray:
+        cv::cvtColor(bgr, frame, cv::COLOR_BGR2GRAY);
+        return true;
+    case FramePixelFormat::YUYV:
+        packBgrToYuyv(bgr, frame);
+        return true;
+    case FramePixelFormat::MJPEG: {
+        std::vector<uchar> encoded;
+        if (!cv::imencode(".jpg", bgr, encoded)) {
+            return false;
+        }
+        cv::Mat(1, static_cast<int>(encoded.size()), CV_8UC1, encoded.data()).copyTo(frame);
+        return true;
+    }
+    }
+    return false;
+}
+
+void FrameSource::addCommandLineOptions(QCommandLineParser &parser)
+{
+    parser.addOption(QCommandLineOption("source",
+        "Frame <source>: device:<n>, file:<video>, images:<dir> or pattern:<bars|gradient|checker|noise>. "
+        "Repeat to capture from several sources at once.", "source"));
+    parser.addOption(QCommandLineOption("fps", "Frame source rate in <fps>.", "fps"));
+    parser.addOption(QCommandLineOption("pixel-format",
+        "Frame source pixel <format>: bgr, bgra, gray, yuyv or mjpeg.", "format"));
+    parser.addOption(QCommandLineOption("unthrottled", "Read frames as fast as the source delivers them."));
+    parser.addOption(QCommandLineOption("no-loop", "Stop at the end of a file or image sequence instead of replaying it."));
+    parser.addOption(QCommandLineOption("change-threshold",
+        "Save a frame only if it differs from the last saved one by at least <percent> (0 saves every frame).", "percent"));
+    parser.addOption(QCommandLineOption("change-keepalive",
+        "With --change-threshold, still save a frame at least every <seconds>.", "seconds"));
+}
+
+bool FrameSource::applyCommandLineOptions(const QCommandLineParser &parser, QList<FrameSourceConfig> &configs, QString *errorMessage)
+{
+    if (configs.isEmpty()) {
+        configs.append(FrameSourceConfig());
+    }
+
+    if (parser.isSet("source")) {
+        FrameSourceConfig base = configs.first();
+        configs.clear();
+        const QStringList specs = parser.values("source");
+        for (const QString &spec : specs) {
+            FrameSourceConfig config = base;
+            if (!parseSpec(spec, config, errorMessage)) {
+                return false;
+            }
+            configs.append(config);
+        }
+    }
+
+    double fps = 0.0;
+    if (parser.isSet("fps")) {
+        bool ok;
+        fps = parser.value("fps").toDouble(&ok);
+        if (!ok || fps <= 0) {
+            *errorMessage = "Invalid frame rate: " + parser.value("fps");
+            return false;
+        }
+    }
+
+    FramePixelFormat pixelFormat = FramePixelFormat::BGR;
+    if (parser.isSet("pixel-format") && !parsePixelFormat(parser.value("pixel-format"), pixelFormat)) {
+        *errorMessage = "Invalid pixel format: " + parser.value("pixel-format");
+        return false;
+    }
+
+    double changeThreshold = -1.0;
+    if (parser.isSet("change-threshold")) {
+        bool ok;
+        changeThreshold = parser.value("change-threshold").toDouble(&ok);
+        if (!ok || changeThreshold < 0 || changeThreshold > 100) {
+            *errorMessage = "Invalid change threshold: " + parser.value("change-threshold");
+            return false;
+        }
+    }
+
+    int changeKeepAliveMs = -1;
+    if (parser.isSet("change-keepalive")) {
+        bool ok;
+        double seconds = parser.value("change-keepalive").toDouble(&ok);
+        if (!ok || seconds < 0) {
+            *errorMessage = "Invalid change keep-alive interval: " + parser.value("change-keepalive");
+            return false;
+        }
+        changeKeepAliveMs = static_cast<int>(seconds * 1000);
+    }
+
+    for (FrameSourceConfig &config : configs) {
+        if (changeThreshold >= 0) {
+            config.changeThreshold = changeThreshold;
+        }
+        if (changeKeepAliveMs >= 0) {
+            config.changeKeepAliveMs = changeKeepAliveMs;
+        }
+        if (fps > 0) {
+            config.fps = fps;
+        }
+        if (parser.isSet("pixel-format")) {
+            config.pixelFormat = pixelFormat;
+        }
+        if (parser.isSet("unthrottled")) {
+            config.unthrottled = true;
+        }
+        if (parser.isSet("no-loop")) {
+            config.loop = false;
+        }
+    }
+
+    return true;
+}
+
+DeviceFrameSource::DeviceFrameSource(const FrameSourceConfig &config)
+    : FrameSource(config)
+    , m_deviceIndex(config.location.toInt())
+    , m_nativeFormat(false)
+    , m_requestNative(false)
+    , m_formatChecked(false)
+{
+}
+
+bool DeviceFrameSource::open()
+{
+    qDebug() << "Attempting to open camera device" << m_deviceIndex << "...";
+
+    m_capture.open(m_deviceIndex, cv::CAP_V4L2);
+    if (!m_capture.isOpened()) {
+        qDebug() << "Failed to open camera device" << m_deviceIndex << "with V4L2, trying default backend...";
+        m_capture.open(m_deviceIndex);
+        if (!m_capture.isOpened()) {
+            qDebug() << "Failed to open camera device" << m_deviceIndex;
+            return false;
+        }
+    }
+
+    qDebug() << "Camera opened, configuring settings...";
+
+    m_nativeFormat = false;
+    m_formatChecked = false;
+    m_requestNative = m_config.pixelFormat == FramePixelFormat::MJPEG || m_config.pixelFormat == FramePixelFormat::YUYV;
+    if (m_requestNative) {
+        int fourcc = m_config.pixelFormat == FramePixelFormat::MJPEG
+                         ? cv::VideoWriter::fourcc('M', 'J', 'P', 'G')
+                         : cv::VideoWriter::fourcc('Y', 'U', 'Y', 'V');
+        m_capture.set(cv::CAP_PROP_FOURCC, fourcc);
+        m_capture.set(cv::CAP_PROP_CONVERT_RGB, 0);
+    }
+
+    m_capture.set(cv::CAP_PROP_FRAME_WIDTH, m_config.resolution.width());
+    m_capture.set(cv::CAP_PROP_FRAME_HEIGHT, m_config.resolution.height());
+    m_capture.set(cv::CAP_PROP_BUFFERSIZE, 1);
+    m_capture.set(cv::CAP_PROP_FPS, m_config.fps);
+
+    // No test read here: the caller warms the camera up by polling read()
+    // until the first frame arrives.
+    qDebug() << "Camera opened and configured";
+    return true;
+}
+
+void DeviceFrameSource::close()
+{
+    if (m_capture.isOpened()) {
+        m_capture.release();
+    }
+}
+
+bool DeviceFrameSource::read(cv::Mat &frame)
+{
+    if (m_requestNative && !m_formatChecked) {
+        return readFirstNativeFrame(frame);
+    }
+
+    if (m_nativeFormat || m_config.pixelFormat == FramePixelFormat::BGR) {
+        return m_capture.read(frame) && !frame.empty();
+    }
+
+    if (!m_capture.read(m_bgr) || m_bgr.empty()) {
+        return false;
+    }
+    return convertFromBgr(m_bgr, frame);
+}
+
+bool DeviceFrameSource::readFirstNativeFrame(cv::Mat &frame)
+{
+    // The first frame shows whether the camera honoured the requested format.
+    if (!m_capture.read(m_bgr) || m_bgr.empty()) {
+        return false;
+    }
+    m_formatChecked = true;
+
+    bool isMjpeg = m_config.pixelFormat == FramePixelFormat::MJPEG;
+    m_nativeFormat = isMjpeg ? (m_bgr.type() == CV_8UC1 && m_bgr.rows == 1)
+                             : m_bgr.type() == CV_8UC2;
+    qDebug() << "Native format:" << (m_nativeFormat ? pixelFormatName(m_config.pixelFormat) : QString("bgr"))
+             << "frame size:" << m_bgr.cols << "x" << m_bgr.rows;
+
+    if (m_nativeFormat) {
+        m_bgr.copyTo(frame);
+        return true;
+    }
+
+    // Converting BGR back to the requested format would only add an encode
+    // here and a decode downstream, so the source switches to BGR.
+    qDebug() << "Camera did not deliver native" << pixelFormatName(m_config.pixelFormat)
+             << "frames, delivering BGR instead";
+    m_capture.set(cv::CAP_PROP_CONVERT_RGB, 1);
+    m_config.pixelFormat = FramePixelFormat::BGR;
+    if (m_bgr.type() != CV_8UC3) {
+        return false;
+    }
+    m_bgr.copyTo(frame);
+    return true;
+}
+
+void DeviceFrameSource::setResolution(const QSize &resolution)
+{
+    FrameSource::setResolution(resolution);
+    if (m_capture.isOpened()) {
+        m_capture.set(cv::CAP_PROP_FRAME_WIDTH, resolution.width());
+        m_capture.set(cv::CAP_PROP_FRAME_HEIGHT, resolution.height());
+    }
+}
+
+QString DeviceFrameSource::description() const
+{
+    return QString("camera device %1").arg(m_deviceIndex);
+}
+
+VideoFileFrameSource::VideoFileFrameSource(const FrameSourceConfig &config)
+    : FrameSource(config)
+{
+}
+
+bool VideoFileFrameSource::open()
+{
+    if (!m_capture.open(m_config.location.toStdString())) {
+        qDebug() << "Failed to open video file" << m_config.location;
+        return false;
+    }
+    qDebug() << "Opened video file" << m_config.location
+             << "frames:" << m_capture.get(cv::CAP_PROP_FRAME_COUNT)
+             << "fps:" << m_capture.get(cv::CAP_PROP_FPS);
+    return true;
+}
+
+void VideoFileFrameSource::close()
+{
+    if (m_capture.isOpened()) {
+        m_capture.release();
+    }
+}
+
+bool VideoFileFrameSource::read(cv::Mat &frame)
+{
+    if (!m_capture.read(m_decoded) || m_decoded.empty()) {
+        if (!m_config.loop) {
+            return false;
+        }
+        m_capture.set(cv::CAP_PROP_POS_FRAMES, 0);
+        if (!m_capture.read(m_decoded) || m_decoded.empty()) {
+            return false;
+        }
+    }
+
+    const cv::Mat *bgr = &m_decoded;
+    cv::Size target(m_config.resolution.width(), m_config.resolution.height());
+    if (m_decoded.size() != target) {
+        cv::resize(m_decoded, m_resized, target, 0, 0, cv::INTER_AREA);
+        bgr = &m_resized;
+    }
+    return convertFromBgr(*bgr, frame);
+}
+
+QString VideoFileFrameSource::description() const
+{
+    return "video file " + m_config.location;
+}
+
+ImageSequenceFrameSource::ImageSequenceFrameSource(const FrameSourceConfig &config)
+    : FrameSource(config)
+    , m_position(0)
+{
+}
+
+bool ImageSequenceFrameSource::open()
+{
+    QDir dir(m_config.location);
+    const QStringList filters = {"*.jpg", "*.jpeg", "*.png", "*.bmp", "*.tif", "*.tiff"};
+    const QStringList names = dir.entryList(filters, QDir::Files, QDir::Name);
+
+    m_files.clear();
+    for (const QString &name : names) {
+        m_files.append(dir.absoluteFilePath(name));
+    }
+    m_position = 0;
+
+    if (m_files.isEmpty()) {
+        qDebug() << "No images found in" << m_config.location;
+        return false;
+    }
+
+    qDebug() << "Opened image sequence" << m_config.location << "with" << m_files.size() << "images";
+    return true;
+}
+
+void ImageSequenceFrameSource::close()
+{
+    m_files.clear();
+    m_position = 0;
+}
+
+bool ImageSequenceFrameSource::read(cv::Mat &frame)
+{
+    if (m_files.isEmpty()) {
+        return false;
+    }
+    if (m_position >= m_files.size()) {
+        if (!m_config.loop) {
+            return false;
+        }
+        m_position = 0;
+    }
+
+    cv::Mat image = cv::imread(m_files[m_position++].toStdString(), cv::IMREAD_COLOR);
+    if (image.empty()) {
+        return false;
+    }
+
+    cv::Size target(m_config.resolution.width(), m_config.resolution.height());
+    if (image.size() != target) {
+        cv::resize(image, m_resized, target, 0, 0, cv::INTER_AREA);
+        return convertFromBgr(m_resized, frame);
+    }
+    return convertFromBgr(image, frame);
+}
+
+QString ImageSequenceFrameSource::description() const
+{
+    return "image sequence " + m_config.location;
+}
+
+PatternFrameSource::PatternFrameSource(const FrameSourceConfig &config)
+    : FrameSource(config)
+    , m_isOpened(false)
+    , m_frameNumber(0)
+{
+}
+
+bool PatternFrameSource::open()
+{
+    buildPattern();
+    m_frameNumber = 0;
+    m_isOpened = true;
+    qDebug() << "Opened test pattern" << m_config.location << "at"
+             << m_config.resolution.width() << "x" << m_config.resolution.height();
+    return true;
+}
+
+void PatternFrameSource::close()
+{
+    m_isOpened = false;
+}
+
+void PatternFrameSource::setResolution(const QSize &resolution)
+{
+    FrameSource::setResolution(resolution);
+    if (m_isOpened) {
+        buildPattern();
+    }
+}
+
+void PatternFrameSource::buildPattern()
+{
+    int width = m_config.resolution.width();
+    int height = m_config.resolution.height();
+    m_frame.create(height, width, CV_8UC3);
+
+    if (m_config.location == "noise") {
+        m_pattern.release();
+        return;
+    }
+
+    m_pattern.create(height, width * 2, CV_8UC3);
+
+    if (m_config.location == "gradient") {
+        for (int y = 0; y < height; ++y) {
+            cv::Vec3b *row = m_pattern.ptr<cv::Vec3b>(y);
+            for (int x = 0; x < width * 2; ++x) {
+                int phase = (x % width) * 255 / std::max(1, width - 1);
+                row[x] = cv::Vec3b(static_cast<uchar>(phase), static_cast<uchar>(y * 255 / std::max(1, height - 1)),
+                                   static_cast<uchar>(255 - phase));
+            }
+        }
+    } else if (m_config.location == "checker") {
+        int cell = std::max(8, height / 12);
+        for (int y = 0; y < height; ++y) {
+            cv::Vec3b *row = m_pattern.ptr<cv::Vec3b>(y);
+            for (int x = 0; x < width * 2; ++x) {
+                uchar value = ((x / cell + y / cell) % 2) ? 230 : 25;
+                row[x] = cv::Vec3b(value, value, value);
+            }
+        }
+    } else {
+        static const cv::Vec3b colors[] = {
+            {255, 255, 255}, {0, 255, 255}, {255, 255, 0}, {0, 255, 0},
+            {255, 0, 255}, {0, 0, 255}, {255, 0, 0}, {0, 0, 0}
+        };
+        int barWidth = std::max(1, width / 8);
+        for (int y = 0; y < height; ++y) {
+            cv::Vec3b *row = m_pattern.ptr<cv::Vec3b>(y);
+            for (int x = 0; x < width * 2; ++x) {
+                row[x] = colors[((x % width) / barWidth) % 8];
+            }
+        }
+    }
+}
+
+bool PatternFrameSource::read(cv::Mat &frame)
+{
+    if (!m_isOpened) {
+        return false;
+    }
+
+    int width = m_config.resolution.width();
+    if (m_pattern.empty()) {
+        cv::randu(m_frame, cv::Scalar::all(0), cv::Scalar::all(256));
+    } else {
+        int offset = static_cast<int>((m_frameNumber * 4) % static_cast<quint64>(width));
+        m_pattern(cv::Rect(offset, 0, width, m_frame.rows)).copyTo(m_frame);
+    }
+
+    cv::putText(m_frame, std::to_string(m_frameNumber), cv::Point(20, 40),
+                cv::FONT_HERSHEY_SIMPLEX, 1, cv::Scalar(0, 0, 0), 3);
+    cv::putText(m_frame, std::to_string(m_frameNumber), cv::Point(20, 40),
+                cv::FONT_HERSHEY_SIMPLEX, 1, cv::Scalar(255, 255, 255), 1);
+    m_frameNumber++;
+
+    return convertFromBgr(m_frame, frame);
+}
+
+QString PatternFrameSource::description() const
+{
+    return "test pattern " + m_config.location;
+}
@@ -0,0 +1,186 @@
+#include "FrameWriter.h"
+#include "AsyncWriter.h"
+#include <QDebug>
+#include <QFile>
+#include <QThread>
+#include <algorithm>
+#include <vector>
+
+FrameWriter::FrameWriter(int maxThreads, int maxPending, QObject *parent)
+    : QObject(parent)
+    , m_maxPending(maxPending)
+    , m_pending(0)
+    , m_written(0)
+    , m_rejected(0)
+    , m_failed(0)
+{
+    if (maxThreads <= 0) {
+        maxThreads = std::max(1, QThread::idealThreadCount() / 2);
+    }
+    m_pool.setMaxThreadCount(maxThreads);
+
+    if (m_maxPending <= 0) {
+        m_maxPending = maxThreads * 4;
+    }
+}
+
+FrameWriter::~FrameWriter()
+{
+    waitForDone();
+}
+
+bool FrameWriter::submit(const QString &cameraId, const cv::Mat &frame, FramePixelFormat format,
+                         const QString &filename, qint64 timestampMs)
+{
+    if (frame.empty()) {
+        return false;
+    }
+
+    if (m_pending.fetch_add(1) >= m_maxPending) {
+        m_pending.fetch_sub(1);
+        m_rejected++;
+        qDebug() << "FrameWriter queue full, dropping frame for camera" << cameraId;
+        return false;
+    }
+
+    m_pool.start([this, cameraId, frame, format, filename, timestampMs]() {
+        // Encoding stays on this pool; the file write goes to the shared
+        // asynchronous writer so a slow disk never holds an encoder thread.
+        std::vector<uchar> encoded;
+        QString message;
+        try {
+            if (!encodeJpeg(frame, format, encoded)) {
+                message = "Failed to encode camera frame for: " + filename;
+            }
+        } catch (const cv::Exception &e) {
+            message = "OpenCV error while saving frame: " + QString(e.what());
+        }
+
+        if (!message.isEmpty()) {
+            m_pending.fetch_sub(1);
+            m_failed++;
+            emit writeFailed(cameraId, filename, message);
+            return;
+        }
+
+        QByteArray bytes(reinterpret_cast<const char *>(encoded.data()), static_cast<qsizetype>(encoded.size()));
+        bool submitted = AsyncWriter::shared()->writeFile(filename, bytes, false, nullptr,
+            [this, cameraId, filename, timestampMs](bool ok, const QString &errorMessage) {
+                m_pending.fetch_sub(1);
+                if (ok) {
+                    m_written++;
+                    emit frameWritten(cameraId, filename, timestampMs);
+                } else {
+                    m_failed++;
+                    emit writeFailed(cameraId, filename, "Failed to write camera frame to: " + filename + ". " + errorMessage);
+                }
+            });
+        if (!submitted) {
+            m_pending.fetch_sub(1);
+            m_rejected++;
+            qDebug() << "Write queue full, dropping frame for camera" << cameraId;
+        }
+    });
+
+    return true;
+}
+
+void FrameWriter::waitForDone()
+{
+    m_pool.waitForDone();
+    AsyncWriter::shared()->waitForIdle();
+}
+
+static bool hasHuffmanTables(const cv::Mat &jpeg)
+{
+    // Many UVC cameras emit MJPEG without a DHT segment, which most decoders
+    // other than libjpeg refuse to open. The header segments are walked by
+    // their lengths, so FF C4 inside an EXIF thumbnail or a comment does not
+    // count. A truncated or malformed header counts as having no tables and
+    // gets the frame re-encoded.
+    const uchar *data = jpeg.ptr<uchar>();
+    size_t size = jpeg.total() * jpeg.elemSize();
+    if (size < 2 || data[0] != 0xFF || data[1] != 0xD8) {
+        return false;
+    }
+
+    size_t i = 2;
+    while (i + 1 < size) {
+        if (data[i] != 0xFF) {
+            return false;
+        }
+        uchar marker = data[i + 1];
+        if (marker == 0xFF) {
+            // Fill byte before a marker.
+            i++;
+            continue;
+        }
+        if (marker == 0xC4) {
+            return true;
+        }
+        if (marker == 0xDA || marker == 0xD9) {
+            return false;
+        }
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+            // Markers without a length.
+            i += 2;
+            continue;
+        }
+        if (i + 3 >= size) {
+            return false;
+        }
+        size_t length = (size_t(data[i + 2]) << 8) | data[i + 3];
+        if (length < 2) {
+            return false;
+        }
+        i += 2 + length;
+    }
+    return false;
+}
+
+bool FrameWriter::encodeJpeg(const cv::Mat &frame, FramePixelFormat format, std::vector<uchar> &encoded)
+{
+    if (frame.empty()) {
+        return false;
+    }
+
+    if (format == FramePixelFormat::MJPEG && frame.isContinuous() && hasHuffmanTables(frame)) {
+        const uchar *data = frame.ptr<uchar>();
+        encoded.assign(data, data + frame.total() * frame.elemSize());
+        return true;
+    }
+
+    cv::Mat bgr;
+    if (!FrameSource::decodeToBgr(frame, format, bgr)) {
+        return false;
+    }
+    return cv::imencode(".jpg", bgr, encoded);
+}
+
+bool FrameWriter::writeJpeg(const cv::Mat &frame, FramePixelFormat format, const QString &filename, QString *errorMessage)
+{
+    QString message;
+    try {
+        std::vector<uchar> encoded;
+        if (encodeJpeg(frame, format, encoded)) {
+            QFile file(filename);
+            if (file.open(QIODevice::WriteOnly)) {
+                qint64 size = static_cast<qint64>(encoded.size());
+                if (file.write(reinterpret_cast<const char *>(encoded.data()), size) != size) {
+                    message = "Failed to write camera frame to: " + filename + ". " + file.errorString();
+                }
+            } else {
+                message = "Failed to save camera frame to: " + filename + ". " + file.errorString();
+            }
+        } else {
+            message = "Failed to encode camera frame for: " + filename;
+        }
+    } catch (const cv::Exception &e) {
+        message = "OpenCV error while saving frame: " + QString(e.what());
+    }
+
+    if (errorMessage) {
+        *errorMessage = message;
+    }
+    return message.isEmpty();
+}
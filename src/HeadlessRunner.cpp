@@ -0,0 +1,560 @@
+#include "HeadlessRunner.h"
+#include <QDebug>
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QSettings>
+#include <QTextStream>
+#include <algorithm>
+#include <csignal>
+
+namespace {
+
+volatile std::sig_atomic_t g_shutdownRequested = 0;
+volatile std::sig_atomic_t g_triggerRequested = 0;
+
+void handleShutdownSignal(int)
+{
+    g_shutdownRequested = 1;
+}
+
+void handleTriggerSignal(int)
+{
+    g_triggerRequested = 1;
+}
+
+}
+
+HeadlessRunner::HeadlessRunner(const HeadlessConfig &config, QObject *parent)
+    : QObject(parent)
+    , m_config(config)
+    , m_shutdownTimer(new QTimer(this))
+    , m_durationTimer(new QTimer(this))
+    , m_statsTimer(new QTimer(this))
+    , m_samplesLogged(0)
+    , m_alerts(0)
+    , m_events(0)
+    , m_errorCount(0)
+    , m_isRunning(false)
+{
+    m_shutdownTimer->setInterval(200);
+    connect(m_shutdownTimer, &QTimer::timeout, this, &HeadlessRunner::checkForShutdown);
+
+    m_durationTimer->setSingleShot(true);
+    connect(m_durationTimer, &QTimer::timeout, this, &HeadlessRunner::finish);
+
+    connect(m_statsTimer, &QTimer::timeout, this, &HeadlessRunner::reportProgress);
+
+    if (m_config.cameraEnabled) {
+        QList<FrameSourceConfig> sources = m_config.sources;
+        if (sources.isEmpty()) {
+            sources.append(FrameSourceConfig());
+        }
+        for (FrameSourceConfig source : sources) {
+            source.resolution = m_config.resolution;
+            m_cameraManager.addCamera(source);
+        }
+        m_cameraManager.setPreviewEnabled(false);
+        m_cameraManager.setFrameSaveInterval(m_config.frameSaveIntervalMs);
+        m_cameraManager.setBusName(m_config.busName);
+        m_cameraManager.setPreTriggerConfig(m_config.preTrigger);
+
+        connect(&m_cameraManager, &CameraManager::frameSaved,
+                &m_dataLogger, &DataLogger::logFrame);
+        connect(&m_cameraManager, &CameraManager::frameSaved,
+                &m_telemetry, &TelemetryStreamer::addFrame);
+    }
+    m_sensorGenerator.setSamplingRate(m_config.samplingRate);
+    QString busError;
+    if (!m_sensorGenerator.setBusName(m_config.busName, &busError)) {
+        qWarning() << busError;
+    }
+    connect(&m_sensorGenerator, &SensorDataGenerator::sampleReady,
+            &m_dataLogger, &DataLogger::logSample);
+    connect(&m_sensorGenerator, &SensorDataGenerator::sampleReady, this, [this]() {
+        m_samplesLogged++;
+    });
+    connect(&m_sensorGenerator, &SensorDataGenerator::sampleReady,
+            &m_telemetry, &TelemetryStreamer::addSample);
+
+    QString ruleError;
+    if (!m_ruleEngine.addRules(m_config.rules, &ruleError)) {
+        qWarning() << ruleError;
+    }
+    connect(&m_sensorGenerator, &SensorDataGenerator::sampleReady,
+            &m_ruleEngine, &RuleEngine::addSample);
+    connect(&m_ruleEngine, &RuleEngine::alertRaised, this, [this](const QString &rule, double value, qint64 timestampMs) {
+        m_alerts++;
+        qInfo().noquote() << QDateTime::fromMSecsSinceEpoch(timestampMs).toString(Qt::ISODateWithMs)
+                          << "ALERT" << rule << "value" << value;
+    });
+    if (m_config.cameraEnabled && m_config.preTrigger.isEnabled() && m_config.preTrigger.triggerOnAlert) {
+        connect(&m_ruleEngine, &RuleEngine::alertRaised, &m_cameraManager, [this](const QString &rule) {
+            m_cameraManager.trigger("alert:" + rule);
+        });
+    }
+    connect(&m_cameraManager, &CameraManager::eventRecorded, this, [this](const QString &cameraId, const QString &directory, int frames) {
+        m_events++;
+        qInfo().noquote() << "EVENT" << cameraId << frames << "frames in" << directory;
+    });
+    connect(&m_ruleEngine, &RuleEngine::alertCleared, this, [](const QString &rule, double value, qint64 timestampMs) {
+        qInfo().noquote() << QDateTime::fromMSecsSinceEpoch(timestampMs).toString(Qt::ISODateWithMs)
+                          << "CLEARED" << rule << "value" << value;
+    });
+
+    connect(&m_cameraManager, &CameraManager::error, this, [this](const QString &cameraId, const QString &message) {
+        m_errorCount++;
+        qWarning() << "Camera Error:" << cameraId << message;
+    });
+    connect(&m_dataLogger, &DataLogger::error, this, [this](const QString &message) {
+        m_errorCount++;
+        qWarning() << "Data Logger Error:" << message;
+    });
+    connect(&m_telemetry, &TelemetryStreamer::error, this, [this](const QString &message) {
+        m_errorCount++;
+        qWarning() << "Telemetry Error:" << message;
+    });
+}
+
+HeadlessRunner::~HeadlessRunner()
+{
+    stop();
+}
+
+bool HeadlessRunner::isRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], "--headless") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool HeadlessRunner::parseArguments(const QStringList &arguments, HeadlessConfig &config, QString *errorMessage)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Camera Sensor Dashboard headless acquisition");
+    QCommandLineOption helpOption = parser.addHelpOption();
+
+    QCommandLineOption headlessOption("headless", "Run acquisition without the QML user interface.");
+    QCommandLineOption configOption(QStringList() << "c" << "config",
+                                    "Read settings from an INI <file> ([headless] group).", "file");
+    QCommandLineOption durationOption(QStringList() << "d" << "duration",
+                                      "Stop after <seconds> (0 runs until SIGINT/SIGTERM).", "seconds");
+    QCommandLineOption rateOption(QStringList() << "r" << "sampling-rate",
+                                  "Sensor sampling rate in <hz>.", "hz");
+    QCommandLineOption resolutionOption("resolution", "Camera resolution as <WxH>.", "WxH");
+    QCommandLineOption frameIntervalOption("frame-interval", "Frame save interval in <ms>.", "ms");
+    QCommandLineOption noCameraOption("no-camera", "Log sensor data only, without opening a camera.");
+    QCommandLineOption statsOption("stats-interval", "Print throughput every <seconds> while running.", "seconds");
+    QCommandLineOption busOption("bus", "Publish frames and samples to the shared-memory bus <name>.", "name");
+    QCommandLineOption aggregateOption("aggregate", "Run a stand-in telemetry aggregator on [host:]<port>.", "host:port");
+
+    parser.addOptions({headlessOption, configOption, durationOption, rateOption, resolutionOption,
+                       frameIntervalOption, noCameraOption, statsOption, busOption, aggregateOption});
+    FrameSource::addCommandLineOptions(parser);
+    TelemetryStreamer::addCommandLineOptions(parser);
+    PreTriggerRecorder::addCommandLineOptions(parser);
+    RuleEngine::addCommandLineOptions(parser);
+
+    if (!parser.parse(arguments)) {
+        *errorMessage = parser.errorText();
+        return false;
+    }
+
+    if (parser.isSet(helpOption)) {
+        QTextStream(stdout) << parser.helpText();
+        *errorMessage = QString();
+        return false;
+    }
+
+    if (parser.isSet(configOption) && !loadConfigFile(parser.value(configOption), config, errorMessage)) {
+        return false;
+    }
+
+    bool ok = true;
+    if (parser.isSet(durationOption)) {
+        config.durationSeconds = parser.value(durationOption).toInt(&ok);
+        if (!ok || config.durationSeconds < 0) {
+            *errorMessage = "Invalid duration: " + parser.value(durationOption);
+            return false;
+        }
+    }
+
+    if (parser.isSet(rateOption)) {
+        config.samplingRate = parser.value(rateOption).toDouble(&ok);
+        if (!ok || config.samplingRate <= 0) {
+            *errorMessage = "Invalid sampling rate: " + parser.value(rateOption);
+            return false;
+        }
+    }
+
+    if (parser.isSet(resolutionOption) && !parseResolution(parser.value(resolutionOption), config.resolution)) {
+        *errorMessage = "Invalid resolution: " + parser.value(resolutionOption) + ". Expected WxH, e.g. 1280x720";
+        return false;
+    }
+
+    if (parser.isSet(frameIntervalOption)) {
+        config.frameSaveIntervalMs = parser.value(frameIntervalOption).toInt(&ok);
+        if (!ok || config.frameSaveIntervalMs <= 0) {
+            *errorMessage = "Invalid frame interval: " + parser.value(frameIntervalOption);
+            return false;
+        }
+    }
+
+    if (parser.isSet(noCameraOption)) {
+        config.cameraEnabled = false;
+    }
+
+    if (parser.isSet(statsOption)) {
+        config.statsIntervalSeconds = parser.value(statsOption).toInt(&ok);
+        if (!ok || config.statsIntervalSeconds < 0) {
+            *errorMessage = "Invalid stats interval: " + parser.value(statsOption);
+            return false;
+        }
+    }
+
+    if (parser.isSet(busOption)) {
+        config.busName = parser.value(busOption);
+    }
+    if (!config.busName.isEmpty() && !SharedBusWriter::isValidBusName(config.busName)) {
+        *errorMessage = "Invalid bus name: " + config.busName + ". Use letters, digits, '-' and '_'";
+        return false;
+    }
+
+    if (parser.isSet(aggregateOption)
+        && !TelemetryStreamer::parseEndpoint(parser.value(aggregateOption), config.aggregateHost, config.aggregatePort)) {
+        *errorMessage = "Invalid aggregator endpoint: " + parser.value(aggregateOption) + ". Expected [host:]port";
+        return false;
+    }
+    if (!TelemetryStreamer::applyCommandLineOptions(parser, config.telemetry, errorMessage)) {
+        return false;
+    }
+    if (!PreTriggerRecorder::applyCommandLineOptions(parser, config.preTrigger, errorMessage)) {
+        return false;
+    }
+
+    if (!RuleEngine::applyCommandLineOptions(parser, config.rules, errorMessage)) {
+        return false;
+    }
+
+    return FrameSource::applyCommandLineOptions(parser, config.sources, errorMessage);
+}
+
+bool HeadlessRunner::loadConfigFile(const QString &filename, HeadlessConfig &config, QString *errorMessage)
+{
+    if (!QFileInfo::exists(filename)) {
+        *errorMessage = "Config file does not exist: " + filename;
+        return false;
+    }
+
+    QSettings settings(filename, QSettings::IniFormat);
+    if (settings.status() != QSettings::NoError) {
+        *errorMessage = "Cannot parse config file: " + filename;
+        return false;
+    }
+
+    settings.beginGroup("headless");
+    config.durationSeconds = settings.value("duration", config.durationSeconds).toInt();
+    config.samplingRate = settings.value("samplingRate", config.samplingRate).toDouble();
+    config.frameSaveIntervalMs = settings.value("frameInterval", config.frameSaveIntervalMs).toInt();
+    config.cameraEnabled = settings.value("camera", config.cameraEnabled).toBool();
+    config.statsIntervalSeconds = settings.value("statsInterval", config.statsIntervalSeconds).toInt();
+    config.rules = settings.value("rules", config.rules).toStringList();
+    config.busName = settings.value("bus", config.busName).toString();
+    QString telemetry = settings.value("telemetry").toString();
+    if (!telemetry.isEmpty() && !TelemetryStreamer::parseEndpoint(telemetry, config.telemetry.host, config.telemetry.port)) {
+        *errorMessage = "Invalid telemetry endpoint in config file: " + telemetry;
+        return false;
+    }
+    config.telemetry.stationId = settings.value("telemetryStation", config.telemetry.stationId).toString();
+    config.telemetry.batchSize = settings.value("telemetryBatch", config.telemetry.batchSize).toInt();
+    config.telemetry.maxLatencyMs = settings.value("telemetryLatency", config.telemetry.maxLatencyMs).toInt();
+    config.telemetry.maxBufferedBytes = qint64(settings.value("telemetryBuffer", config.telemetry.maxBufferedBytes / (1024.0 * 1024.0)).toDouble() * 1024 * 1024);
+    config.telemetry.includeFrames = settings.value("telemetryFrames", config.telemetry.includeFrames).toBool();
+    config.preTrigger.preTriggerMs = int(settings.value("preTrigger", config.preTrigger.preTriggerMs / 1000.0).toDouble() * 1000);
+    config.preTrigger.postTriggerMs = int(settings.value("postTrigger", config.preTrigger.postTriggerMs / 1000.0).toDouble() * 1000);
+    config.preTrigger.maxRingBytes = qint64(settings.value("preTriggerBudget", config.preTrigger.maxRingBytes / (1024.0 * 1024.0)).toDouble() * 1024 * 1024);
+    config.preTrigger.triggerOnAlert = settings.value("alertTrigger", config.preTrigger.triggerOnAlert).toBool();
+    QString aggregate = settings.value("aggregate").toString();
+    if (!aggregate.isEmpty() && !TelemetryStreamer::parseEndpoint(aggregate, config.aggregateHost, config.aggregatePort)) {
+        *errorMessage = "Invalid aggregator endpoint in config file: " + aggregate;
+        return false;
+    }
+
+    QString resolution = settings.value("resolution").toString();
+    if (!resolution.isEmpty() && !parseResolution(resolution, config.resolution)) {
+        *errorMessage = "Invalid resolution in config file: " + resolution;
+        return false;
+    }
+
+    FrameSourceConfig base;
+    QString pixelFormat = settings.value("pixelFormat").toString();
+    if (!pixelFormat.isEmpty() && !FrameSource::parsePixelFormat(pixelFormat, base.pixelFormat)) {
+        *errorMessage = "Invalid pixel format in config file: " + pixelFormat;
+        return false;
+    }
+    base.fps = settings.value("fps", base.fps).toDouble();
+    base.unthrottled = settings.value("unthrottled", base.unthrottled).toBool();
+    base.loop = settings.value("loop", base.loop).toBool();
+    base.changeThreshold = settings.value("changeThreshold", base.changeThreshold).toDouble();
+    base.changeKeepAliveMs = static_cast<int>(settings.value("changeKeepAlive", base.changeKeepAliveMs / 1000.0).toDouble() * 1000);
+    if (base.fps <= 0) {
+        *errorMessage = "Invalid frame rate in config file: " + filename;
+        return false;
+    }
+
+    const QStringList sources = settings.value("source").toStringList();
+    config.sources.clear();
+    for (const QString &source : sources) {
+        FrameSourceConfig sourceConfig = base;
+        if (!FrameSource::parseSpec(source.trimmed(), sourceConfig, errorMessage)) {
+            return false;
+        }
+        config.sources.append(sourceConfig);
+    }
+    if (config.sources.isEmpty()) {
+        config.sources.append(base);
+    }
+    settings.endGroup();
+
+    if (config.samplingRate <= 0 || config.frameSaveIntervalMs <= 0 || config.durationSeconds < 0
+        || config.telemetry.batchSize <= 0 || config.telemetry.maxLatencyMs <= 0 || config.telemetry.maxBufferedBytes <= 0
+        || config.preTrigger.preTriggerMs < 0 || config.preTrigger.postTriggerMs < 0 || config.preTrigger.maxRingBytes <= 0) {
+        *errorMessage = "Invalid values in config file: " + filename;
+        return false;
+    }
+
+    return true;
+}
+
+bool HeadlessRunner::parseResolution(const QString &text, QSize &resolution)
+{
+    QStringList parts = text.toLower().split('x');
+    if (parts.size() != 2) {
+        return false;
+    }
+
+    bool widthOk, heightOk;
+    int width = parts[0].trimmed().toInt(&widthOk);
+    int height = parts[1].trimmed().toInt(&heightOk);
+    if (!widthOk || !heightOk || width <= 0 || height <= 0) {
+        return false;
+    }
+
+    resolution = QSize(width, height);
+    return true;
+}
+
+bool HeadlessRunner::start()
+{
+    if (m_isRunning) {
+        return true;
+    }
+
+    std::signal(SIGINT, handleShutdownSignal);
+    std::signal(SIGTERM, handleShutdownSignal);
+#ifdef SIGUSR1
+    std::signal(SIGUSR1, handleTriggerSignal);
+#endif
+
+    if (!m_dataLogger.startLogging()) {
+        qCritical() << "Failed to start data logging, aborting headless run";
+        return false;
+    }
+
+    // The stand-in aggregator listens before the streamer connects, so a
+    // loopback run needs no second process.
+    QString telemetryError;
+    if (m_config.aggregatePort != 0
+        && !m_aggregator.listen(m_config.aggregateHost, m_config.aggregatePort, m_dataLogger.getDataDirectory(), &telemetryError)) {
+        qWarning().noquote() << telemetryError;
+    }
+    if (!m_telemetry.start(m_config.telemetry, m_dataLogger.getDataDirectory(), &telemetryError)) {
+        qWarning().noquote() << telemetryError;
+    }
+
+    if (!m_sensorGenerator.start()) {
+        qCritical() << "Failed to start sensor data generation, aborting headless run";
+        m_dataLogger.stopLogging();
+        return false;
+    }
+
+    // Cameras open in the background. A device that fails is reported
+    // through CameraManager::error and retried, while sensor logging goes on.
+    if (m_config.cameraEnabled) {
+        m_cameraManager.startAll();
+    }
+
+    m_isRunning = true;
+    m_elapsed.start();
+    m_shutdownTimer->start();
+
+    if (m_config.durationSeconds > 0) {
+        m_durationTimer->start(m_config.durationSeconds * 1000);
+    }
+    if (m_config.statsIntervalSeconds > 0) {
+        m_statsTimer->start(m_config.statsIntervalSeconds * 1000);
+    }
+
+    qInfo() << "Headless acquisition started -" << m_config.samplingRate << "Hz sensors,"
+            << (m_config.cameraEnabled ? QString("%1 frame source(s)").arg(m_cameraManager.cameraCount()) : QString("camera disabled"))
+            << "- logging to" << m_dataLogger.currentLogFile();
+    return true;
+}
+
+void HeadlessRunner::stop()
+{
+    if (!m_isRunning) {
+        return;
+    }
+
+    m_shutdownTimer->stop();
+    m_durationTimer->stop();
+    m_statsTimer->stop();
+
+    m_cameraManager.stopAll();
+    // The last frames must reach the frame index before the logger closes it.
+    m_cameraManager.waitForSavedFrames();
+    m_sensorGenerator.stop();
+    m_ruleEngine.flush();
+    m_dataLogger.stopLogging();
+    m_telemetry.stop();
+    m_aggregator.close();
+    m_isRunning = false;
+}
+
+void HeadlessRunner::checkForShutdown()
+{
+    if (g_triggerRequested) {
+        g_triggerRequested = 0;
+        if (m_config.preTrigger.isEnabled()) {
+            qInfo() << "Trigger signal received, capturing an event";
+            m_cameraManager.trigger("signal");
+        }
+    }
+    if (g_shutdownRequested) {
+        qInfo() << "Shutdown requested, stopping acquisition";
+        finish();
+    }
+}
+
+void HeadlessRunner::reportProgress()
+{
+    printStatistics("Headless acquisition progress");
+}
+
+void HeadlessRunner::finish()
+{
+    if (!m_isRunning) {
+        return;
+    }
+
+    stop();
+    printStatistics("Headless acquisition summary");
+    QCoreApplication::quit();
+}
+
+void HeadlessRunner::printStatistics(const QString &title)
+{
+    double seconds = m_elapsed.isValid() ? m_elapsed.elapsed() / 1000.0 : 0.0;
+    double divisor = seconds > 0 ? seconds : 1.0;
+
+    quint64 framesCaptured = 0;
+    quint64 framesSaved = 0;
+    quint64 framesDropped = 0;
+    const QList<CameraCapture *> cameras = m_cameraManager.cameras();
+    for (CameraCapture *camera : cameras) {
+        framesCaptured += camera->framesCaptured();
+        framesSaved += camera->framesSaved();
+        framesDropped += camera->framesDropped();
+    }
+
+    QTextStream out(stdout);
+    out << title << "\n"
+        << "  Elapsed:          " << QString::number(seconds, 'f', 1) << " s\n"
+        << "  Samples logged:   " << m_samplesLogged
+        << " (" << QString::number(m_samplesLogged / divisor, 'f', 2) << " /s)\n"
+        << "  Frames captured:  " << framesCaptured
+        << " (" << QString::number(framesCaptured / divisor, 'f', 2) << " fps)\n"
+        << "  Frames saved:     " << framesSaved << "\n"
+        << "  Frames dropped:   " << framesDropped << "\n";
+
+    for (CameraCapture *camera : cameras) {
+        out << "    " << camera->cameraId() << " (" << camera->source() << "): "
+            << camera->framesCaptured() << " captured ("
+            << QString::number(camera->framesCaptured() / divisor, 'f', 2) << " fps), "
+            << camera->framesSaved() << " saved, "
+            << camera->framesDropped() << " dropped, "
+            << camera->framesUnchanged() << " unchanged, "
+            << (camera->timeToFirstFrameMs() >= 0 ? QString("first frame after %1 ms").arg(camera->timeToFirstFrameMs())
+                                                  : QString("no frame yet (%1)").arg(camera->stateName()))
+            << "\n";
+    }
+
+    if (m_ruleEngine.ruleCount() > 0) {
+        QVariantMap rules = m_ruleEngine.metrics();
+        out << "  Alerts raised:    " << m_alerts << " (" << m_ruleEngine.ruleCount() << " rules, "
+            << rules["batches"].toULongLong() << " batches, "
+            << QString::number(rules["meanBatchUs"].toDouble(), 'f', 1) << " us/batch mean, "
+            << QString::number(rules["maxBatchUs"].toDouble(), 'f', 1) << " us max)\n";
+    }
+
+    if (!m_config.busName.isEmpty()) {
+        quint64 published = 0;
+        quint64 slowReaderEvents = 0;
+        int readers = 0;
+        QList<QVariantMap> writers;
+        for (CameraCapture *camera : cameras) {
+            writers.append(camera->metrics());
+        }
+        writers.append(m_sensorGenerator.busMetrics());
+        for (const QVariantMap &writer : writers) {
+            published += writer["busPublished"].toULongLong();
+            slowReaderEvents += writer["busSlowReaderEvents"].toULongLong();
+            readers = std::max(readers, writer["busReaders"].toInt());
+        }
+        out << "  Bus:              " << m_config.busName << " (" << published << " messages, "
+            << readers << " readers, " << slowReaderEvents << " slow-reader events)\n";
+    }
+
+    if (m_config.cameraEnabled && m_config.preTrigger.isEnabled()) {
+        quint64 ringBytes = 0;
+        quint64 skipped = 0;
+        quint64 written = 0;
+        for (CameraCapture *camera : cameras) {
+            QVariantMap metrics = camera->metrics();
+            ringBytes += metrics["ringBytes"].toULongLong();
+            skipped += metrics["ringFramesSkipped"].toULongLong();
+            written += metrics["eventFramesWritten"].toULongLong();
+        }
+        out << "  Events captured:  " << m_events << " (" << written << " frames written, "
+            << QString::number(ringBytes / (1024.0 * 1024.0), 'f', 1) << " MB in pre-trigger rings, "
+            << skipped << " frames skipped by the ring encoder)\n";
+    }
+
+    if (m_config.telemetry.isEnabled()) {
+        QVariantMap telemetry = m_telemetry.metrics();
+        out << "  Telemetry:        " << m_config.telemetry.host << ":" << m_config.telemetry.port
+            << (telemetry["connected"].toBool() ? " connected, " : " disconnected, ")
+            << telemetry["batchesAcked"].toULongLong() << "/" << telemetry["batchesSent"].toULongLong() << " batches acknowledged, "
+            << telemetry["batchesWaiting"].toInt() << " waiting, "
+            << telemetry["batchesSpilled"].toULongLong() << " spilled, "
+            << telemetry["batchesDropped"].toULongLong() << " dropped, "
+            << telemetry["reconnects"].toULongLong() << " reconnects\n";
+    }
+    if (m_aggregator.isListening() || m_config.aggregatePort != 0) {
+        QVariantMap aggregate = m_aggregator.metrics();
+        out << "  Aggregator:       " << aggregate["batches"].toULongLong() << " batches, "
+            << aggregate["samples"].toULongLong() << " samples, "
+            << aggregate["frames"].toULongLong() << " frames, "
+            << aggregate["duplicates"].toULongLong() << " duplicates from "
+            << aggregate["stations"].toMap().size() << " station(s)\n";
+    }
+
+    out << "  Errors:           " << m_errorCount << "\n"
+        << "  Log file:         " << m_dataLogger.currentLogFile() << "\n";
+    out.flush();
+}
@@ -1,99 +1,276 @@
 #include "ImageProvider.h"
-#include <QMutexLocker>
+#include "SessionCatalog.h"
+#include "ThumbnailAtlas.h"
 #include <QDebug>
 #include <QApplication>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFileInfo>
 
 ImageProvider::ImageProvider()
     : QQuickImageProvider(QQuickImageProvider::Image)
     , m_playbackMode(false)
+    , m_displayActive(true)
+    , m_thumbnailAtlas(nullptr)
+    , m_sessionCatalog(nullptr)
+    , m_slotsContended(0)
 {
 }
 
+void ImageProvider::WaitStats::add(qint64 ns)
+{
+    count++;
+    totalNs += ns;
+    qint64 previous = maxNs.load(std::memory_order_relaxed);
+    while (ns > previous && !maxNs.compare_exchange_weak(previous, ns, std::memory_order_relaxed)) {
+    }
+}
+
+QVariantMap ImageProvider::WaitStats::toMap() const
+{
+    quint64 n = count.load();
+    QVariantMap result;
+    result["count"] = n;
+    result["avgUs"] = n > 0 ? double(totalNs.load()) / n / 1000.0 : 0.0;
+    result["maxUs"] = maxNs.load() / 1000.0;
+    return result;
+}
+
+QString ImageProvider::resolveSlotId(const QString &id) const
+{
+    QString slotId = id.section('?', 0, 0);
+    if (slotId.isEmpty() || slotId == "current") {
+        return m_primarySlot;
+    }
+    return slotId;
+}
+
+void ImageProvider::lockSlotsForRead()
+{
+    // The slot table is only written when a camera first publishes, so a
+    // failed try here is rare; it is counted to show it stays that way.
+    if (!m_slotsLock.tryLockForRead()) {
+        m_slotsContended++;
+        m_slotsLock.lockForRead();
+    }
+}
+
+ImageProvider::FrameSlot *ImageProvider::slot(const QString &slotId)
+{
+    lockSlotsForRead();
+    auto it = m_slots.constFind(slotId);
+    if (it != m_slots.constEnd()) {
+        FrameSlot *found = it.value().get();
+        m_slotsLock.unlock();
+        return found;
+    }
+    m_slotsLock.unlock();
+
+    QWriteLocker locker(&m_slotsLock);
+    std::shared_ptr<FrameSlot> &entry = m_slots[slotId];
+    if (!entry) {
+        entry = std::make_shared<FrameSlot>();
+    }
+    return entry.get();
+}
+
+void ImageProvider::setPrimarySlot(const QString &slotId)
+{
+    QWriteLocker locker(&m_slotsLock);
+    m_primarySlot = slotId;
+}
+
 QImage ImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
 {
-    Q_UNUSED(id)
     Q_UNUSED(requestedSize)
-    
-    QMutexLocker locker(&m_mutex);
-    
-    QImage imageToReturn;
-    
-    if (m_playbackMode && !m_playbackImage.isNull()) {
-        imageToReturn = m_playbackImage;
+
+    // "thumb/<ms>" serves a timeline preview from the mapped atlas.
+    if (id.startsWith("thumb/")) {
+        QImage thumbnail;
+        if (m_thumbnailAtlas) {
+            thumbnail = m_thumbnailAtlas->thumbnailAt(id.mid(6).section('?', 0, 0).toLongLong());
+        }
         if (size) {
-            *size = m_playbackImage.size();
+            *size = thumbnail.size();
         }
-        qDebug() << "ImageProvider::requestImage - serving playback image, size:" << m_playbackImage.size();
-    } else {
-        imageToReturn = m_currentImage;
+        return thumbnail;
+    }
+
+    QElapsedTimer waitTimer;
+    waitTimer.start();
+
+    QString slotId;
+    bool primary;
+    lockSlotsForRead();
+    slotId = resolveSlotId(id);
+    primary = slotId == m_primarySlot;
+    m_slotsLock.unlock();
+
+    if (primary && m_playbackMode) {
+        std::shared_ptr<const QImage> playbackImage = std::atomic_load(&m_playbackImage);
+        if (playbackImage) {
+            m_readWait.add(waitTimer.nsecsElapsed());
+            if (size) {
+                *size = playbackImage->size();
+            }
+            return *playbackImage;
+        }
+    }
+
+    FrameSlot *frameSlot = slot(slotId);
+    std::shared_ptr<const PublishedFrame> frame = std::atomic_load(&frameSlot->frame);
+    m_readWait.add(waitTimer.nsecsElapsed());
+
+    if (!frame) {
         if (size) {
-            *size = m_currentImage.size();
+            *size = QSize();
         }
-        qDebug() << "ImageProvider::requestImage - serving live image, size:" << m_currentImage.size() << "null:" << m_currentImage.isNull();
+        return QImage();
+    }
+
+    // Count each published frame once, however many times it is requested.
+    quint64 previous = frameSlot->deliveredSequence.load();
+    while (previous < frame->sequence && !frameSlot->deliveredSequence.compare_exchange_weak(previous, frame->sequence)) {
+    }
+    if (previous < frame->sequence) {
+        frameSlot->delivered++;
     }
-    
-    return imageToReturn;
+
+    if (size) {
+        *size = frame->image.size();
+    }
+    return frame->image;
 }
 
 void ImageProvider::updateImage(const QImage &image)
 {
-    QMutexLocker locker(&m_mutex);
-    if (!image.isNull() && !image.size().isEmpty()) {
-        m_currentImage = image.copy();
-        qDebug() << "ImageProvider::updateImage - Updated with image size:" << image.size();
-    } else {
-        qDebug() << "ImageProvider::updateImage - Received invalid image, null:" << image.isNull() << "size:" << image.size();
+    QString slotId;
+    {
+        QReadLocker locker(&m_slotsLock);
+        slotId = m_primarySlot;
     }
+    updateImage(slotId, image);
 }
 
-void ImageProvider::updatePlaybackImage(const QString &frameFilename)
+void ImageProvider::updateImage(const QString &slotId, const QImage &image)
 {
-    QMutexLocker locker(&m_mutex);
-    
-    if (frameFilename == m_lastFrameFile && !m_playbackImage.isNull()) {
+    if (image.isNull() || image.size().isEmpty()) {
+        qDebug() << "ImageProvider::updateImage - Received invalid image, null:" << image.isNull() << "size:" << image.size();
         return;
     }
-    
+
+    FrameSlot *frameSlot = slot(slotId);
+    auto frame = std::make_shared<PublishedFrame>();
+    frame->image = image;
+    frame->sequence = frameSlot->published.load() + 1;
+
+    QElapsedTimer waitTimer;
+    waitTimer.start();
+    std::atomic_store(&frameSlot->frame, std::shared_ptr<const PublishedFrame>(std::move(frame)));
+    frameSlot->published++;
+    m_publishWait.add(waitTimer.nsecsElapsed());
+}
+
+bool ImageProvider::wantsFrame(const QString &slotId)
+{
+    if (!m_displayActive || m_playbackMode) {
+        return false;
+    }
+
+    FrameSlot *frameSlot = slot(slotId);
+    return frameSlot->deliveredSequence.load() >= frameSlot->published.load();
+}
+
+quint64 ImageProvider::framesDelivered(const QString &slotId)
+{
+    return slot(slotId)->delivered.load();
+}
+
+quint64 ImageProvider::framesDropped(const QString &slotId)
+{
+    // Every published frame is either delivered, replaced before it was
+    // requested, or still waiting to be requested.
+    FrameSlot *frameSlot = slot(slotId);
+    quint64 published = frameSlot->published.load();
+    quint64 delivered = frameSlot->delivered.load();
+    quint64 pending = frameSlot->deliveredSequence.load() < published ? 1 : 0;
+    return published > delivered + pending ? published - delivered - pending : 0;
+}
+
+QVariantMap ImageProvider::metrics()
+{
+    QVariantMap result;
+    QVariantMap slotMetricsById;
+    QStringList slotIds;
+    {
+        QReadLocker locker(&m_slotsLock);
+        slotIds = m_slots.keys();
+    }
+    for (const QString &slotId : slotIds) {
+        QVariantMap slotMetrics;
+        slotMetrics["published"] = slot(slotId)->published.load();
+        slotMetrics["delivered"] = framesDelivered(slotId);
+        slotMetrics["dropped"] = framesDropped(slotId);
+        slotMetricsById[slotId] = slotMetrics;
+    }
+    result["slots"] = slotMetricsById;
+    result["slotTableContended"] = m_slotsContended.load();
+    result["readWait"] = m_readWait.toMap();
+    result["publishWait"] = m_publishWait.toMap();
+    result["playbackLoad"] = m_playbackLoad.toMap();
+    return result;
+}
+
+void ImageProvider::setDisplayActive(bool active)
+{
+    if (m_displayActive.exchange(active) != active) {
+        qDebug() << "ImageProvider::setDisplayActive -" << (active ? "display visible" : "display hidden");
+    }
+}
+
+void ImageProvider::updatePlaybackImage(const QString &frameFilename)
+{
     if (frameFilename.isEmpty()) {
         qDebug() << "ImageProvider::updatePlaybackImage - Empty frame filename";
         return;
     }
-    
+
+    QElapsedTimer loadTimer;
+    loadTimer.start();
+
     QString fullPath;
-    if (QFileInfo(frameFilename).isAbsolute()) {
+    if (m_sessionCatalog) {
+        fullPath = m_sessionCatalog->resolveFrame(frameFilename);
+    } else if (QFileInfo(frameFilename).isAbsolute()) {
         fullPath = frameFilename;
     } else {
         QString dataDir = QApplication::applicationDirPath() + "/data";
         fullPath = dataDir + "/" + frameFilename;
-        
+
         if (!QFileInfo(fullPath).exists()) {
             QFileInfo info(frameFilename);
             fullPath = dataDir + "/" + info.fileName();
         }
     }
-    
-    QImage loadedImage(fullPath);
-    if (!loadedImage.isNull()) {
-        m_playbackImage = loadedImage.copy();
-        m_lastFrameFile = frameFilename;
-        qDebug() << "ImageProvider::updatePlaybackImage - Loaded frame:" << fullPath << "size:" << loadedImage.size();
-    } else {
+
+    // Read and decode with nothing locked; the render thread keeps serving
+    // the previous frame until the new one is swapped in.
+    auto loadedImage = std::make_shared<QImage>(fullPath);
+    if (loadedImage->isNull()) {
         qDebug() << "ImageProvider::updatePlaybackImage - Failed to load frame:" << fullPath;
-        m_playbackImage = QImage(640, 480, QImage::Format_RGB888);
-        m_playbackImage.fill(QColor(50, 50, 50));
+        *loadedImage = QImage(640, 480, QImage::Format_RGB888);
+        loadedImage->fill(QColor(50, 50, 50));
     }
+    m_playbackLoad.add(loadTimer.nsecsElapsed());
+
+    std::atomic_store(&m_playbackImage, std::shared_ptr<const QImage>(std::move(loadedImage)));
 }
 
 void ImageProvider::setPlaybackMode(bool enabled)
 {
-    QMutexLocker locker(&m_mutex);
-    if (m_playbackMode != enabled) {
-        m_playbackMode = enabled;
+    if (m_playbackMode.exchange(enabled) != enabled) {
         if (!enabled) {
-            m_playbackImage = QImage();
-            m_lastFrameFile.clear();
+            std::atomic_store(&m_playbackImage, std::shared_ptr<const QImage>());
         }
         qDebug() << "ImageProvider::setPlaybackMode -" << (enabled ? "enabled" : "disabled") << "playback mode";
     }
@@ -12,3 +12,8 @@ void ImageProviderWrapper::setPlaybackMode(bool enabled)
         m_provider->setPlaybackMode(enabled);
     }
 }
+
+QVariantMap ImageProviderWrapper::metrics() const
+{
+    return m_provider ? m_provider->metrics() : QVariantMap();
+}
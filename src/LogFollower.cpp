@@ -0,0 +1,218 @@
+#include "LogFollower.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+constexpr qint64 ReadChunkBytes = 4 * 1024 * 1024;
+constexpr int PollIntervalMs = 1000;
+
+}
+
+LogFollower::LogFollower(QObject *parent)
+    : QObject(parent)
+    , m_offset(0)
+    , m_watcher(new QFileSystemWatcher(this))
+    , m_pollTimer(new QTimer(this))
+    , m_bytesRead(0)
+    , m_rotations(0)
+{
+    // The watcher wakes us as soon as the writer appends; the poll covers
+    // file systems that do not deliver change notifications.
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, &LogFollower::readAvailable);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, &LogFollower::readAvailable);
+    connect(m_pollTimer, &QTimer::timeout, this, &LogFollower::readAvailable);
+    m_pollTimer->setInterval(PollIntervalMs);
+}
+
+LogFollower::~LogFollower()
+{
+    close();
+}
+
+bool LogFollower::open(const QString &filename, QString *errorMessage)
+{
+    close();
+
+    if (!reopen(QFileInfo(filename).absoluteFilePath())) {
+        if (errorMessage) {
+            *errorMessage = "Cannot follow " + filename + ": " + m_file.errorString();
+        }
+        return false;
+    }
+
+    m_bytesRead = 0;
+    m_rotations = 0;
+    m_pollTimer->start();
+    return true;
+}
+
+void LogFollower::close()
+{
+    m_pollTimer->stop();
+    if (!m_watcher->files().isEmpty()) {
+        m_watcher->removePaths(m_watcher->files());
+    }
+    if (!m_watcher->directories().isEmpty()) {
+        m_watcher->removePaths(m_watcher->directories());
+    }
+    m_file.close();
+    m_partial.clear();
+    m_offset = 0;
+}
+
+LogFollower::Identity LogFollower::identify(const QString &filename)
+{
+    Identity identity;
+#ifdef Q_OS_UNIX
+    struct stat info;
+    if (::stat(QFile::encodeName(filename).constData(), &info) == 0) {
+        identity.device = quint64(info.st_dev);
+        identity.inode = quint64(info.st_ino);
+        identity.size = qint64(info.st_size);
+    }
+#else
+    QFileInfo info(filename);
+    if (info.exists()) {
+        identity.inode = quint64(info.birthTime().toMSecsSinceEpoch());
+        identity.size = info.size();
+    }
+#endif
+    return identity;
+}
+
+bool LogFollower::reopen(const QString &filename)
+{
+    m_file.close();
+    m_file.setFileName(filename);
+    if (!m_file.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        return false;
+    }
+
+    m_fileName = filename;
+    m_identity = identify(filename);
+    m_offset = 0;
+    m_partial.clear();
+    watch();
+    return true;
+}
+
+void LogFollower::watch()
+{
+    if (!m_watcher->files().isEmpty()) {
+        m_watcher->removePaths(m_watcher->files());
+    }
+    m_watcher->addPath(m_fileName);
+
+    QString directory = QFileInfo(m_fileName).absolutePath();
+    if (!m_watcher->directories().contains(directory)) {
+        m_watcher->addPath(directory);
+    }
+}
+
+void LogFollower::readAvailable()
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+
+    Identity current = identify(m_fileName);
+    if (current.size >= 0 && (!(current == m_identity) || current.size < m_offset)) {
+        // Replaced or truncated under the same name: finish what the old
+        // handle still holds, then start the new contents from the top.
+        if (current == m_identity) {
+            qDebug() << "LogFollower: file truncated, restarting" << m_fileName;
+        } else {
+            drain();
+        }
+        if (!reopen(m_fileName)) {
+            qDebug() << "LogFollower: cannot reopen" << m_fileName << m_file.errorString();
+            return;
+        }
+        m_rotations++;
+        emit rotated(m_fileName);
+    } else if (current.size >= 0 && !m_watcher->files().contains(m_fileName)) {
+        watch();
+    }
+
+    qint64 before = m_offset;
+    drain();
+    if (m_offset != before || m_rotationPattern.isEmpty()) {
+        return;
+    }
+
+    // The current file has gone quiet; if the writer has started a newer
+    // one, the old file is finished and any unterminated row is complete.
+    QString next = newerFile();
+    if (next.isEmpty()) {
+        return;
+    }
+    if (!m_partial.trimmed().isEmpty()) {
+        emit linesAppended({m_partial.trimmed()});
+    }
+    if (!reopen(next)) {
+        qDebug() << "LogFollower: cannot open rotated file" << next << m_file.errorString();
+        return;
+    }
+    m_rotations++;
+    qDebug() << "LogFollower: following" << next;
+    emit rotated(next);
+    drain();
+}
+
+void LogFollower::drain()
+{
+    qint64 size = m_file.size();
+    while (m_offset < size) {
+        if (!m_file.seek(m_offset)) {
+            return;
+        }
+        QByteArray data = m_file.read(std::min(size - m_offset, ReadChunkBytes));
+        if (data.isEmpty()) {
+            return;
+        }
+        m_offset += data.size();
+        m_bytesRead += data.size();
+
+        m_partial.append(data);
+        int last = m_partial.lastIndexOf('\n');
+        if (last < 0) {
+            continue;
+        }
+
+        QList<QByteArray> lines;
+        int start = 0;
+        while (start <= last) {
+            int end = m_partial.indexOf('\n', start);
+            int length = end - start;
+            if (length > 0 && m_partial.at(end - 1) == '\r') {
+                length--;
+            }
+            if (length > 0) {
+                lines.append(m_partial.mid(start, length));
+            }
+            start = end + 1;
+        }
+        m_partial.remove(0, last + 1);
+
+        if (!lines.isEmpty()) {
+            emit linesAppended(lines);
+        }
+    }
+}
+
+QString LogFollower::newerFile() const
+{
+    QFileInfo current(m_fileName);
+    QStringList candidates = current.absoluteDir().entryList({m_rotationPattern}, QDir::Files, QDir::Name);
+    if (candidates.isEmpty() || candidates.last() <= current.fileName()) {
+        return QString();
+    }
+    return current.absolutePath() + "/" + candidates.last();
+}
@@ -1,10 +1,10 @@
 #include "PlaybackController.h"
 #include <QDebug>
 #include <algorithm>
-#include <numeric>
 
 PlaybackController::PlaybackController(QObject *parent)
     : QObject(parent)
+    , m_currentFrame(-1)
     , m_playbackTimer(new QTimer(this))
     , m_isPlaying(false)
     , m_isPaused(false)
@@ -12,35 +12,73 @@ PlaybackController::PlaybackController(QObject *parent)
     , m_totalReadings(0)
     , m_playbackSpeed(1.0)
     , m_loopEnabled(false)
+    , m_aggregateSamples(true)
+    , m_anchorMediaMs(0)
+    , m_ticks(0)
+    , m_samplesPlayed(0)
+    , m_pointsEmitted(0)
+    , m_framesEmitted(0)
+    , m_following(false)
 {
     connect(m_playbackTimer, &QTimer::timeout, this, &PlaybackController::nextDataPoint);
-    m_playbackTimer->setInterval(1000); 
+    m_playbackTimer->setTimerType(Qt::PreciseTimer);
+    m_playbackTimer->setInterval(TickIntervalMs);
 }
 
 void PlaybackController::setPlaybackSpeed(double speed)
 {
-    if (speed <= 0) {
-        speed = 0.1; 
-    }
-    if (speed > 10.0) {
-        speed = 10.0; 
-    }
+    speed = std::clamp(speed, MinSpeed, MaxSpeed);
     
     if (m_playbackSpeed != speed) {
+        qint64 position = playheadMs();
         m_playbackSpeed = speed;
-        int intervalMs = static_cast<int>(1000.0 / speed);
-        m_playbackTimer->setInterval(intervalMs);
+        anchorPlayhead(position);
         emit playbackSpeedChanged();
     }
 }
 
-void PlaybackController::loadData(const QList<SensorReading> &readings)
+void PlaybackController::setAggregateSamples(bool enabled)
+{
+    if (m_aggregateSamples != enabled) {
+        m_aggregateSamples = enabled;
+        emit aggregateSamplesChanged();
+    }
+}
+
+void PlaybackController::anchorPlayhead(qint64 mediaMs)
+{
+    m_anchorMediaMs = mediaMs;
+    m_wallClock.start();
+}
+
+qint64 PlaybackController::playheadMs() const
+{
+    if (!m_isPlaying || m_isPaused || !m_wallClock.isValid()) {
+        return m_anchorMediaMs;
+    }
+    return m_anchorMediaMs + static_cast<qint64>(m_wallClock.elapsed() * m_playbackSpeed);
+}
+
+void PlaybackController::resetMetrics()
+{
+    m_ticks = 0;
+    m_samplesPlayed = 0;
+    m_pointsEmitted = 0;
+    m_framesEmitted = 0;
+}
+
+void PlaybackController::loadData(const SensorDataset::Snapshot &readings)
 {
     stop(); 
     
     m_readings = readings;
     m_totalReadings = readings.size();
     m_currentIndex = 0;
+    m_currentFrame = -1;
+    m_anchorMediaMs = readings.isEmpty() ? 0 : readings.first().timestampMs;
+    m_temperatureMedian.clear();
+    m_pressureMedian.clear();
+    resetMetrics();
     
     emit totalReadingsChanged();
     emit currentIndexChanged();
@@ -51,6 +89,71 @@ void PlaybackController::loadData(const QList<SensorReading> &readings)
     qDebug() << "Loaded" << m_totalReadings << "readings for playback";
 }
 
+void PlaybackController::setFrameIndex(const FrameIndex &frameIndex)
+{
+    m_frameIndex = frameIndex;
+    m_currentFrame = -1;
+}
+
+void PlaybackController::setRollups(const RollupStore &rollups)
+{
+    m_rollups = rollups;
+}
+
+void PlaybackController::setFollowing(bool following)
+{
+    if (m_following != following) {
+        m_following = following;
+        emit followingChanged();
+    }
+}
+
+void PlaybackController::appendReadings(const SensorDataset::Snapshot &readings)
+{
+    // A newer snapshot of the same dataset shares every row already held;
+    // only the rows past m_totalReadings are new.
+    if (readings.generation() != m_readings.generation()) {
+        loadData(readings);
+        return;
+    }
+    int first = m_totalReadings;
+    if (readings.size() <= first) {
+        return;
+    }
+
+    if (m_temperatureMedian.count() != first) {
+        m_temperatureMedian.clear();
+        m_pressureMedian.clear();
+        for (int i = 0; i < first; ++i) {
+            m_temperatureMedian.add(m_readings[i].temperature);
+            m_pressureMedian.add(m_readings[i].pressure);
+        }
+    }
+
+    m_readings = readings;
+    for (int i = first; i < readings.size(); ++i) {
+        const SensorReading &reading = readings[i];
+        m_rollups.add(reading.timestampMs, reading.temperature, reading.pressure);
+        m_temperatureMedian.add(reading.temperature);
+        m_pressureMedian.add(reading.pressure);
+    }
+    m_totalReadings = m_readings.size();
+    if (first == 0 && !m_isPlaying) {
+        m_anchorMediaMs = m_readings.first().timestampMs;
+    }
+    emit totalReadingsChanged();
+
+    publishStatistics(m_rollups.summarize(m_readings.first().timestampMs, m_readings.last().timestampMs + 1),
+                      m_temperatureMedian.value(), m_pressureMedian.value());
+}
+
+void PlaybackController::appendFrames(const FrameIndex &frameIndex)
+{
+    for (int i = m_frameIndex.size(); i < frameIndex.size(); ++i) {
+        m_frameIndex.append(frameIndex.at(i).timestampMs, frameIndex.at(i).filename);
+    }
+}
+
 void PlaybackController::play()
 {
     if (m_readings.isEmpty()) {
@@ -65,6 +168,7 @@ void PlaybackController::play()
     
     m_isPlaying = true;
     m_isPaused = false;
+    anchorPlayhead(m_readings[m_currentIndex].timestampMs);
     m_playbackTimer->start();
     
     emit playingChanged();
@@ -80,11 +184,15 @@ void PlaybackController::pause()
         return;
     }
     
+    if (!m_isPaused) {
+        m_anchorMediaMs = playheadMs();
+    }
     m_isPaused = !m_isPaused;
     
     if (m_isPaused) {
         m_playbackTimer->stop();
     } else {
+        anchorPlayhead(m_anchorMediaMs);
         m_playbackTimer->start();
     }
     
@@ -97,6 +205,8 @@ void PlaybackController::stop()
     m_isPlaying = false;
     m_isPaused = false;
     m_currentIndex = 0;
+    m_currentFrame = -1;
+    m_anchorMediaMs = m_readings.isEmpty() ? 0 : m_readings.first().timestampMs;
     
     emit playingChanged();
     emit pausedChanged();
@@ -127,15 +237,24 @@ void PlaybackController::seekToIndex(int index)
     m_currentIndex = index;
     emit currentIndexChanged();
     
+    if (index >= 0) {
+        anchorPlayhead(m_readings[index].timestampMs);
+    }
     updateCurrentData();
 }
 
 void PlaybackController::nextDataPoint()
 {
     if (m_currentIndex >= m_totalReadings) {
+        if (m_following) {
+            // Caught up with the writer; keep the clock running for the
+            // next rows.
+            return;
+        }
         if (m_loopEnabled) {
             m_currentIndex = 0;
             emit currentIndexChanged();
+            anchorPlayhead(m_readings.first().timestampMs);
             updateCurrentData();
             return;
         } else {
@@ -145,8 +264,17 @@ void PlaybackController::nextDataPoint()
         }
     }
     
-    updateCurrentData();
-    m_currentIndex++;
+    // Each tick plays every reading whose recorded time the playhead has
+    // passed, folded into a single data point, so the UI sees at most one
+    // update per tick regardless of speed.
+    m_ticks++;
+    int end = upperBoundIndex(playheadMs());
+    if (end <= m_currentIndex) {
+        return;
+    }
+    
+    emitRange(m_currentIndex, end);
+    m_currentIndex = end;
     emit currentIndexChanged();
 }
 
@@ -156,34 +284,50 @@ void PlaybackController::updateCurrentData()
         return;
     }
     
-    const SensorReading &reading = m_readings[m_currentIndex];
-    emit dataPoint(reading.temperature, reading.pressure, 
-                   reading.timestamp.toString(Qt::ISODate), reading.frameFilename);
-    emit currentTimestampChanged();
+    emitRange(m_currentIndex, m_currentIndex + 1);
 }
 
-int PlaybackController::findIndexByTimeOffset(int currentIndex, int secondsOffset)
+void PlaybackController::emitRange(int first, int end)
 {
-    if (m_readings.isEmpty() || currentIndex < 0 || currentIndex >= m_totalReadings) {
-        return currentIndex;
+    int count = end - first;
+    const SensorReading &reading = m_readings[end - 1];
+    double temperature = reading.temperature;
+    double pressure = reading.pressure;
+    if (count > 1 && m_aggregateSamples) {
+        double temperatureSum = 0.0;
+        double pressureSum = 0.0;
+        for (int i = first; i < end; ++i) {
+            temperatureSum += m_readings[i].temperature;
+            pressureSum += m_readings[i].pressure;
+        }
+        temperature = temperatureSum / count;
+        pressure = pressureSum / count;
     }
     
-    QDateTime currentTime = m_readings[currentIndex].timestamp;
-    QDateTime targetTime = currentTime.addSecs(secondsOffset);
-    
+    int frame = m_frameIndex.nearestFrame(reading.timestampMs);
+    QString frameFilename = frame >= 0 ? m_frameIndex.at(frame).filename : reading.frameFilename;
     
-    int bestIndex = currentIndex;
-    qint64 bestDiff = qAbs(currentTime.secsTo(targetTime));
+    m_samplesPlayed += count;
+    m_pointsEmitted++;
+    emit dataPoint(temperature, pressure, 
+                   reading.timestamp.toString(Qt::ISODateWithMs), frameFilename);
+    emit currentTimestampChanged();
     
-    for (int i = 0; i < m_totalReadings; ++i) {
-        qint64 diff = qAbs(m_readings[i].timestamp.secsTo(targetTime));
-        if (diff < bestDiff) {
-            bestDiff = diff;
-            bestIndex = i;
-        }
+    if (frame >= 0 && frame != m_currentFrame) {
+        m_currentFrame = frame;
+        m_framesEmitted++;
+        emit frameChanged(frame, frameFilename);
+    }
+}
+
+int PlaybackController::findIndexByTimeOffset(int currentIndex, int secondsOffset)
+{
+    if (m_readings.isEmpty() || currentIndex < 0 || currentIndex >= m_totalReadings) {
+        return currentIndex;
     }
     
-    return bestIndex;
+    qint64 targetMs = m_readings[currentIndex].timestampMs + qint64(secondsOffset) * 1000;
+    return findIndexByTimestampMs(targetMs);
 }
 
 void PlaybackController::setLoopEnabled(bool enabled)
@@ -209,36 +353,98 @@ void PlaybackController::seekToTimestamp(const QDateTime &timestamp)
 }
 
 int PlaybackController::findIndexByTimestamp(const QDateTime &timestamp)
+{
+    return findIndexByTimestampMs(timestamp.toMSecsSinceEpoch());
+}
+
+int PlaybackController::findIndexByTimestampMs(qint64 timestampMs) const
 {
     if (m_readings.isEmpty()) {
         return 0;
     }
     
-    int bestIndex = 0;
-    qint64 bestDiff = qAbs(m_readings[0].timestamp.msecsTo(timestamp));
-    
-    for (int i = 1; i < m_totalReadings; ++i) {
-        qint64 diff = qAbs(m_readings[i].timestamp.msecsTo(timestamp));
-        if (diff < bestDiff) {
-            bestDiff = diff;
-            bestIndex = i;
-        }
+    int index = lowerBoundIndex(timestampMs);
+    if (index >= m_totalReadings) {
+        return m_totalReadings - 1;
+    }
+    if (index > 0 && timestampMs - m_readings[index - 1].timestampMs <= m_readings[index].timestampMs - timestampMs) {
+        return index - 1;
+    }
+    return index;
+}
+
+int PlaybackController::lowerBoundIndex(qint64 timestampMs) const
+{
+    return m_readings.lowerBound(timestampMs);
+}
+
+int PlaybackController::upperBoundIndex(qint64 timestampMs) const
+{
+    return m_readings.upperBound(timestampMs);
+}
+
+int PlaybackController::frameIndexAt(int readingIndex) const
+{
+    if (readingIndex < 0 || readingIndex >= m_totalReadings) {
+        return -1;
+    }
+    return m_frameIndex.nearestFrame(m_readings[readingIndex].timestampMs);
+}
+
+qint64 PlaybackController::timestampAt(int readingIndex) const
+{
+    if (readingIndex < 0 || readingIndex >= m_totalReadings) {
+        return -1;
+    }
+    return m_readings[readingIndex].timestampMs;
+}
+
+QVariantMap PlaybackController::sampleRangeForFrame(int frameIndex) const
+{
+    QVariantMap range;
+    if (frameIndex < 0 || frameIndex >= m_frameIndex.size()) {
+        return range;
     }
     
-    return bestIndex;
+    QPair<qint64, qint64> window = m_frameIndex.frameWindow(frameIndex);
+    int first = lowerBoundIndex(window.first);
+    int end = lowerBoundIndex(window.second);
+    
+    range["frameFile"] = m_frameIndex.at(frameIndex).filename;
+    range["frameTimestamp"] = QDateTime::fromMSecsSinceEpoch(m_frameIndex.at(frameIndex).timestampMs);
+    range["firstIndex"] = first;
+    range["lastIndex"] = end - 1;
+    range["count"] = end - first;
+    return range;
+}
+
+QVariantMap PlaybackController::playbackMetrics() const
+{
+    QVariantMap metrics;
+    metrics["speed"] = m_playbackSpeed;
+    metrics["ticks"] = m_ticks;
+    metrics["samplesPlayed"] = m_samplesPlayed;
+    metrics["pointsEmitted"] = m_pointsEmitted;
+    metrics["framesEmitted"] = m_framesEmitted;
+    metrics["samplesPerPoint"] = m_pointsEmitted > 0 ? double(m_samplesPlayed) / m_pointsEmitted : 0.0;
+    metrics["playheadTimestamp"] = QDateTime::fromMSecsSinceEpoch(playheadMs());
+    return metrics;
 }
 
 QList<SensorReading> PlaybackController::getReadingsInRange(const QDateTime &start, const QDateTime &end)
 {
-    QList<SensorReading> result;
-    
-    for (const SensorReading &reading : m_readings) {
-        if (reading.timestamp >= start && reading.timestamp <= end) {
-            result.append(reading);
-        }
+    return m_readings.mid(lowerBoundIndex(start.toMSecsSinceEpoch()), upperBoundIndex(end.toMSecsSinceEpoch()));
+}
+
+static double median(QVector<double> &values)
+{
+    size_t middle = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + middle, values.end());
+    double upper = values[middle];
+    if (values.size() % 2 != 0) {
+        return upper;
     }
-    
-    return result;
+    return (*std::max_element(values.begin(), values.begin() + middle) + upper) / 2.0;
 }
 
 void PlaybackController::calculateStatistics()
@@ -249,43 +455,47 @@ void PlaybackController::calculateStatistics()
         return;
     }
     
+    qint64 startMs = m_readings.first().timestampMs;
+    qint64 endMs = m_readings.last().timestampMs + 1;
     
-    QList<double> temperatures, pressures;
+    // Min, max and mean come from the rollups; only the medians still need
+    // the raw values.
+    RollupBucket summary;
+    if (!m_rollups.isEmpty()) {
+        summary = m_rollups.summarize(startMs, endMs);
+    } else {
+        for (const SensorReading &reading : m_readings) {
+            summary.temperature.add(reading.temperature);
+            summary.pressure.add(reading.pressure);
+        }
+    }
+    
+    QVector<double> temperatures, pressures;
+    temperatures.reserve(m_readings.size());
+    pressures.reserve(m_readings.size());
     for (const SensorReading &reading : m_readings) {
         temperatures.append(reading.temperature);
         pressures.append(reading.pressure);
     }
     
-    
-    std::sort(temperatures.begin(), temperatures.end());
-    double tempMin = temperatures.first();
-    double tempMax = temperatures.last();
-    double tempSum = std::accumulate(temperatures.begin(), temperatures.end(), 0.0);
-    double tempMean = tempSum / temperatures.size();
-    double tempMedian = (temperatures.size() % 2 == 0) ? 
-        (temperatures[temperatures.size()/2 - 1] + temperatures[temperatures.size()/2]) / 2.0 :
-        temperatures[temperatures.size()/2];
-    
-    std::sort(pressures.begin(), pressures.end());
-    double pressureMin = pressures.first();
-    double pressureMax = pressures.last();
-    double pressureSum = std::accumulate(pressures.begin(), pressures.end(), 0.0);
-    double pressureMean = pressureSum / pressures.size();
-    double pressureMedian = (pressures.size() % 2 == 0) ? 
-        (pressures[pressures.size()/2 - 1] + pressures[pressures.size()/2]) / 2.0 :
-        pressures[pressures.size()/2];
-    
+    publishStatistics(summary, median(temperatures), median(pressures));
+}
+
+void PlaybackController::publishStatistics(const RollupBucket &summary, double temperatureMedian, double pressureMedian)
+{
     QDateTime startTime = m_readings.first().timestamp;
     QDateTime endTime = m_readings.last().timestamp;
     qint64 duration = startTime.msecsTo(endTime) / 1000; 
     
-    m_statistics["temperatureMin"] = tempMin;
-    m_statistics["temperatureMax"] = tempMax;
-    m_statistics["temperatureMean"] = tempMean;
-    m_statistics["temperatureMedian"] = tempMedian;
-    m_statistics["pressureMin"] = pressureMin;
-    m_statistics["pressureMax"] = pressureMax;
-    m_statistics["pressureMean"] = pressureMean;
+    m_statistics["temperatureMin"] = summary.temperature.min;
+    m_statistics["temperatureMax"] = summary.temperature.max;
+    m_statistics["temperatureMean"] = summary.temperature.mean();
+    m_statistics["temperatureStdDev"] = summary.temperature.stdDev();
+    m_statistics["temperatureMedian"] = temperatureMedian;
+    m_statistics["pressureMin"] = summary.pressure.min;
+    m_statistics["pressureMax"] = summary.pressure.max;
+    m_statistics["pressureMean"] = summary.pressure.mean();
+    m_statistics["pressureStdDev"] = summary.pressure.stdDev();
     m_statistics["pressureMedian"] = pressureMedian;
     m_statistics["startTime"] = startTime;
     m_statistics["endTime"] = endTime;
@@ -295,6 +505,54 @@ void PlaybackController::calculateStatistics()
     emit statisticsChanged();
 }
 
+void PlaybackController::RunningMedian::add(double value)
+{
+    if (lower.empty() || value <= lower.top()) {
+        lower.push(value);
+    } else {
+        upper.push(value);
+    }
+
+    if (lower.size() > upper.size() + 1) {
+        upper.push(lower.top());
+        lower.pop();
+    } else if (upper.size() > lower.size()) {
+        lower.push(upper.top());
+        upper.pop();
+    }
+}
+
+double PlaybackController::RunningMedian::value() const
+{
+    if (lower.empty()) {
+        return 0.0;
+    }
+    if (lower.size() > upper.size()) {
+        return lower.top();
+    }
+    return (lower.top() + upper.top()) / 2.0;
+}
+
+QVariantMap PlaybackController::getRangeStatistics(const QDateTime &start, const QDateTime &end) const
+{
+    return RollupStore::toVariantMap(m_rollups.summarize(start.toMSecsSinceEpoch(), end.toMSecsSinceEpoch()));
+}
+
+QVariantList PlaybackController::rollupSeries(const QDateTime &start, const QDateTime &end, int maxPoints) const
+{
+    int tier = RollupStore::Second;
+    QVector<RollupBucket> buckets = m_rollups.series(start.toMSecsSinceEpoch(), end.toMSecsSinceEpoch(),
+                                                     std::max(1, maxPoints), &tier);
+    QVariantList result;
+    result.reserve(buckets.size());
+    for (const RollupBucket &bucket : buckets) {
+        QVariantMap point = RollupStore::toVariantMap(bucket);
+        point["intervalMs"] = RollupStore::tierInterval(tier);
+        result.append(point);
+    }
+    return result;
+}
+
 QVariantMap PlaybackController::getStatistics() const
 {
     return m_statistics;
@@ -0,0 +1,329 @@
+#include "PreTriggerRecorder.h"
+#include "AsyncWriter.h"
+#include "FrameWriter.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <algorithm>
+#include <vector>
+
+// Encoder threads per camera, and frames queued per thread; past that the
+// capture rate outruns the encoders and frames are skipped, not queued.
+static const int MaxEncoderThreads = 4;
+static const int EncodingPerThread = 2;
+static const int SkipWarningIntervalMs = 10000;
+// How long past the post-trigger window an event waits for late frames.
+static const int FinishGraceMs = 1000;
+static const int WriteRetryMs = 50;
+
+PreTriggerRecorder::PreTriggerRecorder(QObject *parent)
+    : QObject(parent)
+    , m_encoding(0)
+    , m_skippedAtWarning(0)
+    , m_ringBytes(0)
+    , m_active(false)
+    , m_writesInFlight(0)
+    , m_finishTimer(new QTimer(this))
+    , m_ringFrames(0)
+    , m_ringSizeBytes(0)
+    , m_ringSpanMs(0)
+    , m_writesPending(0)
+    , m_eventActive(false)
+    , m_framesEncoded(0)
+    , m_framesSkipped(0)
+    , m_framesEvicted(0)
+    , m_framesWritten(0)
+    , m_writeFailures(0)
+    , m_events(0)
+{
+    m_pool.setMaxThreadCount(std::clamp(QThread::idealThreadCount() / 2, 1, MaxEncoderThreads));
+    m_finishTimer->setSingleShot(true);
+    connect(m_finishTimer, &QTimer::timeout, this, &PreTriggerRecorder::finishEvent);
+}
+
+PreTriggerRecorder::~PreTriggerRecorder()
+{
+    m_pool.waitForDone();
+}
+
+void PreTriggerRecorder::addCommandLineOptions(QCommandLineParser &parser)
+{
+    parser.addOption(QCommandLineOption("pre-trigger", "Keep the last <seconds> of frames in memory for event capture.", "seconds"));
+    parser.addOption(QCommandLineOption("post-trigger", "Keep saving frames for <seconds> after a trigger.", "seconds"));
+    parser.addOption(QCommandLineOption("pre-trigger-budget", "Memory for the pre-trigger ring of each camera, in <MB>.", "MB"));
+    parser.addOption(QCommandLineOption("no-alert-trigger", "Do not capture an event when an alert rule fires."));
+}
+
+bool PreTriggerRecorder::applyCommandLineOptions(const QCommandLineParser &parser, PreTriggerConfig &config, QString *errorMessage)
+{
+    bool ok = true;
+    if (parser.isSet("pre-trigger")) {
+        double seconds = parser.value("pre-trigger").toDouble(&ok);
+        if (!ok || seconds < 0) {
+            *errorMessage = "Invalid pre-trigger duration: " + parser.value("pre-trigger");
+            return false;
+        }
+        config.preTriggerMs = int(seconds * 1000);
+    }
+    if (parser.isSet("post-trigger")) {
+        double seconds = parser.value("post-trigger").toDouble(&ok);
+        if (!ok || seconds < 0) {
+            *errorMessage = "Invalid post-trigger duration: " + parser.value("post-trigger");
+            return false;
+        }
+        config.postTriggerMs = int(seconds * 1000);
+    }
+    if (parser.isSet("pre-trigger-budget")) {
+        double megabytes = parser.value("pre-trigger-budget").toDouble(&ok);
+        if (!ok || megabytes <= 0) {
+            *errorMessage = "Invalid pre-trigger budget: " + parser.value("pre-trigger-budget");
+            return false;
+        }
+        config.maxRingBytes = qint64(megabytes * 1024 * 1024);
+    }
+    if (parser.isSet("no-alert-trigger")) {
+        config.triggerOnAlert = false;
+    }
+    return true;
+}
+
+void PreTriggerRecorder::configure(const PreTriggerConfig &config, const QString &cameraId, const QString &dataDirectory)
+{
+    finish();
+    m_config = config;
+    m_cameraId = cameraId.isEmpty() ? QString("camera") : cameraId;
+    m_eventsDirectory = dataDirectory + "/events";
+}
+
+void PreTriggerRecorder::addFrame(const cv::Mat &frame, FramePixelFormat format, qint64 timestampMs)
+{
+    if (!m_config.isEnabled() || frame.empty()) {
+        return;
+    }
+    if (m_encoding.load() >= m_pool.maxThreadCount() * EncodingPerThread) {
+        m_framesSkipped++;
+        if (!m_skipWarningTimer.isValid() || m_skipWarningTimer.elapsed() >= SkipWarningIntervalMs) {
+            qWarning() << "Pre-trigger encoder on camera" << m_cameraId << "is behind the capture rate;"
+                       << m_framesSkipped.load() - m_skippedAtWarning << "frames skipped since the last warning";
+            m_skippedAtWarning = m_framesSkipped.load();
+            m_skipWarningTimer.start();
+        }
+        return;
+    }
+
+    m_encoding++;
+    m_pool.start([this, frame, format, timestampMs]() {
+        std::vector<uchar> encoded;
+        bool ok = false;
+        try {
+            ok = FrameWriter::encodeJpeg(frame, format, encoded);
+        } catch (const cv::Exception &e) {
+            qDebug() << "Pre-trigger encode failed:" << e.what();
+        }
+        QByteArray jpeg = ok ? QByteArray(reinterpret_cast<const char *>(encoded.data()), qsizetype(encoded.size())) : QByteArray();
+        QMetaObject::invokeMethod(this, [this, timestampMs, jpeg]() {
+            m_encoding--;
+            if (jpeg.isEmpty()) {
+                m_framesSkipped++;
+                return;
+            }
+            addEncoded(timestampMs, jpeg);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void PreTriggerRecorder::addEncoded(qint64 timestampMs, const QByteArray &jpeg)
+{
+    m_framesEncoded++;
+    EncodedFrame frame{timestampMs, jpeg};
+
+    if (m_active) {
+        if (timestampMs <= m_event.endMs) {
+            queueFrame(frame);
+        } else {
+            finishEvent();
+        }
+    }
+
+    // Encoders run in parallel and can finish out of order.
+    auto position = std::upper_bound(m_ring.begin(), m_ring.end(), timestampMs,
+                                     [](qint64 value, const EncodedFrame &entry) { return value < entry.timestampMs; });
+    m_ring.insert(position, frame);
+    m_ringBytes += jpeg.size();
+    evict(timestampMs);
+}
+
+void PreTriggerRecorder::evict(qint64 newestMs)
+{
+    while (!m_ring.empty()
+           && (m_ring.front().timestampMs < newestMs - m_config.preTriggerMs || m_ringBytes > m_config.maxRingBytes)) {
+        m_ringBytes -= m_ring.front().jpeg.size();
+        m_ring.pop_front();
+        m_framesEvicted++;
+    }
+    updateRingMetrics();
+}
+
+void PreTriggerRecorder::updateRingMetrics()
+{
+    m_ringFrames = int(m_ring.size());
+    m_ringSizeBytes = m_ringBytes;
+    m_ringSpanMs = m_ring.empty() ? 0 : m_ring.back().timestampMs - m_ring.front().timestampMs;
+    m_writesPending = m_writeQueue.size() + m_writesInFlight;
+    m_eventActive = m_active;
+}
+
+void PreTriggerRecorder::trigger(const QString &reason, qint64 timestampMs)
+{
+    if (!m_config.isEnabled()) {
+        return;
+    }
+
+    if (m_active) {
+        m_event.endMs = std::max(m_event.endMs, timestampMs + m_config.postTriggerMs);
+        if (!m_event.reasons.contains(reason)) {
+            m_event.reasons.append(reason);
+        }
+        m_finishTimer->start(int(m_event.endMs - timestampMs) + FinishGraceMs);
+        return;
+    }
+
+    QString name = m_cameraId + "_" + QDateTime::fromMSecsSinceEpoch(timestampMs).toString("yyyyMMdd_hhmmss_zzz");
+    QString directory = m_eventsDirectory + "/" + name;
+    if (!QDir().mkpath(directory)) {
+        emit error("Cannot create event directory: " + directory);
+        return;
+    }
+
+    m_event = Event();
+    m_event.directory = directory;
+    m_event.triggerMs = timestampMs;
+    m_event.endMs = timestampMs + m_config.postTriggerMs;
+    m_event.reasons.append(reason);
+    m_active = true;
+    m_eventActive = true;
+    m_events++;
+
+    for (const EncodedFrame &frame : m_ring) {
+        queueFrame(frame);
+    }
+    m_event.preFrames = m_event.frames.size();
+    m_finishTimer->start(m_config.postTriggerMs + FinishGraceMs);
+
+    qDebug() << "Event triggered on camera" << m_cameraId << "by" << reason << "-" << m_event.preFrames
+             << "pre-trigger frames, writing to" << directory;
+}
+
+void PreTriggerRecorder::queueFrame(const EncodedFrame &frame)
+{
+    m_event.frames.append(frame.timestampMs);
+    m_writeQueue.enqueue({m_event.directory + "/frame_" + QString::number(frame.timestampMs) + ".jpg", frame.jpeg, false});
+    drainWrites();
+}
+
+void PreTriggerRecorder::drainWrites()
+{
+    // The shared writer caps requests in flight, so a pre-trigger burst is
+    // fed to it as completions free up room.
+    while (!m_writeQueue.isEmpty()) {
+        const PendingWrite &write = m_writeQueue.head();
+        QString path = write.path;
+        bool submitted = AsyncWriter::shared()->writeFile(path, write.data, write.durable, this,
+            [this, path](bool ok, const QString &errorMessage) {
+                m_writesInFlight--;
+                if (ok) {
+                    m_framesWritten++;
+                } else {
+                    m_writeFailures++;
+                    emit error("Failed to write event frame to: " + path + ". " + errorMessage);
+                }
+                drainWrites();
+            });
+        if (!submitted) {
+            if (m_writesInFlight == 0) {
+                QTimer::singleShot(WriteRetryMs, this, &PreTriggerRecorder::drainWrites);
+            }
+            break;
+        }
+        m_writesInFlight++;
+        m_writeQueue.dequeue();
+    }
+    m_writesPending = m_writeQueue.size() + m_writesInFlight;
+}
+
+void PreTriggerRecorder::finishEvent()
+{
+    if (!m_active) {
+        return;
+    }
+    m_active = false;
+    m_eventActive = false;
+    m_finishTimer->stop();
+
+    std::sort(m_event.frames.begin(), m_event.frames.end());
+    QJsonArray frames;
+    for (qint64 timestampMs : m_event.frames) {
+        QJsonObject frame;
+        frame["timestampMs"] = timestampMs;
+        frame["file"] = "frame_" + QString::number(timestampMs) + ".jpg";
+        frame["preTrigger"] = timestampMs <= m_event.triggerMs;
+        frames.append(frame);
+    }
+
+    QJsonObject index;
+    index["camera"] = m_cameraId;
+    index["reasons"] = QJsonArray::fromStringList(m_event.reasons);
+    index["triggerMs"] = m_event.triggerMs;
+    index["endMs"] = m_event.endMs;
+    index["preTriggerMs"] = m_config.preTriggerMs;
+    index["postTriggerMs"] = m_config.postTriggerMs;
+    index["frames"] = frames;
+    m_writeQueue.enqueue({m_event.directory + "/event.json", QJsonDocument(index).toJson(), true});
+    drainWrites();
+
+    qDebug() << "Event on camera" << m_cameraId << "closed with" << m_event.frames.size() << "frames";
+    emit eventRecorded(m_event.directory, m_event.frames.size(), m_event.reasons);
+}
+
+void PreTriggerRecorder::finish()
+{
+    // Frames still being encoded belong to the event, and its index and
+    // last frames must be on disk before this returns: completions are
+    // queued to this thread, so they are delivered here while waiting.
+    m_pool.waitForDone();
+    QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+    finishEvent();
+    while (!m_writeQueue.isEmpty() || m_writesInFlight > 0) {
+        drainWrites();
+        AsyncWriter::shared()->waitForIdle();
+        QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+    }
+
+    m_ring.clear();
+    m_ringBytes = 0;
+    updateRingMetrics();
+}
+
+QVariantMap PreTriggerRecorder::metrics() const
+{
+    QVariantMap result;
+    result["preTriggerMs"] = m_config.preTriggerMs;
+    result["ringFrames"] = m_ringFrames.load();
+    result["ringBytes"] = m_ringSizeBytes.load();
+    result["ringSpanMs"] = m_ringSpanMs.load();
+    result["ringFramesEncoded"] = m_framesEncoded.load();
+    result["ringFramesSkipped"] = m_framesSkipped.load();
+    result["ringFramesEvicted"] = m_framesEvicted.load();
+    result["eventFramesWritten"] = m_framesWritten.load();
+    result["eventWriteFailures"] = m_writeFailures.load();
+    result["eventWritesPending"] = m_writesPending.load();
+    result["events"] = m_events.load();
+    result["eventActive"] = m_eventActive.load();
+    return result;
+}
@@ -0,0 +1,292 @@
+#include "Resampler.h"
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace {
+
+constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+
+qint64 floorToInterval(qint64 timestampMs, qint64 intervalMs)
+{
+    qint64 remainder = timestampMs % intervalMs;
+    return remainder < 0 ? timestampMs - remainder - intervalMs : timestampMs - remainder;
+}
+
+}
+
+Resampler::Resampler(ResampleMethod method, qint64 intervalMs, int channels, qint64 startMs)
+    : m_method(method)
+    , m_intervalMs(std::max<qint64>(1, intervalMs))
+    , m_channels(std::clamp(channels, 1, MaxChannels))
+    , m_nextMs(startMs)
+    , m_started(startMs != AutoStart)
+    , m_haveSample(false)
+    , m_lastMs(0)
+    , m_bucketCount(0)
+    , m_dropped(0)
+{
+    std::fill(std::begin(m_last), std::end(m_last), NaN);
+    std::fill(std::begin(m_sum), std::end(m_sum), 0.0);
+}
+
+void Resampler::push(qint64 timestampMs, const double *values)
+{
+    if (m_haveSample && timestampMs < m_lastMs) {
+        m_dropped++;
+        return;
+    }
+    if (!m_started) {
+        m_nextMs = alignedStart(m_method, timestampMs, m_intervalMs);
+        m_started = true;
+    }
+
+    double point[MaxChannels];
+    switch (m_method) {
+    case ResampleMethod::Linear:
+        // A point at exactly this sample's time is emitted by the next
+        // sample or by finish(), once no later sample can share the time.
+        while (m_nextMs < timestampMs) {
+            if (!m_haveSample) {
+                emitEmptyPoint();
+            } else {
+                double weight = double(m_nextMs - m_lastMs) / double(timestampMs - m_lastMs);
+                for (int c = 0; c < m_channels; ++c) {
+                    point[c] = m_last[c] + (values[c] - m_last[c]) * weight;
+                }
+                emitPoint(point);
+            }
+        }
+        break;
+    case ResampleMethod::Previous:
+        while (m_nextMs < timestampMs) {
+            if (m_haveSample) {
+                emitPoint(m_last);
+            } else {
+                emitEmptyPoint();
+            }
+        }
+        break;
+    case ResampleMethod::Mean:
+        if (timestampMs < m_nextMs) {
+            // Before the first bucket of an explicit start.
+            m_dropped++;
+            return;
+        }
+        while (m_nextMs + m_intervalMs <= timestampMs) {
+            if (m_bucketCount > 0) {
+                for (int c = 0; c < m_channels; ++c) {
+                    point[c] = m_sum[c] / m_bucketCount;
+                    m_sum[c] = 0.0;
+                }
+                m_bucketCount = 0;
+                emitPoint(point);
+            } else {
+                emitEmptyPoint();
+            }
+        }
+        for (int c = 0; c < m_channels; ++c) {
+            m_sum[c] += values[c];
+        }
+        m_bucketCount++;
+        break;
+    }
+
+    std::copy(values, values + m_channels, m_last);
+    m_lastMs = timestampMs;
+    m_haveSample = true;
+}
+
+void Resampler::finish()
+{
+    if (m_method != ResampleMethod::Mean) {
+        while (m_haveSample && m_nextMs <= m_lastMs) {
+            emitPoint(m_last);
+        }
+    } else if (m_bucketCount > 0) {
+        double point[MaxChannels];
+        for (int c = 0; c < m_channels; ++c) {
+            point[c] = m_sum[c] / m_bucketCount;
+            m_sum[c] = 0.0;
+        }
+        m_bucketCount = 0;
+        emitPoint(point);
+    }
+}
+
+bool Resampler::takePoint(qint64 &timestampMs, double *values)
+{
+    if (m_ready.empty()) {
+        return false;
+    }
+    const Point &point = m_ready.front();
+    timestampMs = point.timestampMs;
+    std::copy(point.values, point.values + m_channels, values);
+    m_ready.pop_front();
+    return true;
+}
+
+void Resampler::emitPoint(const double *values)
+{
+    Point point;
+    point.timestampMs = m_nextMs;
+    std::copy(values, values + m_channels, point.values);
+    m_ready.push_back(point);
+    m_nextMs += m_intervalMs;
+}
+
+void Resampler::emitEmptyPoint()
+{
+    double empty[MaxChannels];
+    std::fill(std::begin(empty), std::end(empty), NaN);
+    emitPoint(empty);
+}
+
+int Resampler::gridSize(qint64 startMs, qint64 endMs, qint64 intervalMs)
+{
+    if (endMs < startMs || intervalMs <= 0) {
+        return 0;
+    }
+    return int((endMs - startMs) / intervalMs + 1);
+}
+
+qint64 Resampler::alignedStart(ResampleMethod method, qint64 firstMs, qint64 intervalMs)
+{
+    // Buckets start on a whole interval at or before the first sample;
+    // interpolated points start at the first whole interval it covers.
+    qint64 start = floorToInterval(firstMs, intervalMs);
+    if (method != ResampleMethod::Mean && start < firstMs) {
+        start += intervalMs;
+    }
+    return start;
+}
+
+void Resampler::resample(ResampleMethod method, const qint64 *timestamps, const double *const *columns,
+                         int count, int channels, qint64 startMs, qint64 intervalMs, int points,
+                         double *const *outputs)
+{
+    if (points <= 0) {
+        return;
+    }
+    if (count <= 0) {
+        for (int c = 0; c < channels; ++c) {
+            std::fill(outputs[c], outputs[c] + points, NaN);
+        }
+        return;
+    }
+
+    if (method == ResampleMethod::Mean) {
+        // bounds[i] is the first sample at or after point i, so bucket i is
+        // samples [bounds[i], bounds[i + 1]). Bucket means come from prefix
+        // sums, and an empty bucket divides 0 by 0, giving NaN.
+        std::vector<int> bounds(points + 1);
+        int j = 0;
+        for (int i = 0; i <= points; ++i) {
+            qint64 t = startMs + qint64(i) * intervalMs;
+            while (j < count && timestamps[j] < t) {
+                j++;
+            }
+            bounds[i] = j;
+        }
+
+        std::vector<double> sizes(points);
+        for (int i = 0; i < points; ++i) {
+            sizes[i] = double(bounds[i + 1] - bounds[i]);
+        }
+
+        std::vector<double> prefix(count + 1);
+        std::vector<double> low(points);
+        std::vector<double> high(points);
+        for (int c = 0; c < channels; ++c) {
+            const double *column = columns[c];
+            prefix[0] = 0.0;
+            for (int k = 0; k < count; ++k) {
+                prefix[k + 1] = prefix[k] + column[k];
+            }
+            for (int i = 0; i < points; ++i) {
+                low[i] = prefix[bounds[i]];
+                high[i] = prefix[bounds[i + 1]];
+            }
+            double *output = outputs[c];
+            for (int i = 0; i < points; ++i) {
+                output[i] = (high[i] - low[i]) / sizes[i];
+            }
+        }
+        return;
+    }
+
+    // One pass finds, for every point, the sample at or before it and how
+    // far the point lies towards the next one. Points nothing covers get
+    // index -1 and come out NaN.
+    std::vector<int> left(points);
+    std::vector<int> right(points);
+    std::vector<double> weight(points, 0.0);
+    int j = 0;
+    for (int i = 0; i < points; ++i) {
+        qint64 t = startMs + qint64(i) * intervalMs;
+        while (j < count && timestamps[j] <= t) {
+            j++;
+        }
+
+        int before = j - 1;
+        if (before >= 0 && method == ResampleMethod::Linear && timestamps[before] != t) {
+            if (j == count) {
+                before = -1;
+            } else {
+                weight[i] = double(t - timestamps[before]) / double(timestamps[j] - timestamps[before]);
+            }
+        }
+        left[i] = before;
+        right[i] = std::min(before + 1, count - 1);
+    }
+
+    // The gathers into low and high are indexed loads and stay scalar; they
+    // leave contiguous buffers for the interpolation loop, which vectorises.
+    std::vector<double> low(points);
+    std::vector<double> high(points);
+    for (int c = 0; c < channels; ++c) {
+        const double *column = columns[c];
+        double *output = outputs[c];
+        for (int i = 0; i < points; ++i) {
+            low[i] = left[i] >= 0 ? column[left[i]] : NaN;
+        }
+        if (method == ResampleMethod::Previous) {
+            std::copy(low.begin(), low.end(), output);
+            continue;
+        }
+        for (int i = 0; i < points; ++i) {
+            high[i] = column[std::max(0, right[i])];
+        }
+        for (int i = 0; i < points; ++i) {
+            output[i] = low[i] + (high[i] - low[i]) * weight[i];
+        }
+    }
+}
+
+bool Resampler::parseMethod(const QString &text, ResampleMethod &method)
+{
+    QString name = text.trimmed().toLower();
+    if (name == "linear") {
+        method = ResampleMethod::Linear;
+    } else if (name == "previous") {
+        method = ResampleMethod::Previous;
+    } else if (name == "mean") {
+        method = ResampleMethod::Mean;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+QString Resampler::methodName(ResampleMethod method)
+{
+    switch (method) {
+    case ResampleMethod::Linear:
+        return "linear";
+    case ResampleMethod::Previous:
+        return "previous";
+    case ResampleMethod::Mean:
+        return "mean";
+    }
+    return QString();
+}
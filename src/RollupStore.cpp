@@ -0,0 +1,379 @@
+#include "RollupStore.h"
+#include <QDebug>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static const char RollupMagic[4] = {'C', 'S', 'D', 'R'};
+static const quint32 RollupVersion = 1;
+
+void RollupStats::add(double value)
+{
+    if (count == 0) {
+        min = value;
+        max = value;
+    } else {
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+    count++;
+    sum += value;
+    sumSquares += value * value;
+}
+
+void RollupStats::merge(const RollupStats &other)
+{
+    if (other.count == 0) {
+        return;
+    }
+    if (count == 0) {
+        *this = other;
+        return;
+    }
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+    count += other.count;
+    sum += other.sum;
+    sumSquares += other.sumSquares;
+}
+
+double RollupStats::stdDev() const
+{
+    if (count < 2) {
+        return 0.0;
+    }
+    double m = mean();
+    return std::sqrt(std::max(0.0, sumSquares / count - m * m));
+}
+
+void RollupBucket::merge(const RollupBucket &other)
+{
+    temperature.merge(other.temperature);
+    pressure.merge(other.pressure);
+}
+
+static void writeStats(QDataStream &stream, const RollupStats &stats)
+{
+    stream << quint64(stats.count) << stats.min << stats.max << stats.sum << stats.sumSquares;
+}
+
+static void readStats(QDataStream &stream, RollupStats &stats)
+{
+    quint64 count;
+    stream >> count >> stats.min >> stats.max >> stats.sum >> stats.sumSquares;
+    stats.count = count;
+}
+
+static void prepareStream(QDataStream &stream)
+{
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+}
+
+RollupStore::RollupStore()
+{
+}
+
+RollupStore::RollupStore(const RollupStore &other)
+{
+    *this = other;
+}
+
+RollupStore &RollupStore::operator=(const RollupStore &other)
+{
+    // Copies share the buckets but never the output file.
+    if (this != &other) {
+        for (int tier = 0; tier < TierCount; ++tier) {
+            m_tiers[tier] = other.m_tiers[tier];
+        }
+    }
+    return *this;
+}
+
+qint64 RollupStore::tierInterval(int tier)
+{
+    switch (tier) {
+    case Second: return 1000;
+    case Minute: return 60 * 1000;
+    case Hour: return 60 * 60 * 1000;
+    default: break;
+    }
+    return 1000;
+}
+
+QString RollupStore::sidecarPath(const QString &logFilename)
+{
+    QFileInfo info(logFilename);
+    return info.absolutePath() + "/" + info.completeBaseName() + ".rollups";
+}
+
+QVariantMap RollupStore::toVariantMap(const RollupBucket &bucket)
+{
+    QVariantMap result;
+    result["startTime"] = QDateTime::fromMSecsSinceEpoch(bucket.startMs);
+    result["count"] = bucket.temperature.count;
+    result["temperatureMin"] = bucket.temperature.min;
+    result["temperatureMax"] = bucket.temperature.max;
+    result["temperatureMean"] = bucket.temperature.mean();
+    result["temperatureStdDev"] = bucket.temperature.stdDev();
+    result["pressureMin"] = bucket.pressure.min;
+    result["pressureMax"] = bucket.pressure.max;
+    result["pressureMean"] = bucket.pressure.mean();
+    result["pressureStdDev"] = bucket.pressure.stdDev();
+    return result;
+}
+
+void RollupStore::clear()
+{
+    for (QVector<RollupBucket> &tier : m_tiers) {
+        tier.clear();
+    }
+}
+
+quint64 RollupStore::sampleCount() const
+{
+    quint64 count = 0;
+    for (const RollupBucket &bucket : m_tiers[Hour]) {
+        count += bucket.temperature.count;
+    }
+    return count;
+}
+
+int RollupStore::lowerBound(int tier, qint64 startMs) const
+{
+    const QVector<RollupBucket> &buckets = m_tiers[tier];
+    auto it = std::lower_bound(buckets.cbegin(), buckets.cend(), startMs,
+                               [](const RollupBucket &bucket, qint64 value) {
+                                   return bucket.startMs < value;
+                               });
+    return static_cast<int>(it - buckets.cbegin());
+}
+
+void RollupStore::add(qint64 timestampMs, double temperature, double pressure)
+{
+    for (int tier = 0; tier < TierCount; ++tier) {
+        qint64 interval = tierInterval(tier);
+        qint64 startMs = timestampMs - timestampMs % interval;
+        QVector<RollupBucket> &buckets = m_tiers[tier];
+
+        RollupBucket *bucket = nullptr;
+        if (!buckets.isEmpty() && buckets.last().startMs == startMs) {
+            bucket = &buckets.last();
+        } else if (buckets.isEmpty() || buckets.last().startMs < startMs) {
+            if (!buckets.isEmpty()) {
+                writeBucket(tier, buckets.last());
+            }
+            RollupBucket created;
+            created.startMs = startMs;
+            buckets.append(created);
+            bucket = &buckets.last();
+        } else {
+            // Late sample for an earlier bucket; it was already persisted, so
+            // only the in-memory tier sees the correction.
+            int index = lowerBound(tier, startMs);
+            if (index >= buckets.size() || buckets[index].startMs != startMs) {
+                RollupBucket created;
+                created.startMs = startMs;
+                buckets.insert(index, created);
+            }
+            bucket = &buckets[index];
+        }
+
+        bucket->temperature.add(temperature);
+        bucket->pressure.add(pressure);
+    }
+}
+
+RollupBucket RollupStore::summarize(qint64 startMs, qint64 endMs) const
+{
+    RollupBucket result;
+    result.startMs = startMs;
+    if (endMs > startMs) {
+        result.merge(summarize(startMs, endMs, Hour));
+    }
+    return result;
+}
+
+RollupBucket RollupStore::summarize(qint64 startMs, qint64 endMs, int tier) const
+{
+    // Use whole buckets of the coarsest tier that fit inside the range and
+    // fill the ragged edges from the next finer tier. The 1 s tier is the
+    // floor: an edge second is counted whole.
+    RollupBucket result;
+    if (endMs <= startMs) {
+        return result;
+    }
+
+    qint64 interval = tierInterval(tier);
+    qint64 alignedStart = tier == Second ? startMs - startMs % interval
+                                         : ((startMs + interval - 1) / interval) * interval;
+    qint64 alignedEnd = tier == Second ? endMs : endMs - endMs % interval;
+
+    if (tier > Second && alignedStart >= alignedEnd) {
+        return summarize(startMs, endMs, tier - 1);
+    }
+
+    const QVector<RollupBucket> &buckets = m_tiers[tier];
+    for (int i = lowerBound(tier, alignedStart); i < buckets.size() && buckets[i].startMs < alignedEnd; ++i) {
+        result.merge(buckets[i]);
+    }
+
+    if (tier > Second) {
+        result.merge(summarize(startMs, alignedStart, tier - 1));
+        result.merge(summarize(alignedEnd, endMs, tier - 1));
+    }
+    return result;
+}
+
+QVector<RollupBucket> RollupStore::series(qint64 startMs, qint64 endMs, int maxPoints, int *tierUsed) const
+{
+    int tier = Second;
+    for (; tier < Hour; ++tier) {
+        int first = lowerBound(tier, startMs - startMs % tierInterval(tier));
+        int end = lowerBound(tier, endMs);
+        if (end - first <= maxPoints) {
+            break;
+        }
+    }
+
+    if (tierUsed) {
+        *tierUsed = tier;
+    }
+
+    const QVector<RollupBucket> &buckets = m_tiers[tier];
+    int first = lowerBound(tier, startMs - startMs % tierInterval(tier));
+    int end = lowerBound(tier, endMs);
+    return buckets.mid(first, std::max(0, end - first));
+}
+
+void RollupStore::writeBucket(int tier, const RollupBucket &bucket)
+{
+    if (!m_output) {
+        return;
+    }
+
+    QDataStream stream(m_output.get());
+    prepareStream(stream);
+    stream << quint8(tier) << qint64(bucket.startMs);
+    writeStats(stream, bucket.temperature);
+    writeStats(stream, bucket.pressure);
+}
+
+bool RollupStore::openOutput(const QString &filename, QString *errorMessage)
+{
+    closeOutput();
+
+    m_output = std::make_unique<QFile>(filename);
+    if (!m_output->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (errorMessage) {
+            *errorMessage = "Cannot create rollup file: " + filename + ". Error: " + m_output->errorString();
+        }
+        m_output.reset();
+        return false;
+    }
+
+    QDataStream stream(m_output.get());
+    prepareStream(stream);
+    stream.writeRawData(RollupMagic, 4);
+    stream << RollupVersion;
+    return true;
+}
+
+void RollupStore::closeOutput()
+{
+    if (!m_output) {
+        return;
+    }
+
+    for (int tier = 0; tier < TierCount; ++tier) {
+        if (!m_tiers[tier].isEmpty()) {
+            writeBucket(tier, m_tiers[tier].last());
+        }
+    }
+    m_output->close();
+    m_output.reset();
+}
+
+bool RollupStore::save(const QString &filename, QString *errorMessage) const
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (errorMessage) {
+            *errorMessage = "Cannot create rollup file: " + filename + ". Error: " + file.errorString();
+        }
+        return false;
+    }
+
+    QDataStream stream(&file);
+    prepareStream(stream);
+    stream.writeRawData(RollupMagic, 4);
+    stream << RollupVersion;
+    for (int tier = 0; tier < TierCount; ++tier) {
+        for (const RollupBucket &bucket : m_tiers[tier]) {
+            stream << quint8(tier) << qint64(bucket.startMs);
+            writeStats(stream, bucket.temperature);
+            writeStats(stream, bucket.pressure);
+        }
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+bool RollupStore::load(const QString &filename, QString *errorMessage)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorMessage) {
+            *errorMessage = "Cannot open rollup file: " + filename + ". Error: " + file.errorString();
+        }
+        return false;
+    }
+
+    QDataStream stream(&file);
+    prepareStream(stream);
+    char magic[4];
+    quint32 version = 0;
+    if (stream.readRawData(magic, 4) != 4 || memcmp(magic, RollupMagic, 4) != 0) {
+        if (errorMessage) {
+            *errorMessage = "Not a rollup file: " + filename;
+        }
+        return false;
+    }
+    stream >> version;
+    if (version != RollupVersion) {
+        if (errorMessage) {
+            *errorMessage = QString("Unsupported rollup file version %1: %2").arg(version).arg(filename);
+        }
+        return false;
+    }
+
+    clear();
+    while (!stream.atEnd()) {
+        quint8 tier;
+        qint64 startMs;
+        RollupBucket bucket;
+        stream >> tier >> startMs;
+        readStats(stream, bucket.temperature);
+        readStats(stream, bucket.pressure);
+        if (stream.status() != QDataStream::Ok || tier >= TierCount) {
+            // A truncated trailing record from an interrupted session.
+            break;
+        }
+        bucket.startMs = startMs;
+
+        QVector<RollupBucket> &buckets = m_tiers[tier];
+        if (buckets.isEmpty() || buckets.last().startMs < startMs) {
+            buckets.append(bucket);
+        } else {
+            int index = lowerBound(tier, startMs);
+            if (index < buckets.size() && buckets[index].startMs == startMs) {
+                buckets[index].merge(bucket);
+            } else {
+                buckets.insert(index, bucket);
+            }
+        }
+    }
+    return true;
+}
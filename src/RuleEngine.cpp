@@ -0,0 +1,372 @@
+#include "RuleEngine.h"
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <algorithm>
+
+RuleEngine::RuleEngine(QObject *parent)
+    : QObject(parent)
+    , m_batchSize(256)
+    , m_flushTimer(new QTimer(this))
+    , m_batches(0)
+    , m_samplesEvaluated(0)
+    , m_alertsRaised(0)
+    , m_lastBatchNs(0)
+    , m_maxBatchNs(0)
+    , m_totalBatchNs(0)
+    , m_lastBatchSamples(0)
+{
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(250);
+    connect(m_flushTimer, &QTimer::timeout, this, &RuleEngine::flush);
+}
+
+QString RuleEngine::channelName(int channel)
+{
+    switch (channel) {
+    case Temperature: return "temperature";
+    case Pressure: return "pressure";
+    default: break;
+    }
+    return QString();
+}
+
+static int parseChannel(const QString &name)
+{
+    QString channel = name.trimmed().toLower();
+    for (int i = 0; i < RuleEngine::ChannelCount; ++i) {
+        if (channel == RuleEngine::channelName(i)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static qint64 parseDuration(const QString &number, const QString &unit)
+{
+    double value = number.toDouble();
+    if (unit == "ms") return qint64(value);
+    if (unit == "m") return qint64(value * 60 * 1000);
+    if (unit == "h") return qint64(value * 60 * 60 * 1000);
+    return qint64(value * 1000);
+}
+
+bool RuleEngine::compile(const QString &expression, CompiledRule &rule, QString *errorMessage)
+{
+    // temperature > 30
+    // rate(pressure) < -0.5          change per second
+    // avg(temperature, 60s) > 28     window in ms, s, m or h
+    static const QRegularExpression thresholdPattern(
+        R"(^\s*(\w+)\s*([<>])\s*(-?\d+(?:\.\d+)?)\s*$)");
+    static const QRegularExpression ratePattern(
+        R"(^\s*rate\(\s*(\w+)\s*\)\s*([<>])\s*(-?\d+(?:\.\d+)?)\s*$)");
+    static const QRegularExpression averagePattern(
+        R"(^\s*avg\(\s*(\w+)\s*,\s*(\d+(?:\.\d+)?)\s*(ms|s|m|h)?\s*\)\s*([<>])\s*(-?\d+(?:\.\d+)?)\s*$)");
+
+    QString channel;
+    QString comparison;
+    QString limit;
+    rule.windowMs = 0;
+
+    QRegularExpressionMatch match = averagePattern.match(expression);
+    if (match.hasMatch()) {
+        rule.kind = RuleKind::WindowAverage;
+        channel = match.captured(1);
+        rule.windowMs = parseDuration(match.captured(2), match.captured(3));
+        comparison = match.captured(4);
+        limit = match.captured(5);
+    } else if ((match = ratePattern.match(expression)).hasMatch()) {
+        rule.kind = RuleKind::RateOfChange;
+        channel = match.captured(1);
+        comparison = match.captured(2);
+        limit = match.captured(3);
+    } else if ((match = thresholdPattern.match(expression)).hasMatch()) {
+        rule.kind = RuleKind::Threshold;
+        channel = match.captured(1);
+        comparison = match.captured(2);
+        limit = match.captured(3);
+    } else {
+        if (errorMessage) {
+            *errorMessage = "Cannot parse rule: " + expression;
+        }
+        return false;
+    }
+
+    int channelIndex = parseChannel(channel);
+    if (channelIndex < 0) {
+        if (errorMessage) {
+            *errorMessage = "Unknown channel in rule: " + channel;
+        }
+        return false;
+    }
+    if (rule.kind == RuleKind::WindowAverage && rule.windowMs <= 0) {
+        if (errorMessage) {
+            *errorMessage = "Window must be positive in rule: " + expression;
+        }
+        return false;
+    }
+
+    rule.channel = quint8(channelIndex);
+    rule.above = comparison == ">";
+    rule.limit = limit.toDouble();
+    return true;
+}
+
+void RuleEngine::addCommandLineOptions(QCommandLineParser &parser)
+{
+    parser.addOption(QCommandLineOption("rule", "Alert rule as [name=]<expression>, e.g. \"hot=temperature > 30\" (repeatable).", "rule"));
+}
+
+bool RuleEngine::applyCommandLineOptions(const QCommandLineParser &parser, QStringList &rules, QString *errorMessage)
+{
+    if (parser.isSet("rule")) {
+        rules = parser.values("rule");
+    }
+    for (const QString &definition : rules) {
+        QString name;
+        QString expression;
+        splitDefinition(definition, name, expression);
+        CompiledRule rule;
+        if (!compile(expression, rule, errorMessage)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void RuleEngine::splitDefinition(const QString &definition, QString &name, QString &expression)
+{
+    // A definition is "name=expression" or just "expression".
+    int separator = definition.indexOf('=');
+    name = separator > 0 ? definition.left(separator).trimmed() : QString();
+    expression = separator > 0 ? definition.mid(separator + 1) : definition;
+}
+
+bool RuleEngine::addRule(const QString &name, const QString &expression)
+{
+    CompiledRule rule;
+    QString errorMessage;
+    if (!compile(expression, rule, &errorMessage)) {
+        emit error(errorMessage);
+        return false;
+    }
+
+    flush();
+    appendRule(name, expression, rule);
+    emit rulesChanged();
+    return true;
+}
+
+bool RuleEngine::addRules(const QStringList &definitions, QString *errorMessage)
+{
+    // Nothing is added unless every definition compiles.
+    QStringList names;
+    QStringList expressions;
+    QVector<CompiledRule> compiled;
+    for (const QString &definition : definitions) {
+        QString name;
+        QString expression;
+        splitDefinition(definition, name, expression);
+        CompiledRule rule;
+        if (!compile(expression, rule, errorMessage)) {
+            return false;
+        }
+        names.append(name);
+        expressions.append(expression);
+        compiled.append(rule);
+    }
+    if (compiled.isEmpty()) {
+        return true;
+    }
+
+    flush();
+    for (int i = 0; i < compiled.size(); ++i) {
+        appendRule(names[i], expressions[i], compiled[i]);
+    }
+    emit rulesChanged();
+    return true;
+}
+
+void RuleEngine::appendRule(const QString &name, const QString &expression, const CompiledRule &rule)
+{
+    m_rules.append(rule);
+    m_states.append(RuleState());
+    m_names.append(name.isEmpty() ? expression.trimmed() : name);
+    m_expressions.append(expression.trimmed());
+}
+
+void RuleEngine::clearRules()
+{
+    flush();
+    bool hadActive = !activeAlerts().isEmpty();
+    m_rules.clear();
+    m_states.clear();
+    m_names.clear();
+    m_expressions.clear();
+    emit rulesChanged();
+    if (hadActive) {
+        emit activeAlertsChanged();
+    }
+}
+
+QVariantList RuleEngine::rules() const
+{
+    QVariantList result;
+    for (int i = 0; i < m_rules.size(); ++i) {
+        QVariantMap rule;
+        rule["name"] = m_names[i];
+        rule["expression"] = m_expressions[i];
+        rule["active"] = m_states[i].active;
+        result.append(rule);
+    }
+    return result;
+}
+
+QStringList RuleEngine::activeAlerts() const
+{
+    QStringList active;
+    for (int i = 0; i < m_states.size(); ++i) {
+        if (m_states[i].active) {
+            active.append(m_names[i]);
+        }
+    }
+    return active;
+}
+
+void RuleEngine::addSample(qint64 timestampMs, double temperature, double pressure)
+{
+    if (m_rules.isEmpty()) {
+        return;
+    }
+
+    m_times.append(timestampMs);
+    m_columns[Temperature].append(temperature);
+    m_columns[Pressure].append(pressure);
+
+    if (m_times.size() >= m_batchSize) {
+        flush();
+    } else if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void RuleEngine::flush()
+{
+    m_flushTimer->stop();
+    int samples = m_times.size();
+    if (samples == 0) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<RuleEvent> events;
+    for (int i = 0; i < m_rules.size(); ++i) {
+        evaluate(i, events);
+    }
+
+    m_times.clear();
+    for (QVector<double> &column : m_columns) {
+        column.clear();
+    }
+
+    qint64 elapsedNs = timer.nsecsElapsed();
+    m_batches++;
+    m_samplesEvaluated += samples;
+    m_lastBatchSamples = samples;
+    m_lastBatchNs = elapsedNs;
+    m_maxBatchNs = std::max(m_maxBatchNs, elapsedNs);
+    m_totalBatchNs += elapsedNs;
+
+    if (events.isEmpty()) {
+        return;
+    }
+
+    std::stable_sort(events.begin(), events.end(), [](const RuleEvent &a, const RuleEvent &b) {
+        return a.timestampMs < b.timestampMs;
+    });
+    for (const RuleEvent &event : events) {
+        if (event.raised) {
+            m_alertsRaised++;
+            emit alertRaised(m_names[event.rule], event.value, event.timestampMs);
+        } else {
+            emit alertCleared(m_names[event.rule], event.value, event.timestampMs);
+        }
+    }
+    emit activeAlertsChanged();
+}
+
+void RuleEngine::evaluate(int ruleIndex, QVector<RuleEvent> &events)
+{
+    // One rule over one contiguous column per pass; only edges (the rule
+    // turning on or off) produce events.
+    const CompiledRule &rule = m_rules[ruleIndex];
+    RuleState &state = m_states[ruleIndex];
+    const qint64 *times = m_times.constData();
+    const double *values = m_columns[rule.channel].constData();
+    int count = m_times.size();
+
+    for (int i = 0; i < count; ++i) {
+        double metric = values[i];
+        bool valid = true;
+
+        switch (rule.kind) {
+        case RuleKind::Threshold:
+            break;
+        case RuleKind::RateOfChange:
+            if (state.hasPrevious && times[i] > state.previousMs) {
+                metric = (values[i] - state.previousValue) * 1000.0 / (times[i] - state.previousMs);
+            } else {
+                valid = false;
+            }
+            state.hasPrevious = true;
+            state.previousMs = times[i];
+            state.previousValue = values[i];
+            break;
+        case RuleKind::WindowAverage: {
+            state.windowTimes.append(times[i]);
+            state.windowValues.append(values[i]);
+            state.windowSum += values[i];
+            while (state.windowTimes[state.windowStart] <= times[i] - rule.windowMs) {
+                state.windowSum -= state.windowValues[state.windowStart];
+                state.windowStart++;
+            }
+            if (state.windowStart > 1024 && state.windowStart * 2 > state.windowTimes.size()) {
+                state.windowTimes.remove(0, state.windowStart);
+                state.windowValues.remove(0, state.windowStart);
+                state.windowStart = 0;
+            }
+            metric = state.windowSum / (state.windowTimes.size() - state.windowStart);
+            break;
+        }
+        }
+
+        if (!valid) {
+            continue;
+        }
+
+        bool triggered = rule.above ? metric > rule.limit : metric < rule.limit;
+        if (triggered != state.active) {
+            state.active = triggered;
+            events.append({ruleIndex, triggered, metric, times[i]});
+        }
+    }
+}
+
+QVariantMap RuleEngine::metrics() const
+{
+    QVariantMap result;
+    result["rules"] = m_rules.size();
+    result["batches"] = m_batches;
+    result["samplesEvaluated"] = m_samplesEvaluated;
+    result["alertsRaised"] = m_alertsRaised;
+    result["lastBatchSamples"] = m_lastBatchSamples;
+    result["lastBatchUs"] = m_lastBatchNs / 1000.0;
+    result["maxBatchUs"] = m_maxBatchNs / 1000.0;
+    result["meanBatchUs"] = m_batches > 0 ? m_totalBatchNs / 1000.0 / m_batches : 0.0;
+    quint64 evaluations = m_samplesEvaluated * quint64(qMax(1, m_rules.size()));
+    result["nsPerEvaluation"] = evaluations > 0 ? double(m_totalBatchNs) / evaluations : 0.0;
+    return result;
+}
@@ -1,18 +1,31 @@
 #include "SensorDataGenerator.h"
+#include "AcquisitionClock.h"
+#include "SensorSampleModel.h"
 #include <QDebug>
+#include <algorithm>
+
+static const int BusBlockSlots = 256;
+static const int BusBlockMs = 50;
 
 SensorDataGenerator::SensorDataGenerator(QObject *parent)
     : QObject(parent)
     , m_timer(new QTimer(this))
+    , m_notifyTimer(new QTimer(this))
     , m_isRunning(false)
     , m_samplingRate(1.0) 
     , m_temperature(20.0)
     , m_pressure(1013.25)
+    , m_busBlockSize(1)
     , m_generator(m_randomDevice())
     , m_tempDistribution(15.0, 35.0)    
     , m_pressureDistribution(990.0, 1030.0) 
 {
     connect(m_timer, &QTimer::timeout, this, &SensorDataGenerator::generateData);
+
+    // Property bindings follow the display, not the sampling rate.
+    m_notifyTimer->setSingleShot(true);
+    m_notifyTimer->setInterval(SensorSampleModel::displayIntervalMs());
+    connect(m_notifyTimer, &QTimer::timeout, this, &SensorDataGenerator::readingChanged);
     setSamplingRate(m_samplingRate); 
 }
 
@@ -26,6 +39,9 @@ void SensorDataGenerator::setSamplingRate(double rate)
         m_samplingRate = rate;
         int intervalMs = static_cast<int>(1000.0 / rate);
         m_timer->setInterval(intervalMs);
+        // Batch bus messages at high rates, but never hold a reading longer
+        // than about BusBlockMs.
+        m_busBlockSize = std::clamp(int(BusBlockMs * rate / 1000.0), 1, int(SharedBus::SamplesPerBlock));
         emit samplingRateChanged();
     }
 }
@@ -53,6 +69,7 @@ void SensorDataGenerator::stop()
 {
     if (m_isRunning) {
         m_timer->stop();
+        publishBlock();
         m_isRunning = false;
         emit runningChanged();
     }
@@ -63,9 +80,39 @@ void SensorDataGenerator::generateData()
     m_temperature = m_tempDistribution(m_generator);
     m_pressure = m_pressureDistribution(m_generator);
     
-    QString timestamp = QDateTime::currentDateTime().toString(Qt::ISODate);
-    
-    emit temperatureChanged();
-    emit pressureChanged();
-    emit dataReady(m_temperature, m_pressure, timestamp);
+    qint64 timestampMs = AcquisitionClock::nowMs();
+
+    emit sampleReady(timestampMs, m_temperature, m_pressure);
+    if (!m_notifyTimer->isActive()) {
+        m_notifyTimer->start();
+    }
+
+    if (m_busWriter.isOpen()) {
+        m_busBlock.append({timestampMs, m_temperature, m_pressure});
+        if (m_busBlock.size() >= m_busBlockSize) {
+            publishBlock();
+        }
+    }
+}
+
+bool SensorDataGenerator::setBusName(const QString &busName, QString *errorMessage)
+{
+    publishBlock();
+    m_busWriter.destroy();
+    if (busName.isEmpty()) {
+        return true;
+    }
+    m_busBlock.reserve(SharedBus::SamplesPerBlock);
+    return m_busWriter.create(busName, "samples", SharedBus::SampleStream, BusBlockSlots,
+                              SharedBus::SamplesPerBlock * sizeof(SharedBus::Sample), errorMessage);
+}
+
+void SensorDataGenerator::publishBlock()
+{
+    if (m_busBlock.isEmpty()) {
+        return;
+    }
+    m_busWriter.publish(m_busBlock.first().timestampMs, quint32(m_busBlock.size()), 1, 0, 0,
+                        m_busBlock.constData(), quint64(m_busBlock.size()) * sizeof(SharedBus::Sample));
+    m_busBlock.clear();
 }
@@ -0,0 +1,120 @@
+#include "SensorDataset.h"
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+// Generations are unique across datasets, so a holder can tell "the same
+// rows with more appended" from "different rows" by comparing them.
+quint64 nextGeneration()
+{
+    static std::atomic<quint64> generation{0};
+    return ++generation;
+}
+
+}
+
+SensorDataset::SensorDataset()
+    : m_chunks(std::make_shared<const ChunkTable>())
+    , m_size(0)
+    , m_generation(nextGeneration())
+{
+}
+
+void SensorDataset::clear()
+{
+    // Snapshots keep the old chunks alive; the dataset starts new ones.
+    m_chunks = std::make_shared<const ChunkTable>();
+    m_size = 0;
+    m_generation = nextGeneration();
+}
+
+void SensorDataset::append(const SensorReading &reading)
+{
+    if ((m_size & (ChunkSize - 1)) == 0) {
+        // Only the table of chunk pointers is copied, once per chunk; the
+        // readings already published stay where they are.
+        auto chunks = std::make_shared<ChunkTable>(*m_chunks);
+        chunks->append(std::make_shared<Chunk>());
+        m_chunks = std::move(chunks);
+    }
+
+    // The slot is past the end of every existing snapshot, so nothing can
+    // be reading it.
+    m_chunks->last()->readings[m_size & (ChunkSize - 1)] = reading;
+    m_size++;
+}
+
+SensorDataset::Snapshot SensorDataset::snapshot() const
+{
+    Snapshot snapshot;
+    snapshot.m_chunks = m_chunks;
+    snapshot.m_size = m_size;
+    snapshot.m_generation = m_generation;
+    return snapshot;
+}
+
+int SensorDataset::Snapshot::lowerBound(qint64 timestampMs) const
+{
+    int low = 0;
+    int high = m_size;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (at(middle).timestampMs < timestampMs) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+int SensorDataset::Snapshot::upperBound(qint64 timestampMs) const
+{
+    int low = 0;
+    int high = m_size;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (at(middle).timestampMs <= timestampMs) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+QList<SensorReading> SensorDataset::Snapshot::mid(int first, int end) const
+{
+    QList<SensorReading> result;
+    first = qMax(0, first);
+    end = qMin(end, m_size);
+    if (end > first) {
+        result.reserve(end - first);
+    }
+    for (int i = first; i < end; ++i) {
+        result.append(at(i));
+    }
+    return result;
+}
+
+void SensorDataset::Snapshot::copyColumns(int first, int end, qint64 *timestamps, double *temperatures,
+                                          double *pressures) const
+{
+    // Walk chunk by chunk so the inner loop is over one contiguous array.
+    for (int i = first; i < end;) {
+        const Chunk &chunk = *(*m_chunks)[i >> ChunkShift];
+        int offset = i & (ChunkSize - 1);
+        int n = std::min(end - i, ChunkSize - offset);
+        for (int k = 0; k < n; ++k) {
+            const SensorReading &reading = chunk.readings[offset + k];
+            timestamps[k] = reading.timestampMs;
+            temperatures[k] = reading.temperature;
+            pressures[k] = reading.pressure;
+        }
+        timestamps += n;
+        temperatures += n;
+        pressures += n;
+        i += n;
+    }
+}
@@ -0,0 +1,179 @@
+#include "SensorSampleModel.h"
+#include <QGuiApplication>
+#include <QScreen>
+#include <QDebug>
+#include <algorithm>
+
+static const int DefaultCapacity = 600;
+
+SensorSampleModel::SensorSampleModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , m_capacity(DefaultCapacity)
+    , m_head(0)
+    , m_count(0)
+    , m_latest{0, 0.0, 0.0}
+    , m_commitTimer(new QTimer(this))
+    , m_samplesReceived(0)
+    , m_samplesDiscarded(0)
+    , m_commits(0)
+    , m_largestBatch(0)
+{
+    m_ring.resize(m_capacity);
+    m_commitTimer->setSingleShot(true);
+    m_commitTimer->setInterval(displayIntervalMs());
+    connect(m_commitTimer, &QTimer::timeout, this, &SensorSampleModel::commit);
+}
+
+int SensorSampleModel::displayIntervalMs()
+{
+    // Headless runs have no screen; fall back to 60 Hz.
+    auto *application = qobject_cast<QGuiApplication *>(QCoreApplication::instance());
+    QScreen *screen = application ? application->primaryScreen() : nullptr;
+    double refreshRate = screen ? screen->refreshRate() : 60.0;
+    if (refreshRate <= 0) {
+        refreshRate = 60.0;
+    }
+    return std::clamp(int(1000.0 / refreshRate), 4, 100);
+}
+
+int SensorSampleModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_count;
+}
+
+QVariant SensorSampleModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_count) {
+        return QVariant();
+    }
+
+    const Sample &sample = at(index.row());
+    switch (role) {
+    case TimestampMsRole:
+        return sample.timestampMs;
+    case TemperatureRole:
+    case Qt::DisplayRole:
+        return sample.temperature;
+    case PressureRole:
+        return sample.pressure;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> SensorSampleModel::roleNames() const
+{
+    return {
+        {TimestampMsRole, "timestampMs"},
+        {TemperatureRole, "temperature"},
+        {PressureRole, "pressure"}
+    };
+}
+
+void SensorSampleModel::setCapacity(int capacity)
+{
+    capacity = std::max(capacity, 1);
+    if (capacity == m_capacity) {
+        return;
+    }
+
+    commit();
+    beginResetModel();
+    QVector<Sample> ring(capacity);
+    int keep = std::min(m_count, capacity);
+    for (int i = 0; i < keep; ++i) {
+        ring[i] = at(m_count - keep + i);
+    }
+    m_ring = ring;
+    m_capacity = capacity;
+    m_head = 0;
+    m_count = keep;
+    endResetModel();
+
+    emit capacityChanged();
+    emit countChanged();
+}
+
+void SensorSampleModel::addSample(qint64 timestampMs, double temperature, double pressure)
+{
+    m_pending.append({timestampMs, temperature, pressure});
+    m_samplesReceived++;
+    if (!m_commitTimer->isActive()) {
+        m_commitTimer->start();
+    }
+}
+
+void SensorSampleModel::commit()
+{
+    m_commitTimer->stop();
+    if (m_pending.isEmpty()) {
+        return;
+    }
+
+    // Samples that would be pushed out within this batch never reach QML.
+    int batchStart = std::max(0, int(m_pending.size()) - m_capacity);
+    int batch = m_pending.size() - batchStart;
+    m_samplesDiscarded += batchStart;
+
+    int overflow = m_count + batch - m_capacity;
+    if (overflow > 0) {
+        beginRemoveRows(QModelIndex(), 0, overflow - 1);
+        m_head = (m_head + overflow) % m_capacity;
+        m_count -= overflow;
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), m_count, m_count + batch - 1);
+    for (int i = batchStart; i < m_pending.size(); ++i) {
+        m_ring[(m_head + m_count) % m_capacity] = m_pending.at(i);
+        m_count++;
+    }
+    endInsertRows();
+
+    m_latest = m_pending.constLast();
+    m_pending.clear();
+    m_commits++;
+    m_largestBatch = std::max(m_largestBatch, batch);
+
+    if (overflow != batch) {
+        emit countChanged();
+    }
+    emit latestChanged();
+}
+
+QVariantList SensorSampleModel::values(const QString &role, int maxPoints) const
+{
+    bool pressure = role == "pressure";
+    int count = maxPoints > 0 ? std::min(maxPoints, m_count) : m_count;
+
+    QVariantList result;
+    result.reserve(count);
+    for (int row = m_count - count; row < m_count; ++row) {
+        const Sample &sample = at(row);
+        result.append(pressure ? sample.pressure : sample.temperature);
+    }
+    return result;
+}
+
+void SensorSampleModel::clear()
+{
+    m_commitTimer->stop();
+    m_pending.clear();
+    beginResetModel();
+    m_head = 0;
+    m_count = 0;
+    endResetModel();
+    emit countChanged();
+}
+
+QVariantMap SensorSampleModel::metrics() const
+{
+    QVariantMap result;
+    result["samplesReceived"] = m_samplesReceived;
+    result["samplesDiscarded"] = m_samplesDiscarded;
+    result["commits"] = m_commits;
+    result["largestBatch"] = m_largestBatch;
+    result["averageBatch"] = m_commits > 0 ? double(m_samplesReceived - m_samplesDiscarded) / m_commits : 0.0;
+    result["commitIntervalMs"] = commitIntervalMs();
+    return result;
+}
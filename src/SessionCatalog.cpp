@@ -0,0 +1,479 @@
+#include "SessionCatalog.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <algorithm>
+
+static const int CheckpointIntervalMs = 30000;
+
+SessionCatalog::SessionCatalog(QObject *parent)
+    : QObject(parent)
+    , m_journalLines(0)
+    , m_checkpointTimer(new QTimer(this))
+    , m_pendingScans(0)
+{
+    m_pool.setMaxThreadCount(1);
+    m_checkpointTimer->setInterval(CheckpointIntervalMs);
+    connect(m_checkpointTimer, &QTimer::timeout, this, &SessionCatalog::checkpoint);
+}
+
+SessionCatalog::~SessionCatalog()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+    checkpoint();
+}
+
+QString SessionCatalog::journalPath() const
+{
+    return m_dataDirectory + "/sessions.catalog";
+}
+
+QString SessionCatalog::key(const QString &logFile) const
+{
+    return QDir::cleanPath(QFileInfo(logFile).absoluteFilePath());
+}
+
+QString SessionCatalog::storedName(const QString &logFile) const
+{
+    // Sessions in the data directory are stored by name, so the directory
+    // can be moved with its catalog.
+    QFileInfo info(logFile);
+    return info.absolutePath() == m_dataDirectory ? info.fileName() : info.absoluteFilePath();
+}
+
+bool SessionCatalog::open(const QString &dataDirectory, QString *errorMessage)
+{
+    m_dataDirectory = QDir::cleanPath(QFileInfo(dataDirectory).absoluteFilePath());
+    m_sessions.clear();
+    m_journalLines = 0;
+
+    bool existed = QFile::exists(journalPath());
+    if (existed) {
+        replayJournal();
+    }
+
+    m_journal.setFileName(journalPath());
+    if (!m_journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        if (errorMessage) {
+            *errorMessage = "Cannot open session catalog: " + journalPath() + ". Error: " + m_journal.errorString();
+        }
+        return false;
+    }
+    if (m_journalLines > 2 * m_sessions.size() + 64) {
+        compactJournal();
+    }
+
+    if (existed) {
+        reconcile();
+    } else {
+        // First run with a catalog: list the directory once to pick up
+        // sessions recorded before it existed.
+        QStringList logFiles;
+        const QFileInfoList entries = QDir(m_dataDirectory).entryInfoList(QStringList() << "sensor_log_*.csv", QDir::Files);
+        for (const QFileInfo &entry : entries) {
+            logFiles.append(entry.absoluteFilePath());
+        }
+        qDebug() << "Building session catalog from" << logFiles.size() << "logs in" << m_dataDirectory;
+        scanInBackground(logFiles);
+    }
+
+    qDebug() << "Session catalog has" << m_sessions.size() << "sessions";
+    return true;
+}
+
+void SessionCatalog::replayJournal()
+{
+    QFile file(journalPath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Cannot read session catalog:" << file.errorString();
+        return;
+    }
+
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        m_journalLines++;
+
+        // A torn last line from a crash is simply skipped.
+        QJsonObject entry = QJsonDocument::fromJson(line).object();
+        QString name = entry.value("log").toString();
+        if (name.isEmpty()) {
+            continue;
+        }
+        QString logFile = QFileInfo(name).isAbsolute() ? name : m_dataDirectory + "/" + name;
+        QString sessionKey = key(logFile);
+
+        if (entry.value("removed").toBool()) {
+            m_sessions.remove(sessionKey);
+            continue;
+        }
+
+        SessionInfo info;
+        info.logFile = sessionKey;
+        info.startMs = entry.value("start").toInteger(-1);
+        info.endMs = entry.value("end").toInteger(-1);
+        info.rows = entry.value("rows").toInteger();
+        info.frames = entry.value("frames").toInteger();
+        info.sizeBytes = entry.value("size").toInteger();
+        info.frameDirectory = entry.value("frameDir").toString();
+        info.recording = entry.value("recording").toBool();
+        if (!info.frameDirectory.isEmpty() && !QFileInfo(info.frameDirectory).isAbsolute()) {
+            info.frameDirectory = m_dataDirectory + "/" + info.frameDirectory;
+        }
+        m_sessions.insert(sessionKey, info);
+    }
+}
+
+QByteArray SessionCatalog::journalLine(const SessionInfo &info, bool removed) const
+{
+    QJsonObject entry;
+    entry["log"] = storedName(info.logFile);
+    if (removed) {
+        entry["removed"] = true;
+    } else {
+        entry["start"] = info.startMs;
+        entry["end"] = info.endMs;
+        entry["rows"] = info.rows;
+        entry["frames"] = info.frames;
+        entry["size"] = info.sizeBytes;
+        if (!info.frameDirectory.isEmpty()) {
+            entry["frameDir"] = info.frameDirectory == m_dataDirectory ? QString(".") : info.frameDirectory;
+        }
+        if (info.recording) {
+            entry["recording"] = true;
+        }
+    }
+    return QJsonDocument(entry).toJson(QJsonDocument::Compact) + '\n';
+}
+
+void SessionCatalog::appendJournal(const SessionInfo &info, bool removed)
+{
+    if (!m_journal.isOpen()) {
+        return;
+    }
+
+    QByteArray line = journalLine(info, removed);
+    if (m_journal.write(line) != line.size() || !m_journal.flush()) {
+        emit error("Cannot update session catalog: " + m_journal.errorString());
+        return;
+    }
+    m_journalLines++;
+}
+
+void SessionCatalog::compactJournal()
+{
+    QSaveFile file(journalPath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+
+    m_journal.close();
+    QByteArray data;
+    for (const SessionInfo &info : std::as_const(m_sessions)) {
+        data += journalLine(info, false);
+    }
+    file.write(data);
+    if (file.commit()) {
+        qDebug() << "Compacted session catalog from" << m_journalLines << "to" << m_sessions.size() << "entries";
+        m_journalLines = m_sessions.size();
+    }
+    m_journal.open(QIODevice::WriteOnly | QIODevice::Append);
+}
+
+void SessionCatalog::reconcile()
+{
+    // One stat per session (not per frame) finds logs that were removed or
+    // that changed since they were catalogued, e.g. by a run that crashed.
+    QStringList stale;
+    QStringList removed;
+    for (auto it = m_sessions.begin(); it != m_sessions.end(); ++it) {
+        QFileInfo info(it.key());
+        if (!info.exists()) {
+            removed.append(it.key());
+        } else if (info.size() != it->sizeBytes || it->recording) {
+            stale.append(it.key());
+        }
+    }
+
+    for (const QString &logFile : std::as_const(removed)) {
+        appendJournal(m_sessions.take(logFile), true);
+    }
+    if (!removed.isEmpty()) {
+        qDebug() << "Removed" << removed.size() << "missing sessions from the catalog";
+        emit sessionsChanged();
+    }
+    scanInBackground(stale);
+}
+
+void SessionCatalog::rescan()
+{
+    QStringList logFiles;
+    const QFileInfoList entries = QDir(m_dataDirectory).entryInfoList(QStringList() << "sensor_log_*.csv", QDir::Files);
+    for (const QFileInfo &entry : entries) {
+        QString sessionKey = key(entry.absoluteFilePath());
+        auto it = m_sessions.constFind(sessionKey);
+        if (it == m_sessions.constEnd() || (!it->recording && it->sizeBytes != entry.size())) {
+            logFiles.append(sessionKey);
+        }
+    }
+    reconcile();
+    scanInBackground(logFiles);
+}
+
+void SessionCatalog::scanInBackground(const QStringList &logFiles)
+{
+    if (logFiles.isEmpty()) {
+        return;
+    }
+
+    bool wasScanning = isScanning();
+    m_pendingScans += logFiles.size();
+    if (!wasScanning) {
+        emit scanningChanged();
+    }
+
+    for (const QString &logFile : logFiles) {
+        m_pool.start([this, logFile]() {
+            SessionInfo info;
+            bool ok = scanLogFile(logFile, info);
+            QMetaObject::invokeMethod(this, [this, info, ok]() mutable {
+                m_pendingScans--;
+                if (ok) {
+                    auto it = m_sessions.constFind(info.logFile);
+                    if (it != m_sessions.constEnd()) {
+                        if (it->recording && m_dirty.contains(info.logFile)) {
+                            // Being recorded by this process; its own counts are current.
+                            ok = false;
+                        }
+                        info.frameDirectory = it->frameDirectory;
+                    }
+                }
+                if (ok) {
+                    m_sessions.insert(info.logFile, info);
+                    appendJournal(info);
+                    emit sessionsChanged();
+                }
+                if (m_pendingScans == 0) {
+                    emit scanningChanged();
+                }
+            }, Qt::QueuedConnection);
+        });
+    }
+}
+
+bool SessionCatalog::scanLogFile(const QString &logFile, SessionInfo &info)
+{
+    QFile file(logFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QByteArray header = file.readLine();
+    if (!header.contains("Timestamp") || !header.contains("Temperature")) {
+        return false;
+    }
+
+    info = SessionInfo();
+    info.logFile = QDir::cleanPath(QFileInfo(logFile).absoluteFilePath());
+    QByteArray firstLine;
+    QByteArray lastLine;
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        info.rows++;
+        if (firstLine.isEmpty()) {
+            firstLine = line;
+        }
+        // The frame column is only filled on the row after a frame was saved.
+        int frameColumn = line.lastIndexOf(',');
+        if (line.count(',') >= 3 && frameColumn + 1 < line.size()) {
+            info.frames++;
+        }
+        lastLine = line;
+    }
+    info.sizeBytes = file.size();
+
+    auto timestampOf = [](const QByteArray &line) {
+        QDateTime timestamp = QDateTime::fromString(QString::fromUtf8(line.left(line.indexOf(','))), Qt::ISODate);
+        return timestamp.isValid() ? timestamp.toMSecsSinceEpoch() : qint64(-1);
+    };
+    info.startMs = timestampOf(firstLine);
+    info.endMs = timestampOf(lastLine);
+    return true;
+}
+
+bool SessionCatalog::session(const QString &logFile, SessionInfo &info) const
+{
+    auto it = m_sessions.constFind(key(logFile));
+    if (it == m_sessions.constEnd()) {
+        return false;
+    }
+    info = it.value();
+    return true;
+}
+
+QVariantList SessionCatalog::sessions() const
+{
+    QList<const SessionInfo *> ordered;
+    ordered.reserve(m_sessions.size());
+    for (const SessionInfo &info : m_sessions) {
+        ordered.append(&info);
+    }
+    std::sort(ordered.begin(), ordered.end(), [](const SessionInfo *a, const SessionInfo *b) {
+        return a->startMs != b->startMs ? a->startMs > b->startMs : a->logFile > b->logFile;
+    });
+
+    QVariantList result;
+    result.reserve(ordered.size());
+    for (const SessionInfo *info : std::as_const(ordered)) {
+        QVariantMap entry;
+        entry["logFile"] = info->logFile;
+        entry["name"] = QFileInfo(info->logFile).fileName();
+        entry["startMs"] = info->startMs;
+        entry["endMs"] = info->endMs;
+        entry["start"] = info->startMs >= 0 ? QDateTime::fromMSecsSinceEpoch(info->startMs) : QDateTime();
+        entry["durationMs"] = info->startMs >= 0 && info->endMs >= info->startMs ? info->endMs - info->startMs : 0;
+        entry["rows"] = info->rows;
+        entry["frames"] = info->frames;
+        entry["sizeBytes"] = info->sizeBytes;
+        entry["recording"] = info->recording;
+        result.append(entry);
+    }
+    return result;
+}
+
+void SessionCatalog::beginSession(const QString &logFile)
+{
+    SessionInfo info;
+    info.logFile = key(logFile);
+    info.frameDirectory = m_dataDirectory;
+    info.recording = true;
+    m_sessions.insert(info.logFile, info);
+    m_dirty.insert(info.logFile);
+    appendJournal(info);
+    m_checkpointTimer->start();
+    emit sessionsChanged();
+}
+
+void SessionCatalog::addRows(const QString &logFile, int rows, qint64 firstMs, qint64 lastMs)
+{
+    auto it = m_sessions.find(key(logFile));
+    if (it == m_sessions.end()) {
+        return;
+    }
+    it->rows += rows;
+    if (it->startMs < 0) {
+        it->startMs = firstMs;
+    }
+    it->endMs = std::max(it->endMs, lastMs);
+    m_dirty.insert(it.key());
+}
+
+void SessionCatalog::addFrame(const QString &logFile, qint64 timestampMs)
+{
+    auto it = m_sessions.find(key(logFile));
+    if (it == m_sessions.end()) {
+        return;
+    }
+    it->frames++;
+    it->endMs = std::max(it->endMs, timestampMs);
+    m_dirty.insert(it.key());
+}
+
+void SessionCatalog::endSession(const QString &logFile, qint64 sizeBytes)
+{
+    auto it = m_sessions.find(key(logFile));
+    if (it == m_sessions.end()) {
+        return;
+    }
+    it->recording = false;
+    it->sizeBytes = sizeBytes;
+    m_dirty.remove(it.key());
+    appendJournal(it.value());
+    if (m_dirty.isEmpty()) {
+        m_checkpointTimer->stop();
+    }
+    emit sessionsChanged();
+}
+
+void SessionCatalog::checkpoint()
+{
+    if (m_dirty.isEmpty()) {
+        return;
+    }
+    for (const QString &sessionKey : std::as_const(m_dirty)) {
+        auto it = m_sessions.constFind(sessionKey);
+        if (it != m_sessions.constEnd()) {
+            appendJournal(it.value());
+        }
+    }
+    emit sessionsChanged();
+}
+
+void SessionCatalog::updateSession(const SessionInfo &info)
+{
+    SessionInfo updated = info;
+    updated.logFile = key(info.logFile);
+    auto it = m_sessions.constFind(updated.logFile);
+    if (it != m_sessions.constEnd()) {
+        if (it->recording) {
+            return;
+        }
+        if (updated.frameDirectory.isEmpty()) {
+            updated.frameDirectory = it->frameDirectory;
+        }
+        if (it->rows == updated.rows && it->frames == updated.frames && it->sizeBytes == updated.sizeBytes
+            && it->startMs == updated.startMs && it->endMs == updated.endMs
+            && it->frameDirectory == updated.frameDirectory) {
+            return;
+        }
+    }
+    m_sessions.insert(updated.logFile, updated);
+    appendJournal(updated);
+    emit sessionsChanged();
+}
+
+void SessionCatalog::setActiveSession(const QString &logFile, const FrameIndex &frames)
+{
+    QString sessionKey = key(logFile);
+    auto it = m_sessions.find(sessionKey);
+    QString directory = it != m_sessions.end() ? it->frameDirectory : QString();
+
+    if (directory.isEmpty() && !frames.isEmpty()) {
+        // Probe once per session, not once per frame change: frames are
+        // where they were recorded, or next to the log if it was moved.
+        QString recorded = frames.at(0).filename;
+        QString logDirectory = QFileInfo(sessionKey).absolutePath();
+        if (QFileInfo(recorded).isAbsolute() && QFileInfo::exists(recorded)) {
+            directory = QFileInfo(recorded).absolutePath();
+        } else if (QFileInfo::exists(logDirectory + "/" + recorded)) {
+            directory = QFileInfo(logDirectory + "/" + recorded).absolutePath();
+        } else {
+            directory = logDirectory;
+        }
+        if (it != m_sessions.end()) {
+            it->frameDirectory = directory;
+            appendJournal(it.value());
+        }
+    }
+
+    m_activeFrameDirectory = directory;
+}
+
+QString SessionCatalog::resolveFrame(const QString &frameFilename) const
+{
+    if (m_activeFrameDirectory.isEmpty()) {
+        return QFileInfo(frameFilename).isAbsolute() ? frameFilename : m_dataDirectory + "/" + frameFilename;
+    }
+    int separator = std::max(frameFilename.lastIndexOf('/'), frameFilename.lastIndexOf('\\'));
+    return m_activeFrameDirectory + "/" + frameFilename.mid(separator + 1);
+}
@@ -0,0 +1,317 @@
+#include "SessionComparison.h"
+#include "DataLogger.h"
+#include <QDebug>
+#include <QFileInfo>
+#include <QPointF>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Two doubles per point per session; a 24 h session on a 50 ms grid fits.
+constexpr qint64 MaxAlignedPoints = 2 * 1000 * 1000;
+
+}
+
+SessionComparison::SessionComparison(QObject *parent)
+    : QObject(parent)
+    , m_intervalMs(1000)
+    , m_method(ResampleMethod::Linear)
+    , m_pending(0)
+    , m_request(0)
+{
+}
+
+SessionComparison::~SessionComparison()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+bool SessionComparison::load(const QStringList &logFiles, int intervalMs, const QString &method)
+{
+    if (logFiles.isEmpty()) {
+        emit error("Select at least one session to compare");
+        return false;
+    }
+    ResampleMethod resampleMethod;
+    if (!Resampler::parseMethod(method, resampleMethod)) {
+        emit error("Unknown resampling method: " + method + " (use linear, previous or mean)");
+        return false;
+    }
+
+    bool wasLoading = isLoading();
+    quint64 request = ++m_request;
+    m_intervalMs = intervalMs > 0 ? intervalMs : 1000;
+    m_method = resampleMethod;
+    m_sessions = QVector<ComparedSession>(logFiles.size());
+    m_pending = logFiles.size();
+    m_loadTimer.start();
+
+    // One task per session; results are applied on this thread in whatever
+    // order they finish, and a newer load() discards older results.
+    for (int i = 0; i < logFiles.size(); ++i) {
+        QString logFile = logFiles[i];
+        int sessionIntervalMs = m_intervalMs;
+        m_pool.start([this, request, i, logFile, sessionIntervalMs, resampleMethod]() {
+            ComparedSession session = loadSession(logFile, sessionIntervalMs, resampleMethod);
+            QMetaObject::invokeMethod(this, [this, request, i, session]() {
+                if (request != m_request) {
+                    return;
+                }
+                m_sessions[i] = session;
+                if (!session.error.isEmpty()) {
+                    emit error(session.name + ": " + session.error);
+                }
+                if (--m_pending > 0) {
+                    return;
+                }
+
+                qint64 sumMs = 0;
+                for (const ComparedSession &loaded : m_sessions) {
+                    sumMs += loaded.loadMs;
+                }
+                qDebug() << "SessionComparison: loaded" << m_sessions.size() << "sessions in"
+                         << m_loadTimer.elapsed() << "ms (" << sumMs << "ms if loaded one after another)";
+                emit loadingChanged();
+                emit sessionsChanged();
+            }, Qt::QueuedConnection);
+        });
+    }
+
+    if (!wasLoading) {
+        emit loadingChanged();
+    }
+    emit sessionsChanged();
+    return true;
+}
+
+void SessionComparison::clear()
+{
+    bool wasLoading = isLoading();
+    m_request++;
+    m_pending = 0;
+    m_sessions.clear();
+    if (wasLoading) {
+        emit loadingChanged();
+    }
+    emit sessionsChanged();
+}
+
+ComparedSession SessionComparison::loadSession(const QString &logFile, int intervalMs, ResampleMethod method)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    ComparedSession session;
+    session.logFile = QFileInfo(logFile).absoluteFilePath();
+    session.name = QFileInfo(logFile).completeBaseName();
+
+    SensorDataset dataset;
+    if (!DataLogger::readLogFile(logFile, dataset, &session.error)) {
+        session.loadMs = timer.elapsed();
+        return session;
+    }
+
+    SensorDataset::Snapshot readings = dataset.snapshot();
+    for (const SensorReading &reading : readings) {
+        session.temperature.add(reading.temperature);
+        session.pressure.add(reading.pressure);
+    }
+    session.rows = readings.size();
+    session.startMs = readings.first().timestampMs;
+    session.durationMs = readings.last().timestampMs - session.startMs;
+
+    qint64 count = session.durationMs / intervalMs + 1;
+    if (count > MaxAlignedPoints) {
+        session.error = QString("%1 ms is too fine a grid for a session this long").arg(intervalMs);
+        session.loadMs = timer.elapsed();
+        return session;
+    }
+
+    // The grid starts at the session's own first reading, which is what
+    // puts every session on the same time-since-start axis.
+    int rows = readings.size();
+    QVector<qint64> timestamps(rows);
+    QVector<double> temperatures(rows);
+    QVector<double> pressures(rows);
+    readings.copyColumns(0, rows, timestamps.data(), temperatures.data(), pressures.data());
+
+    session.alignedTemperature.resize(int(count));
+    session.alignedPressure.resize(int(count));
+    const double *columns[] = {temperatures.constData(), pressures.constData()};
+    double *outputs[] = {session.alignedTemperature.data(), session.alignedPressure.data()};
+    Resampler::resample(method, timestamps.constData(), columns, rows, 2, session.startMs, intervalMs,
+                        int(count), outputs);
+
+    session.loadMs = timer.elapsed();
+    return session;
+}
+
+qint64 SessionComparison::durationMs() const
+{
+    qint64 duration = 0;
+    for (const ComparedSession &session : m_sessions) {
+        duration = std::max(duration, session.durationMs);
+    }
+    return duration;
+}
+
+QVariantList SessionComparison::sessions() const
+{
+    QVariantList result;
+    for (const ComparedSession &session : m_sessions) {
+        RollupBucket summary;
+        summary.startMs = session.startMs;
+        summary.temperature = session.temperature;
+        summary.pressure = session.pressure;
+
+        QVariantMap entry = RollupStore::toVariantMap(summary);
+        entry["logFile"] = session.logFile;
+        entry["name"] = session.name;
+        entry["rows"] = session.rows;
+        entry["durationMs"] = session.durationMs;
+        entry["loadMs"] = session.loadMs;
+        entry["loaded"] = !session.alignedTemperature.isEmpty();
+        entry["error"] = session.error;
+        result.append(entry);
+    }
+    return result;
+}
+
+const QVector<double> *SessionComparison::column(int session, const QString &role) const
+{
+    if (session < 0 || session >= m_sessions.size()) {
+        return nullptr;
+    }
+    if (role == "temperature") {
+        return &m_sessions[session].alignedTemperature;
+    }
+    if (role == "pressure") {
+        return &m_sessions[session].alignedPressure;
+    }
+    return nullptr;
+}
+
+QVariantList SessionComparison::decimate(const QVector<double> &values, int intervalMs, int maxPoints)
+{
+    // Each returned point is the mean of its stretch of the grid, at the
+    // stretch's start, in seconds since the session began. Grid points with
+    // no value (NaN, e.g. empty mean buckets) are left out.
+    QVariantList result;
+    if (values.isEmpty()) {
+        return result;
+    }
+
+    int stride = std::max(1, int((values.size() + maxPoints - 1) / std::max(1, maxPoints)));
+    result.reserve(values.size() / stride + 1);
+    for (int first = 0; first < values.size(); first += stride) {
+        int end = std::min(int(values.size()), first + stride);
+        double sum = 0.0;
+        int count = 0;
+        for (int i = first; i < end; ++i) {
+            if (!std::isnan(values[i])) {
+                sum += values[i];
+                count++;
+            }
+        }
+        if (count > 0) {
+            result.append(QPointF(double(first) * intervalMs / 1000.0, sum / count));
+        }
+    }
+    return result;
+}
+
+QVariantList SessionComparison::series(int session, const QString &role, int maxPoints) const
+{
+    const QVector<double> *values = column(session, role);
+    return values ? decimate(*values, m_intervalMs, maxPoints) : QVariantList();
+}
+
+QVariantList SessionComparison::meanSeries(const QString &role, int maxPoints) const
+{
+    int length = 0;
+    for (int s = 0; s < m_sessions.size(); ++s) {
+        if (const QVector<double> *values = column(s, role)) {
+            length = std::max(length, int(values->size()));
+        }
+    }
+
+    QVector<double> sums(length, 0.0);
+    QVector<int> counts(length, 0);
+    for (int s = 0; s < m_sessions.size(); ++s) {
+        const QVector<double> *values = column(s, role);
+        if (!values) {
+            continue;
+        }
+        for (int i = 0; i < values->size(); ++i) {
+            if (!std::isnan((*values)[i])) {
+                sums[i] += (*values)[i];
+                counts[i]++;
+            }
+        }
+    }
+    for (int i = 0; i < length; ++i) {
+        sums[i] = counts[i] > 0 ? sums[i] / counts[i] : std::numeric_limits<double>::quiet_NaN();
+    }
+    return decimate(sums, m_intervalMs, maxPoints);
+}
+
+QVariantMap SessionComparison::statistics() const
+{
+    // Pooled over every reading of every session, plus how far apart the
+    // sessions are at the same time since start.
+    RollupBucket pooled;
+    int loaded = 0;
+    int overlap = -1;
+    for (const ComparedSession &session : m_sessions) {
+        if (session.alignedTemperature.isEmpty()) {
+            continue;
+        }
+        loaded++;
+        pooled.temperature.merge(session.temperature);
+        pooled.pressure.merge(session.pressure);
+        overlap = overlap < 0 ? session.alignedTemperature.size()
+                              : std::min(overlap, int(session.alignedTemperature.size()));
+    }
+
+    QVariantMap result = RollupStore::toVariantMap(pooled);
+    result.remove("startTime");
+    result["sessions"] = m_sessions.size();
+    result["loadedSessions"] = loaded;
+    result["intervalMs"] = m_intervalMs;
+    result["method"] = method();
+    result["durationMs"] = durationMs();
+    result["overlapMs"] = overlap > 0 ? qint64(overlap - 1) * m_intervalMs : 0;
+
+    for (const QString &role : {QStringLiteral("temperature"), QStringLiteral("pressure")}) {
+        double spreadSum = 0.0;
+        double spreadMax = 0.0;
+        int spreadPoints = 0;
+        for (int i = 0; loaded > 1 && i < overlap; ++i) {
+            double low = 0.0;
+            double high = 0.0;
+            int present = 0;
+            for (int s = 0; s < m_sessions.size(); ++s) {
+                const QVector<double> *values = column(s, role);
+                if (values->isEmpty() || std::isnan((*values)[i])) {
+                    continue;
+                }
+                double value = (*values)[i];
+                low = present == 0 ? value : std::min(low, value);
+                high = present == 0 ? value : std::max(high, value);
+                present++;
+            }
+            if (present < 2) {
+                continue;
+            }
+            spreadSum += high - low;
+            spreadMax = std::max(spreadMax, high - low);
+            spreadPoints++;
+        }
+        result[role + "MeanSpread"] = spreadPoints > 0 ? spreadSum / spreadPoints : 0.0;
+        result[role + "MaxSpread"] = spreadMax;
+    }
+    return result;
+}
@@ -0,0 +1,218 @@
+#include "SharedBusReader.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace SharedBus;
+
+static uint64_t nowMs()
+{
+    using namespace std::chrono;
+    return uint64_t(duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count());
+}
+
+SharedBusReader::~SharedBusReader()
+{
+    close();
+}
+
+bool SharedBusReader::open(const std::string &bus, const std::string &stream,
+                           StartPosition start, std::string *errorMessage)
+{
+    close();
+
+    auto fail = [errorMessage](const std::string &message) {
+        if (errorMessage) {
+            *errorMessage = message;
+        }
+        return false;
+    };
+
+    std::string name = segmentName(bus, stream);
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        return fail("Cannot open shared memory " + name + ": " + std::strerror(errno));
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || std::size_t(info.st_size) < sizeof(Header)) {
+        ::close(fd);
+        return fail("Shared memory " + name + " is not a bus segment");
+    }
+
+    std::size_t size = std::size_t(info.st_size);
+    void *segment = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (segment == MAP_FAILED) {
+        return fail("Cannot map shared memory " + name + ": " + std::strerror(errno));
+    }
+
+    auto *header = static_cast<Header *>(segment);
+    uint32_t magic = header->magic;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (magic != Magic || header->version != Version
+        || header->slotsOffset + header->slotStride * header->slotCount > size) {
+        munmap(segment, size);
+        return fail("Shared memory " + name + " has an unsupported layout");
+    }
+
+    // Readers register so the writer can track their lag.
+    ReaderEntry *entry = nullptr;
+    uint32_t pid = uint32_t(getpid());
+    for (ReaderEntry &candidate : header->readers) {
+        uint32_t expected = 0;
+        if (candidate.pid.compare_exchange_strong(expected, pid)) {
+            entry = &candidate;
+            break;
+        }
+    }
+    if (!entry) {
+        munmap(segment, size);
+        return fail("Shared memory " + name + " already has the maximum of " + std::to_string(MaxReaders) + " readers");
+    }
+
+    m_segment = segment;
+    m_segmentSize = size;
+    m_header = header;
+    m_entry = entry;
+    m_lost = 0;
+
+    uint64_t latest = header->writeSeq.load(std::memory_order_acquire);
+    if (start == StartAtOldest) {
+        m_readSeq = latest > header->slotCount ? latest - header->slotCount : 0;
+    } else {
+        m_readSeq = latest;
+    }
+    entry->flags.store(0, std::memory_order_relaxed);
+    acknowledge(m_readSeq);
+    return true;
+}
+
+void SharedBusReader::close()
+{
+    if (!m_header) {
+        return;
+    }
+
+    m_entry->pid.store(0, std::memory_order_release);
+    munmap(m_segment, m_segmentSize);
+    m_segment = nullptr;
+    m_segmentSize = 0;
+    m_header = nullptr;
+    m_entry = nullptr;
+}
+
+bool SharedBusReader::writerAlive() const
+{
+    if (!m_header || m_header->closed.load(std::memory_order_acquire)) {
+        return false;
+    }
+    pid_t pid = pid_t(m_header->writerPid.load(std::memory_order_relaxed));
+    return kill(pid, 0) == 0 || errno != ESRCH;
+}
+
+uint64_t SharedBusReader::latestSeq() const
+{
+    return m_header ? m_header->writeSeq.load(std::memory_order_acquire) : 0;
+}
+
+bool SharedBusReader::isSlow() const
+{
+    return m_entry && (m_entry->flags.load(std::memory_order_relaxed) & ReaderSlow);
+}
+
+void SharedBusReader::skipToLatest()
+{
+    uint64_t latest = latestSeq();
+    if (latest > m_readSeq) {
+        m_lost += latest - m_readSeq;
+        acknowledge(latest);
+    }
+}
+
+void SharedBusReader::acknowledge(uint64_t seq)
+{
+    m_readSeq = seq;
+    m_entry->readSeq.store(seq, std::memory_order_relaxed);
+    m_entry->heartbeatMs.store(nowMs(), std::memory_order_relaxed);
+}
+
+bool SharedBusReader::next(Message &message)
+{
+    if (!m_header) {
+        return false;
+    }
+    m_entry->heartbeatMs.store(nowMs(), std::memory_order_relaxed);
+
+    uint32_t slotCount = m_header->slotCount;
+    for (uint32_t attempt = 0; attempt <= slotCount; ++attempt) {
+        uint64_t latest = m_header->writeSeq.load(std::memory_order_acquire);
+        if (latest <= m_readSeq) {
+            return false;
+        }
+
+        uint64_t wanted = m_readSeq + 1;
+        uint64_t oldest = latest > slotCount ? latest - slotCount + 1 : 1;
+        if (wanted < oldest) {
+            m_lost += oldest - wanted;
+            wanted = oldest;
+            m_entry->flags.fetch_and(~uint32_t(ReaderLapped), std::memory_order_relaxed);
+        }
+
+        SlotHeader *slot = slotAt(m_segment, m_header, wanted);
+        uint64_t before = slot->lock.load(std::memory_order_acquire);
+        if (before != 2 * wanted) {
+            // Overwritten (or being overwritten) since writeSeq was read.
+            m_lost += 1;
+            acknowledge(wanted);
+            continue;
+        }
+
+        message.seq = wanted;
+        message.timestampMs = slot->timestampMs;
+        message.width = slot->width;
+        message.height = slot->height;
+        message.stride = slot->stride;
+        message.format = slot->format;
+        message.size = slot->size;
+        message.data = payload(slot);
+
+        if (!isValid(message) || message.size > m_header->slotSize) {
+            m_lost += 1;
+            acknowledge(wanted);
+            continue;
+        }
+
+        acknowledge(wanted);
+        return true;
+    }
+    return false;
+}
+
+bool SharedBusReader::isValid(const Message &message) const
+{
+    if (!m_header || message.seq == 0) {
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    SlotHeader *slot = slotAt(m_segment, m_header, message.seq);
+    return slot->lock.load(std::memory_order_relaxed) == 2 * message.seq;
+}
+
+bool SharedBusReader::copyNext(std::vector<uint8_t> &buffer, Message &message)
+{
+    while (next(message)) {
+        buffer.assign(message.data, message.data + message.size);
+        if (isValid(message)) {
+            message.data = buffer.data();
+            return true;
+        }
+        m_lost += 1;
+    }
+    return false;
+}
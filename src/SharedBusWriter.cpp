@@ -0,0 +1,283 @@
+#include "SharedBusWriter.h"
+#include <QDebug>
+#include <QRegularExpression>
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace SharedBus;
+
+#ifdef Q_OS_UNIX
+namespace {
+
+// The pid of the process still publishing on an existing segment, or 0 if
+// there is no segment or its writer has closed it or is gone.
+pid_t liveWriterPid(const char *name)
+{
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat info;
+    void *segment = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && quint64(info.st_size) >= sizeof(Header)) {
+        segment = mmap(nullptr, sizeof(Header), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (segment == MAP_FAILED) {
+        return 0;
+    }
+
+    const auto *header = static_cast<const Header *>(segment);
+    pid_t pid = 0;
+    if (header->magic == Magic && header->closed.load(std::memory_order_acquire) == 0) {
+        pid = pid_t(header->writerPid.load(std::memory_order_relaxed));
+    }
+    munmap(segment, sizeof(Header));
+
+    if (pid <= 0 || (kill(pid, 0) != 0 && errno == ESRCH)) {
+        return 0;
+    }
+    return pid;
+}
+
+}
+#endif
+
+SharedBusWriter::SharedBusWriter()
+    : m_segment(nullptr)
+    , m_segmentSize(0)
+    , m_header(nullptr)
+    , m_published(0)
+    , m_oversized(0)
+    , m_slowReaderEvents(0)
+    , m_lappedReaderEvents(0)
+    , m_readersReclaimed(0)
+    , m_readers(0)
+    , m_slowReaders(0)
+    , m_maxLag(0)
+{
+}
+
+SharedBusWriter::~SharedBusWriter()
+{
+    destroy();
+}
+
+bool SharedBusWriter::isValidBusName(const QString &bus)
+{
+    static const QRegularExpression pattern("^[A-Za-z0-9_-]{1,64}$");
+    return pattern.match(bus).hasMatch();
+}
+
+bool SharedBusWriter::create(const QString &bus, const QString &stream, StreamKind kind,
+                             int slotCount, quint64 slotSize, QString *errorMessage)
+{
+    destroy();
+
+#ifdef Q_OS_UNIX
+    QString name = QString::fromStdString(segmentName(bus.toStdString(), stream.toStdString()));
+    QByteArray nativeName = name.toLocal8Bit();
+
+    // A segment left behind by a previous run that crashed is replaced;
+    // readers still mapping it see its writer gone and reopen. One whose
+    // writer is still running belongs to another instance on the same bus.
+    pid_t owner = liveWriterPid(nativeName.constData());
+    if (owner != 0) {
+        if (errorMessage) {
+            *errorMessage = QString("Shared memory %1 is already published by process %2").arg(name).arg(owner);
+        }
+        return false;
+    }
+    shm_unlink(nativeName.constData());
+    int fd = shm_open(nativeName.constData(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        if (errorMessage) {
+            *errorMessage = "Cannot create shared memory " + name + ": " + QString::fromLocal8Bit(strerror(errno));
+        }
+        return false;
+    }
+
+    quint64 slotStride = alignUp(sizeof(SlotHeader)) + alignUp(slotSize);
+    quint64 slotsOffset = alignUp(sizeof(Header));
+    size_t size = size_t(slotsOffset + slotStride * quint64(slotCount));
+
+    void *segment = MAP_FAILED;
+    if (ftruncate(fd, off_t(size)) == 0) {
+        segment = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    int savedErrno = errno;
+    ::close(fd);
+    if (segment == MAP_FAILED) {
+        shm_unlink(nativeName.constData());
+        if (errorMessage) {
+            *errorMessage = "Cannot map shared memory " + name + ": " + QString::fromLocal8Bit(strerror(savedErrno));
+        }
+        return false;
+    }
+
+    // ftruncate zero-fills the segment, which is a valid initial state for
+    // every atomic in it. The magic is stored last so readers never see a
+    // half-initialized header.
+    auto *header = new (segment) Header;
+    header->version = Version;
+    header->kind = kind;
+    header->slotCount = quint32(slotCount);
+    header->slotSize = slotSize;
+    header->slotStride = slotStride;
+    header->slotsOffset = slotsOffset;
+    header->writerPid.store(quint32(getpid()), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = Magic;
+
+    m_name = name;
+    m_segment = segment;
+    m_segmentSize = size;
+    m_header = header;
+    m_livenessTimer.start();
+
+    qDebug() << "Shared memory bus" << name << "created with" << slotCount << "slots of" << slotSize << "bytes";
+    return true;
+#else
+    Q_UNUSED(bus)
+    Q_UNUSED(stream)
+    Q_UNUSED(kind)
+    Q_UNUSED(slotCount)
+    Q_UNUSED(slotSize)
+    if (errorMessage) {
+        *errorMessage = "The shared memory bus needs POSIX shared memory, which this platform does not provide.";
+    }
+    return false;
+#endif
+}
+
+void SharedBusWriter::destroy()
+{
+#ifdef Q_OS_UNIX
+    if (!m_header) {
+        return;
+    }
+
+    m_header->closed.store(1, std::memory_order_release);
+    munmap(m_segment, m_segmentSize);
+    shm_unlink(m_name.toLocal8Bit().constData());
+    qDebug() << "Shared memory bus" << m_name << "closed after" << m_published.load() << "messages";
+#endif
+    m_segment = nullptr;
+    m_segmentSize = 0;
+    m_header = nullptr;
+}
+
+bool SharedBusWriter::publish(qint64 timestampMs, quint32 width, quint32 height, quint32 stride, quint32 format,
+                              const void *data, quint64 size)
+{
+    if (!m_header) {
+        return false;
+    }
+    if (size > m_header->slotSize) {
+        m_oversized++;
+        return false;
+    }
+
+    quint64 seq = m_header->writeSeq.load(std::memory_order_relaxed) + 1;
+    SlotHeader *slot = slotAt(m_segment, m_header, seq);
+
+    slot->lock.store(2 * seq - 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->timestampMs = timestampMs;
+    slot->width = width;
+    slot->height = height;
+    slot->stride = stride;
+    slot->format = format;
+    slot->size = size;
+    std::memcpy(payload(slot), data, size);
+
+    slot->lock.store(2 * seq, std::memory_order_release);
+    m_header->writeSeq.store(seq, std::memory_order_release);
+    m_published++;
+
+    checkReaders(seq);
+    return true;
+}
+
+void SharedBusWriter::checkReaders(quint64 seq)
+{
+    // Slow-reader policy: the writer never blocks. A reader more than half a
+    // ring behind is flagged slow, so it can skip ahead; one that falls a
+    // whole ring behind is flagged lapped and loses the overwritten messages.
+    bool checkLiveness = m_livenessTimer.elapsed() >= 1000;
+    if (checkLiveness) {
+        m_livenessTimer.restart();
+    }
+
+    quint32 slotCount = m_header->slotCount;
+    int readers = 0;
+    int slowReaders = 0;
+    quint64 maxLag = 0;
+    for (ReaderEntry &reader : m_header->readers) {
+        quint32 pid = reader.pid.load(std::memory_order_acquire);
+        if (pid == 0) {
+            continue;
+        }
+#ifdef Q_OS_UNIX
+        if (checkLiveness && kill(pid_t(pid), 0) != 0 && errno == ESRCH) {
+            // The reader process died without unregistering.
+            if (reader.pid.compare_exchange_strong(pid, 0)) {
+                m_readersReclaimed++;
+                qDebug() << "Shared memory bus" << m_name << "reclaimed the entry of exited reader" << pid;
+            }
+            continue;
+        }
+#endif
+        readers++;
+
+        quint64 readSeq = reader.readSeq.load(std::memory_order_relaxed);
+        quint64 lag = seq > readSeq ? seq - readSeq : 0;
+        maxLag = std::max(maxLag, lag);
+
+        quint32 flags = reader.flags.load(std::memory_order_relaxed);
+        if (lag > slotCount / 2) {
+            slowReaders++;
+            if (!(flags & ReaderSlow)) {
+                reader.flags.fetch_or(ReaderSlow, std::memory_order_relaxed);
+                m_slowReaderEvents++;
+                qDebug() << "Shared memory bus" << m_name << "reader" << pid << "is" << lag << "messages behind";
+            }
+        } else if (flags & ReaderSlow) {
+            reader.flags.fetch_and(~quint32(ReaderSlow), std::memory_order_relaxed);
+        }
+        // The reader clears ReaderLapped once it has accounted for the loss.
+        if (lag > slotCount && !(flags & ReaderLapped)) {
+            reader.flags.fetch_or(ReaderLapped, std::memory_order_relaxed);
+            m_lappedReaderEvents++;
+        }
+    }
+
+    m_readers = readers;
+    m_slowReaders = slowReaders;
+    m_maxLag = maxLag;
+}
+
+QVariantMap SharedBusWriter::metrics() const
+{
+    QVariantMap result;
+    result["busPublished"] = m_published.load();
+    result["busOversized"] = m_oversized.load();
+    result["busReaders"] = m_readers.load();
+    result["busSlowReaders"] = m_slowReaders.load();
+    result["busMaxLag"] = m_maxLag.load();
+    result["busSlowReaderEvents"] = m_slowReaderEvents.load();
+    result["busLappedReaderEvents"] = m_lappedReaderEvents.load();
+    result["busReadersReclaimed"] = m_readersReclaimed.load();
+    return result;
+}
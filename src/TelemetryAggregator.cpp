@@ -0,0 +1,262 @@
+#include "TelemetryAggregator.h"
+#include "TelemetryProtocol.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QHostAddress>
+#include <QRegularExpression>
+#include <algorithm>
+
+TelemetryAggregator::TelemetryAggregator(QObject *parent)
+    : QObject(parent)
+    , m_connections(0)
+    , m_rejected(0)
+{
+    connect(&m_server, &QTcpServer::newConnection, this, &TelemetryAggregator::acceptConnections);
+}
+
+TelemetryAggregator::~TelemetryAggregator()
+{
+    close();
+}
+
+bool TelemetryAggregator::listen(const QString &host, quint16 port, const QString &outputDirectory, QString *errorMessage)
+{
+    close();
+    m_outputDirectory = outputDirectory;
+
+    QHostAddress address = host.isEmpty() ? QHostAddress(QHostAddress::LocalHost) : QHostAddress(host);
+    if (!m_server.listen(address, port)) {
+        if (errorMessage) {
+            *errorMessage = "Cannot listen for telemetry on " + address.toString() + ":" + QString::number(port)
+                            + ". Error: " + m_server.errorString();
+        }
+        return false;
+    }
+
+    qDebug() << "Telemetry aggregator listening on" << address.toString() << m_server.serverPort();
+    return true;
+}
+
+void TelemetryAggregator::close()
+{
+    m_server.close();
+    const QList<QTcpSocket *> sockets = m_buffers.keys();
+    for (QTcpSocket *socket : sockets) {
+        socket->disconnect(this);
+        socket->abort();
+        socket->deleteLater();
+    }
+    m_buffers.clear();
+    m_socketStations.clear();
+    for (const std::shared_ptr<Station> &station : std::as_const(m_stations)) {
+        if (station->output) {
+            station->output->flush();
+        }
+    }
+}
+
+void TelemetryAggregator::acceptConnections()
+{
+    while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+        m_connections++;
+        m_buffers.insert(socket, QByteArray());
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { readMessages(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            qDebug() << "Telemetry station disconnected:" << m_socketStations.value(socket);
+            m_buffers.remove(socket);
+            m_socketStations.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void TelemetryAggregator::readMessages(QTcpSocket *socket)
+{
+    QByteArray &buffer = m_buffers[socket];
+    buffer += socket->readAll();
+
+    qsizetype offset = 0;
+    while (buffer.size() - offset >= 5) {
+        QDataStream stream(QByteArray::fromRawData(buffer.constData() + offset, 5));
+        stream.setByteOrder(QDataStream::LittleEndian);
+        quint32 length;
+        quint8 type;
+        stream >> length >> type;
+        if (length < 1 || length > quint32(TelemetryProtocol::MaxMessageBytes)) {
+            m_rejected++;
+            socket->abort();
+            return;
+        }
+        if (buffer.size() - offset < qsizetype(4 + length)) {
+            break;
+        }
+
+        QByteArray payload = buffer.mid(offset + 5, length - 1);
+        offset += 4 + length;
+        if (!handleMessage(socket, type, payload)) {
+            m_rejected++;
+            qDebug() << "Telemetry aggregator dropped a connection after a malformed message";
+            socket->abort();
+            return;
+        }
+    }
+    buffer.remove(0, offset);
+}
+
+bool TelemetryAggregator::handleMessage(QTcpSocket *socket, quint8 type, const QByteArray &payload)
+{
+    QDataStream stream(payload);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    if (type == TelemetryProtocol::Hello) {
+        char magic[4];
+        quint16 version;
+        quint16 length;
+        if (stream.readRawData(magic, 4) != 4 || !std::equal(magic, magic + 4, TelemetryProtocol::Magic)) {
+            return false;
+        }
+        stream >> version >> length;
+        QByteArray id(length, '\0');
+        if (version != TelemetryProtocol::Version || stream.readRawData(id.data(), length) != length || id.isEmpty()) {
+            return false;
+        }
+
+        QString stationId = QString::fromUtf8(id);
+        std::shared_ptr<Station> &station = m_stations[stationId];
+        if (!station) {
+            station = std::make_shared<Station>();
+        }
+        m_socketStations.insert(socket, stationId);
+        qDebug() << "Telemetry station" << stationId << "connected, resuming after batch" << station->lastSeq;
+        send(socket, TelemetryProtocol::Welcome, station->lastSeq);
+        return true;
+    }
+
+    if (type != TelemetryProtocol::Batch || !m_socketStations.contains(socket)) {
+        return false;
+    }
+
+    quint64 seq;
+    stream >> seq;
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    QString stationId = m_socketStations.value(socket);
+    Station &station = *m_stations.value(stationId);
+    if (seq <= station.lastSeq) {
+        // Resent after a reconnect: acknowledge again, store once.
+        station.duplicates++;
+        send(socket, TelemetryProtocol::Ack, station.lastSeq);
+        return true;
+    }
+
+    int samples = 0;
+    int frames = 0;
+    if (!storeBatch(stationId, station, payload.mid(8), samples, frames)) {
+        return false;
+    }
+    station.lastSeq = seq;
+    station.batches++;
+    station.samples += samples;
+    station.frames += frames;
+    send(socket, TelemetryProtocol::Ack, seq);
+    emit batchReceived(stationId, seq, samples, frames);
+    return true;
+}
+
+bool TelemetryAggregator::storeBatch(const QString &stationId, Station &station, const QByteArray &body, int &samples, int &frames)
+{
+    QDataStream stream(body);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    quint16 sampleCount;
+    quint16 frameCount;
+    qint64 baseMs;
+    stream >> sampleCount >> frameCount >> baseMs;
+
+    QByteArray rows;
+    rows.reserve(sampleCount * 40 + frameCount * 48);
+    for (int i = 0; i < sampleCount; ++i) {
+        quint32 deltaMs;
+        double temperature;
+        double pressure;
+        stream >> deltaMs >> temperature >> pressure;
+        rows += QByteArray::number(baseMs + deltaMs) + ',' + QByteArray::number(temperature, 'f', 4) + ','
+                + QByteArray::number(pressure, 'f', 3) + ",\n";
+    }
+    for (int i = 0; i < frameCount; ++i) {
+        quint32 deltaMs;
+        quint16 length;
+        stream >> deltaMs >> length;
+        QByteArray name(length, '\0');
+        if (stream.readRawData(name.data(), length) != length) {
+            return false;
+        }
+        rows += QByteArray::number(baseMs + deltaMs) + ",,," + name + '\n';
+    }
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    samples = sampleCount;
+    frames = frameCount;
+    if (m_outputDirectory.isEmpty()) {
+        return true;
+    }
+
+    if (!station.output) {
+        QString fileName = stationId;
+        fileName.replace(QRegularExpression("[^A-Za-z0-9_-]"), "_");
+        station.output = std::make_unique<QFile>(QDir(m_outputDirectory).filePath("aggregate_" + fileName + ".csv"));
+        bool exists = station.output->exists();
+        if (!station.output->open(QIODevice::WriteOnly | QIODevice::Append)) {
+            qDebug() << "Cannot write aggregate output" << station.output->fileName() << station.output->errorString();
+            station.output.reset();
+            return true;
+        }
+        if (!exists) {
+            station.output->write("TimestampMs,Temperature(C),Pressure(hPa),FrameFile\n");
+        }
+    }
+    station.output->write(rows);
+    return true;
+}
+
+void TelemetryAggregator::send(QTcpSocket *socket, quint8 type, quint64 seq)
+{
+    QByteArray message;
+    QDataStream stream(&message, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << quint32(1 + 8) << type << seq;
+    socket->write(message);
+}
+
+QVariantMap TelemetryAggregator::metrics() const
+{
+    QVariantMap result;
+    quint64 batches = 0;
+    quint64 samples = 0;
+    quint64 frames = 0;
+    quint64 duplicates = 0;
+    QVariantMap stations;
+    for (auto it = m_stations.constBegin(); it != m_stations.constEnd(); ++it) {
+        const Station &station = *it.value();
+        batches += station.batches;
+        samples += station.samples;
+        frames += station.frames;
+        duplicates += station.duplicates;
+        stations[it.key()] = station.lastSeq;
+    }
+    result["connections"] = m_connections;
+    result["connected"] = m_socketStations.size();
+    result["stations"] = stations;
+    result["batches"] = batches;
+    result["samples"] = samples;
+    result["frames"] = frames;
+    result["duplicates"] = duplicates;
+    result["rejected"] = m_rejected;
+    return result;
+}
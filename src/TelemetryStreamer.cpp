@@ -0,0 +1,571 @@
+#include "TelemetryStreamer.h"
+#include "TelemetryProtocol.h"
+#include <QCommandLineParser>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QHostInfo>
+#include <QRegularExpression>
+#include <algorithm>
+#include <limits>
+
+static const int ReconnectMinMs = 1000;
+static const int ReconnectMaxMs = 30000;
+static const qint64 MaxSocketBacklog = 256 * 1024;
+static const int SpillRecordHeader = 12; // quint32 length, quint64 seq
+
+TelemetryStreamer::TelemetryStreamer(QObject *parent)
+    : QObject(parent)
+    , m_socket(new QTcpSocket(this))
+    , m_latencyTimer(new QTimer(this))
+    , m_reconnectTimer(new QTimer(this))
+    , m_reconnectDelayMs(ReconnectMinMs)
+    , m_running(false)
+    , m_connected(false)
+    , m_welcomed(false)
+    , m_everWelcomed(false)
+    , m_sentCount(0)
+    , m_queuedBytes(0)
+    , m_spillReadOffset(0)
+    , m_lastSeq(0)
+    , m_lastAckedSeq(0)
+    , m_batchesSent(0)
+    , m_batchesAcked(0)
+    , m_batchesResent(0)
+    , m_batchesSpilled(0)
+    , m_batchesDropped(0)
+    , m_samplesQueued(0)
+    , m_bytesSent(0)
+    , m_reconnects(0)
+    , m_ackLatencyMs(0.0)
+    , m_dropReported(false)
+{
+    m_latencyTimer->setSingleShot(true);
+    connect(m_latencyTimer, &QTimer::timeout, this, &TelemetryStreamer::flush);
+
+    m_reconnectTimer->setSingleShot(true);
+    connect(m_reconnectTimer, &QTimer::timeout, this, &TelemetryStreamer::connectToAggregator);
+
+    connect(m_socket, &QTcpSocket::connected, this, &TelemetryStreamer::onConnected);
+    connect(m_socket, &QTcpSocket::disconnected, this, &TelemetryStreamer::onDisconnected);
+    connect(m_socket, &QTcpSocket::readyRead, this, &TelemetryStreamer::onReadyRead);
+    connect(m_socket, &QTcpSocket::bytesWritten, this, &TelemetryStreamer::sendPending);
+    connect(m_socket, &QTcpSocket::errorOccurred, this, [this](QAbstractSocket::SocketError) {
+        qDebug() << "Telemetry connection to" << m_config.host << m_config.port << "failed:" << m_socket->errorString();
+        if (m_socket->state() != QAbstractSocket::ConnectedState) {
+            onDisconnected();
+        }
+    });
+}
+
+TelemetryStreamer::~TelemetryStreamer()
+{
+    stop();
+}
+
+void TelemetryStreamer::addCommandLineOptions(QCommandLineParser &parser)
+{
+    parser.addOption(QCommandLineOption("telemetry", "Stream readings to the aggregator at <host:port>.", "host:port"));
+    parser.addOption(QCommandLineOption("telemetry-station", "Station <id> reported to the aggregator (default: host name).", "id"));
+    parser.addOption(QCommandLineOption("telemetry-batch", "Readings per telemetry batch.", "samples"));
+    parser.addOption(QCommandLineOption("telemetry-latency", "Longest a reading waits before its batch is sent, in <ms>.", "ms"));
+    parser.addOption(QCommandLineOption("telemetry-buffer", "Unacknowledged telemetry kept in memory before spilling to disk, in <MB>.", "MB"));
+    parser.addOption(QCommandLineOption("telemetry-frames", "Also stream the names of saved frames."));
+}
+
+bool TelemetryStreamer::applyCommandLineOptions(const QCommandLineParser &parser, TelemetryConfig &config, QString *errorMessage)
+{
+    if (parser.isSet("telemetry") && !parseEndpoint(parser.value("telemetry"), config.host, config.port)) {
+        *errorMessage = "Invalid telemetry endpoint: " + parser.value("telemetry") + ". Expected host:port";
+        return false;
+    }
+    if (parser.isSet("telemetry-station")) {
+        config.stationId = parser.value("telemetry-station");
+    }
+
+    bool ok = true;
+    if (parser.isSet("telemetry-batch")) {
+        config.batchSize = parser.value("telemetry-batch").toInt(&ok);
+        if (!ok || config.batchSize <= 0 || config.batchSize > TelemetryProtocol::MaxBatchEntries) {
+            *errorMessage = "Invalid telemetry batch size: " + parser.value("telemetry-batch");
+            return false;
+        }
+    }
+    if (parser.isSet("telemetry-latency")) {
+        config.maxLatencyMs = parser.value("telemetry-latency").toInt(&ok);
+        if (!ok || config.maxLatencyMs <= 0) {
+            *errorMessage = "Invalid telemetry latency: " + parser.value("telemetry-latency");
+            return false;
+        }
+    }
+    if (parser.isSet("telemetry-buffer")) {
+        double megabytes = parser.value("telemetry-buffer").toDouble(&ok);
+        if (!ok || megabytes <= 0) {
+            *errorMessage = "Invalid telemetry buffer size: " + parser.value("telemetry-buffer");
+            return false;
+        }
+        config.maxBufferedBytes = qint64(megabytes * 1024 * 1024);
+    }
+    if (parser.isSet("telemetry-frames")) {
+        config.includeFrames = true;
+    }
+    return true;
+}
+
+bool TelemetryStreamer::parseEndpoint(const QString &text, QString &host, quint16 &port)
+{
+    int separator = text.lastIndexOf(':');
+    QString hostPart = separator >= 0 ? text.left(separator) : QString();
+    bool ok = false;
+    int value = text.mid(separator + 1).toInt(&ok);
+    if (!ok || value <= 0 || value > 65535) {
+        return false;
+    }
+    host = hostPart.isEmpty() ? QString("127.0.0.1") : hostPart;
+    port = quint16(value);
+    return true;
+}
+
+bool TelemetryStreamer::start(const TelemetryConfig &config, const QString &spillDirectory, QString *errorMessage)
+{
+    stop();
+    if (!config.isEnabled()) {
+        return true;
+    }
+
+    m_config = config;
+    if (m_config.stationId.isEmpty()) {
+        m_config.stationId = QHostInfo::localHostName();
+    }
+    m_config.batchSize = std::clamp(m_config.batchSize, 1, TelemetryProtocol::MaxBatchEntries);
+    m_latencyTimer->setInterval(m_config.maxLatencyMs);
+
+    // Batches left in the spill file by an earlier run are sent first.
+    QString stationFile = m_config.stationId;
+    stationFile.replace(QRegularExpression("[^A-Za-z0-9_-]"), "_");
+    m_spillFile.setFileName(QDir(spillDirectory).filePath("telemetry_" + stationFile + ".spill"));
+    if (!m_spillFile.open(QIODevice::ReadWrite)) {
+        if (errorMessage) {
+            *errorMessage = "Cannot open telemetry spill file: " + m_spillFile.fileName() + ". Error: " + m_spillFile.errorString();
+        }
+        return false;
+    }
+    m_spillReadOffset = 0;
+    if (m_spillFile.size() > 0) {
+        // Resent batches must keep their sequence numbers, and new ones
+        // have to be numbered after them.
+        QDataStream stream(&m_spillFile);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        qint64 offset = 0;
+        int batches = 0;
+        while (offset + SpillRecordHeader <= m_spillFile.size() && m_spillFile.seek(offset)) {
+            quint32 length;
+            quint64 seq;
+            stream >> length >> seq;
+            if (offset + SpillRecordHeader + length > m_spillFile.size()) {
+                break;
+            }
+            m_lastSeq = std::max(m_lastSeq, seq);
+            offset += SpillRecordHeader + length;
+            batches++;
+        }
+        m_spillFile.resize(offset);
+        qDebug() << "Telemetry resuming" << batches << "unsent batches from" << m_spillFile.fileName();
+    }
+
+    m_running = true;
+    m_reconnectDelayMs = ReconnectMinMs;
+    refillFromSpill();
+    connectToAggregator();
+    qDebug() << "Streaming telemetry as" << m_config.stationId << "to" << m_config.host << m_config.port
+             << "batch:" << m_config.batchSize << "latency:" << m_config.maxLatencyMs << "ms";
+    return true;
+}
+
+void TelemetryStreamer::stop()
+{
+    if (!m_running) {
+        return;
+    }
+
+    flush();
+    m_running = false;
+    m_latencyTimer->stop();
+    m_reconnectTimer->stop();
+    m_socket->abort();
+    setConnected(false);
+
+    // Keep unacknowledged batches for the next run, in front of what is
+    // already spilled.
+    if (!m_queue.isEmpty()) {
+        QString temporaryPath = m_spillFile.fileName() + ".tmp";
+        QFile out(temporaryPath);
+        bool ok = out.open(QIODevice::WriteOnly | QIODevice::Truncate);
+        QDataStream stream(&out);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        for (const QueuedBatch &batch : std::as_const(m_queue)) {
+            stream << quint32(batch.body.size()) << quint64(batch.seq);
+            stream.writeRawData(batch.body.constData(), batch.body.size());
+        }
+        if (m_spillFile.seek(m_spillReadOffset)) {
+            while (ok && !m_spillFile.atEnd()) {
+                QByteArray chunk = m_spillFile.read(1024 * 1024);
+                ok = out.write(chunk) == chunk.size();
+            }
+        }
+        ok = ok && stream.status() == QDataStream::Ok;
+        out.close();
+        m_spillFile.close();
+        if (ok) {
+            QFile::remove(m_spillFile.fileName());
+            ok = QFile::rename(temporaryPath, m_spillFile.fileName());
+        }
+        if (!ok) {
+            QFile::remove(temporaryPath);
+            emit error("Cannot save unsent telemetry to " + m_spillFile.fileName());
+        } else {
+            qDebug() << "Telemetry kept" << m_queue.size() << "unacknowledged batches in" << m_spillFile.fileName();
+        }
+    } else if (m_spillReadOffset > 0 && m_spillFile.isOpen()) {
+        // Drop the part of the spill file that was already sent.
+        m_spillFile.seek(m_spillReadOffset);
+        QByteArray rest = m_spillFile.readAll();
+        m_spillFile.resize(0);
+        m_spillFile.seek(0);
+        m_spillFile.write(rest);
+    }
+    bool empty = m_spillFile.isOpen() ? m_spillFile.size() == 0 : QFileInfo(m_spillFile.fileName()).size() == 0;
+    m_spillFile.close();
+    if (empty) {
+        QFile::remove(m_spillFile.fileName());
+    }
+
+    m_queue.clear();
+    m_queuedBytes = 0;
+    m_sentCount = 0;
+    m_spillReadOffset = 0;
+}
+
+void TelemetryStreamer::addSample(qint64 timestampMs, double temperature, double pressure)
+{
+    if (!m_running) {
+        return;
+    }
+
+    m_samples.append({timestampMs, temperature, pressure});
+    m_samplesQueued++;
+    if (m_samples.size() >= m_config.batchSize) {
+        flush();
+    } else if (!m_latencyTimer->isActive()) {
+        m_latencyTimer->start();
+    }
+}
+
+void TelemetryStreamer::addFrame(const QString &frameFilename, qint64 timestampMs)
+{
+    if (!m_running || !m_config.includeFrames) {
+        return;
+    }
+
+    m_frames.append({timestampMs, QFileInfo(frameFilename).fileName()});
+    if (m_frames.size() >= m_config.batchSize) {
+        flush();
+    } else if (!m_latencyTimer->isActive()) {
+        m_latencyTimer->start();
+    }
+}
+
+void TelemetryStreamer::flush()
+{
+    m_latencyTimer->stop();
+    if (m_samples.isEmpty() && m_frames.isEmpty()) {
+        return;
+    }
+
+    QueuedBatch batch;
+    batch.body = encodeBatch();
+    m_samples.clear();
+    m_frames.clear();
+    enqueue(std::move(batch));
+}
+
+QByteArray TelemetryStreamer::encodeBatch() const
+{
+    // Timestamps are stored as offsets from the earliest one in the batch.
+    qint64 baseMs = std::numeric_limits<qint64>::max();
+    for (const Sample &sample : m_samples) {
+        baseMs = std::min(baseMs, sample.timestampMs);
+    }
+    for (const FrameRef &frame : m_frames) {
+        baseMs = std::min(baseMs, frame.timestampMs);
+    }
+
+    QByteArray body;
+    body.reserve(20 + m_samples.size() * 20 + m_frames.size() * 48);
+    QDataStream stream(&body, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    stream << quint16(m_samples.size()) << quint16(m_frames.size()) << qint64(baseMs);
+    for (const Sample &sample : m_samples) {
+        stream << quint32(sample.timestampMs - baseMs) << sample.temperature << sample.pressure;
+    }
+    for (const FrameRef &frame : m_frames) {
+        QByteArray name = frame.filename.toUtf8().left(0xFFFF);
+        stream << quint32(frame.timestampMs - baseMs) << quint16(name.size());
+        stream.writeRawData(name.constData(), name.size());
+    }
+    return body;
+}
+
+void TelemetryStreamer::enqueue(QueuedBatch batch)
+{
+    bool spillPending = m_spillFile.isOpen() && m_spillReadOffset < m_spillFile.size();
+    if (spillPending || m_queuedBytes + batch.body.size() > m_config.maxBufferedBytes) {
+        if (!spill(batch)) {
+            m_batchesDropped++;
+            if (!m_dropReported) {
+                m_dropReported = true;
+                emit error("Telemetry buffer and spill file are full. New readings are not being streamed.");
+            }
+        }
+        return;
+    }
+
+    m_queuedBytes += batch.body.size();
+    m_queue.enqueue(std::move(batch));
+    sendPending();
+}
+
+bool TelemetryStreamer::spill(const QueuedBatch &batch)
+{
+    if (!m_spillFile.isOpen() || m_spillFile.size() - m_spillReadOffset + batch.body.size() > m_config.maxSpillBytes) {
+        return false;
+    }
+
+    QByteArray record;
+    QDataStream stream(&record, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << quint32(batch.body.size()) << quint64(batch.seq);
+    record += batch.body;
+
+    if (!m_spillFile.seek(m_spillFile.size()) || m_spillFile.write(record) != record.size()) {
+        return false;
+    }
+    m_batchesSpilled++;
+    return true;
+}
+
+void TelemetryStreamer::refillFromSpill()
+{
+    if (!m_spillFile.isOpen()) {
+        return;
+    }
+
+    QDataStream stream(&m_spillFile);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    while (m_spillReadOffset < m_spillFile.size() && m_queuedBytes < m_config.maxBufferedBytes
+           && m_spillFile.seek(m_spillReadOffset)) {
+        quint32 length;
+        QueuedBatch batch;
+        stream >> length >> batch.seq;
+        batch.body = m_spillFile.read(length);
+        if (stream.status() != QDataStream::Ok || batch.body.size() != int(length)) {
+            emit error("Telemetry spill file is damaged: " + m_spillFile.fileName());
+            resetSpill();
+            return;
+        }
+        m_spillReadOffset += SpillRecordHeader + length;
+        m_queuedBytes += batch.body.size();
+        m_queue.enqueue(std::move(batch));
+    }
+
+    if (m_spillReadOffset >= m_spillFile.size()) {
+        resetSpill();
+    }
+}
+
+void TelemetryStreamer::resetSpill()
+{
+    m_spillFile.resize(0);
+    m_spillReadOffset = 0;
+    m_dropReported = false;
+}
+
+void TelemetryStreamer::connectToAggregator()
+{
+    if (!m_running) {
+        return;
+    }
+    m_socket->abort();
+    m_socket->connectToHost(m_config.host, m_config.port);
+}
+
+void TelemetryStreamer::onConnected()
+{
+    m_socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    m_readBuffer.clear();
+    m_welcomed = false;
+    m_sentCount = 0;
+
+    QByteArray station = m_config.stationId.toUtf8().left(0xFFFF);
+    QByteArray message;
+    QDataStream stream(&message, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << quint32(1 + 4 + 2 + 2 + station.size()) << quint8(TelemetryProtocol::Hello);
+    stream.writeRawData(TelemetryProtocol::Magic, 4);
+    stream << TelemetryProtocol::Version << quint16(station.size());
+    stream.writeRawData(station.constData(), station.size());
+    m_socket->write(message);
+
+    qDebug() << "Telemetry connected to" << m_config.host << m_config.port;
+    setConnected(true);
+}
+
+void TelemetryStreamer::onDisconnected()
+{
+    bool wasConnected = m_connected;
+    m_welcomed = false;
+    m_sentCount = 0;
+    setConnected(false);
+    if (wasConnected) {
+        qDebug() << "Telemetry connection lost," << m_queue.size() << "batches waiting";
+    }
+    scheduleReconnect();
+}
+
+void TelemetryStreamer::scheduleReconnect()
+{
+    if (!m_running || m_reconnectTimer->isActive()) {
+        return;
+    }
+    m_reconnectTimer->start(m_reconnectDelayMs);
+    m_reconnectDelayMs = std::min(m_reconnectDelayMs * 2, ReconnectMaxMs);
+}
+
+void TelemetryStreamer::setConnected(bool connected)
+{
+    if (m_connected != connected) {
+        m_connected = connected;
+        emit connectedChanged();
+    }
+}
+
+void TelemetryStreamer::onReadyRead()
+{
+    m_readBuffer += m_socket->readAll();
+
+    while (m_readBuffer.size() >= 5) {
+        QDataStream stream(m_readBuffer);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        quint32 length;
+        quint8 type;
+        stream >> length >> type;
+        if (length < 1 || length > quint32(TelemetryProtocol::MaxMessageBytes)) {
+            qDebug() << "Telemetry aggregator sent a malformed message, reconnecting";
+            m_socket->abort();
+            return;
+        }
+        if (m_readBuffer.size() < qsizetype(4 + length)) {
+            return;
+        }
+
+        quint64 seq = 0;
+        if (length >= 9) {
+            stream >> seq;
+        }
+        m_readBuffer.remove(0, 4 + length);
+
+        if (type == TelemetryProtocol::Welcome) {
+            // Everything up to seq already reached the aggregator.
+            m_welcomed = true;
+            m_reconnectDelayMs = ReconnectMinMs;
+            if (m_everWelcomed) {
+                m_reconnects++;
+            }
+            m_everWelcomed = true;
+            m_lastSeq = std::max(m_lastSeq, seq);
+            acknowledge(seq);
+            qDebug() << "Telemetry aggregator has" << m_config.stationId << "up to batch" << seq
+                     << "-" << m_queue.size() << "batches to send";
+            sendPending();
+        } else if (type == TelemetryProtocol::Ack) {
+            acknowledge(seq);
+        }
+    }
+}
+
+void TelemetryStreamer::acknowledge(quint64 seq)
+{
+    while (!m_queue.isEmpty() && m_queue.head().seq != 0 && m_queue.head().seq <= seq) {
+        m_queuedBytes -= m_queue.head().body.size();
+        m_queue.dequeue();
+        m_sentCount = std::max(0, m_sentCount - 1);
+        m_batchesAcked++;
+    }
+    m_lastAckedSeq = std::max(m_lastAckedSeq, seq);
+
+    if (m_ackTimer.isValid()) {
+        m_ackLatencyMs = m_ackTimer.nsecsElapsed() / 1e6;
+        if (m_sentCount > 0) {
+            m_ackTimer.restart();
+        } else {
+            m_ackTimer.invalidate();
+        }
+    }
+
+    refillFromSpill();
+    sendPending();
+}
+
+void TelemetryStreamer::sendPending()
+{
+    if (!m_connected || !m_welcomed) {
+        return;
+    }
+
+    while (m_sentCount < m_queue.size() && m_socket->bytesToWrite() < MaxSocketBacklog) {
+        QueuedBatch &batch = m_queue[m_sentCount];
+        if (batch.seq == 0) {
+            batch.seq = ++m_lastSeq;
+        } else {
+            m_batchesResent++;
+        }
+
+        QByteArray header;
+        QDataStream stream(&header, QIODevice::WriteOnly);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream << quint32(1 + 8 + batch.body.size()) << quint8(TelemetryProtocol::Batch) << quint64(batch.seq);
+        m_socket->write(header);
+        m_socket->write(batch.body);
+
+        m_sentCount++;
+        m_batchesSent++;
+        m_bytesSent += header.size() + batch.body.size();
+        if (!m_ackTimer.isValid()) {
+            m_ackTimer.start();
+        }
+    }
+}
+
+QVariantMap TelemetryStreamer::metrics() const
+{
+    QVariantMap result;
+    result["station"] = m_config.stationId;
+    result["connected"] = m_connected;
+    result["samplesQueued"] = m_samplesQueued;
+    result["batchesSent"] = m_batchesSent;
+    result["batchesAcked"] = m_batchesAcked;
+    result["batchesResent"] = m_batchesResent;
+    result["batchesSpilled"] = m_batchesSpilled;
+    result["batchesDropped"] = m_batchesDropped;
+    result["batchesWaiting"] = m_queue.size();
+    result["bytesBuffered"] = m_queuedBytes;
+    result["bytesSpilled"] = m_spillFile.isOpen() ? m_spillFile.size() - m_spillReadOffset : 0;
+    result["bytesSent"] = m_bytesSent;
+    result["lastSeq"] = m_lastSeq;
+    result["lastAckedSeq"] = m_lastAckedSeq;
+    result["ackLatencyMs"] = m_ackLatencyMs;
+    result["reconnects"] = m_reconnects;
+    return result;
+}
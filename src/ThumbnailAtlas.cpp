@@ -0,0 +1,338 @@
+#include "ThumbnailAtlas.h"
+#include "AsyncWriter.h"
+#include <QDebug>
+#include <QFileInfo>
+#include <QtEndian>
+#include <algorithm>
+#include <numeric>
+
+static const char AtlasMagic[4] = {'C', 'S', 'D', 'T'};
+static const quint32 AtlasVersion = 1;
+static const int HeaderSize = 24;
+
+ThumbnailAtlas::ThumbnailAtlas(QObject *parent)
+    : QObject(parent)
+    , m_recordFileId(-1)
+    , m_building(false)
+    , m_generation(0)
+    , m_records(nullptr)
+{
+    // One worker keeps appended records in the order the frames were saved.
+    m_pool.setMaxThreadCount(1);
+}
+
+ThumbnailAtlas::~ThumbnailAtlas()
+{
+    stopRecording();
+    close();
+}
+
+QString ThumbnailAtlas::sidecarPath(const QString &logFilename)
+{
+    QFileInfo info(logFilename);
+    return info.absolutePath() + "/" + info.completeBaseName() + ".thumbs";
+}
+
+int ThumbnailAtlas::recordSize()
+{
+    return int(sizeof(qint64)) + ThumbnailWidth * ThumbnailHeight * 3;
+}
+
+QByteArray ThumbnailAtlas::header()
+{
+    QByteArray data(HeaderSize, '\0');
+    uchar *bytes = reinterpret_cast<uchar *>(data.data());
+    std::copy(AtlasMagic, AtlasMagic + 4, data.data());
+    qToLittleEndian<quint32>(AtlasVersion, bytes + 4);
+    qToLittleEndian<quint32>(ThumbnailWidth, bytes + 8);
+    qToLittleEndian<quint32>(ThumbnailHeight, bytes + 12);
+    return data;
+}
+
+bool ThumbnailAtlas::makeThumbnail(const QString &framePath, qint64 timestampMs, QByteArray &record)
+{
+    record.fill('\0', recordSize());
+    qToLittleEndian<qint64>(timestampMs, reinterpret_cast<uchar *>(record.data()));
+
+    // JPEG frames are decoded at a quarter of their size, which skips most
+    // of the IDCT work; the rest is a small INTER_AREA resize.
+    cv::Mat image;
+    try {
+        image = cv::imread(framePath.toStdString(), cv::IMREAD_REDUCED_COLOR_4);
+    } catch (const cv::Exception &e) {
+        qDebug() << "Cannot read frame for thumbnail:" << framePath << e.what();
+    }
+    if (image.empty()) {
+        return false;
+    }
+
+    double scale = std::min(double(ThumbnailWidth) / image.cols, double(ThumbnailHeight) / image.rows);
+    int width = std::clamp(int(image.cols * scale + 0.5), 1, int(ThumbnailWidth));
+    int height = std::clamp(int(image.rows * scale + 0.5), 1, int(ThumbnailHeight));
+
+    cv::Mat cell(ThumbnailHeight, ThumbnailWidth, CV_8UC3, cv::Scalar::all(0));
+    cv::Mat target = cell(cv::Rect((ThumbnailWidth - width) / 2, (ThumbnailHeight - height) / 2, width, height));
+    cv::resize(image, target, target.size(), 0, 0, cv::INTER_AREA);
+
+    cv::Mat rgb(ThumbnailHeight, ThumbnailWidth, CV_8UC3, record.data() + sizeof(qint64));
+    cv::cvtColor(cell, rgb, cv::COLOR_BGR2RGB);
+    return true;
+}
+
+bool ThumbnailAtlas::startRecording(const QString &logFilename, QString *errorMessage)
+{
+    stopRecording();
+
+    AsyncWriter *writer = AsyncWriter::shared();
+    m_recordFileId = writer->openAppend(sidecarPath(logFilename), true, errorMessage);
+    if (m_recordFileId < 0) {
+        return false;
+    }
+    writer->append(m_recordFileId, header(), false);
+    return true;
+}
+
+void ThumbnailAtlas::addFrame(const QString &framePath, qint64 timestampMs)
+{
+    if (m_recordFileId < 0) {
+        return;
+    }
+
+    int fileId = m_recordFileId;
+    m_pool.start([fileId, framePath, timestampMs]() {
+        QByteArray record;
+        if (makeThumbnail(framePath, timestampMs, record)) {
+            // A dropped record only makes the atlas incomplete; it is
+            // rebuilt the next time the session is loaded.
+            AsyncWriter::shared()->append(fileId, record, false);
+        }
+    });
+}
+
+void ThumbnailAtlas::stopRecording()
+{
+    if (m_recordFileId < 0) {
+        return;
+    }
+    m_pool.waitForDone();
+    AsyncWriter::shared()->close(m_recordFileId);
+    m_recordFileId = -1;
+}
+
+void ThumbnailAtlas::open(const QString &logFilename, const FrameIndex &frames, bool live)
+{
+    close();
+    if (frames.isEmpty()) {
+        return;
+    }
+
+    QString path = sidecarPath(logFilename);
+    QString errorMessage;
+    if (live) {
+        if (!QFileInfo::exists(path) || !map(path, 0, &errorMessage)) {
+            qDebug() << "No thumbnails for live session" << path << errorMessage;
+        }
+        return;
+    }
+    if (QFileInfo::exists(path) && map(path, frames.size(), &errorMessage)) {
+        return;
+    }
+    if (!errorMessage.isEmpty()) {
+        qDebug() << errorMessage;
+    }
+
+    qDebug() << "Building thumbnail atlas for" << frames.size() << "frames:" << path;
+    setBuilding(true);
+    int generation = m_generation.load();
+    m_pool.start([this, logFilename, frames, path, generation]() {
+        build(logFilename, frames, path, generation);
+    });
+}
+
+void ThumbnailAtlas::close()
+{
+    m_generation++;
+    m_pool.waitForDone();
+    setBuilding(false);
+
+    bool wasReady;
+    {
+        QWriteLocker locker(&m_lock);
+        wasReady = !m_timestamps.isEmpty();
+        m_timestamps.clear();
+        m_order.clear();
+        m_records = nullptr;
+        if (m_file.isOpen()) {
+            m_file.close();
+        }
+    }
+    if (wasReady) {
+        emit readyChanged();
+    }
+}
+
+void ThumbnailAtlas::setBuilding(bool building)
+{
+    if (m_building.exchange(building) != building) {
+        emit buildingChanged();
+    }
+}
+
+bool ThumbnailAtlas::map(const QString &path, int expectedFrames, QString *errorMessage)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *errorMessage = "Cannot open thumbnail atlas: " + path + ". Error: " + file.errorString();
+        return false;
+    }
+
+    QByteArray head = file.read(HeaderSize);
+    const uchar *bytes = reinterpret_cast<const uchar *>(head.constData());
+    if (head.size() != HeaderSize || !std::equal(AtlasMagic, AtlasMagic + 4, head.constData())
+        || qFromLittleEndian<quint32>(bytes + 4) != AtlasVersion
+        || qFromLittleEndian<quint32>(bytes + 8) != quint32(ThumbnailWidth)
+        || qFromLittleEndian<quint32>(bytes + 12) != quint32(ThumbnailHeight)) {
+        *errorMessage = "Thumbnail atlas has an unsupported layout: " + path;
+        return false;
+    }
+
+    // A trailing partial record (a session that was cut off) is ignored.
+    qint64 count = (file.size() - HeaderSize) / recordSize();
+    if (count < expectedFrames) {
+        *errorMessage = QString("Thumbnail atlas is incomplete (%1 of %2 frames): %3").arg(count).arg(expectedFrames).arg(path);
+        return false;
+    }
+
+    const uchar *data = count > 0 ? file.map(0, HeaderSize + count * recordSize()) : nullptr;
+    if (!data) {
+        *errorMessage = "Cannot map thumbnail atlas: " + path + ". Error: " + file.errorString();
+        return false;
+    }
+
+    // Records are nearly always in order already; sort a permutation so
+    // lookups can binary search either way.
+    const uchar *records = data + HeaderSize;
+    QVector<qint64> timestamps(count);
+    for (qint64 i = 0; i < count; ++i) {
+        timestamps[i] = qFromLittleEndian<qint64>(records + i * recordSize());
+    }
+    QVector<int> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&timestamps](int a, int b) {
+        return timestamps[a] < timestamps[b];
+    });
+    QVector<qint64> sorted(count);
+    for (qint64 i = 0; i < count; ++i) {
+        sorted[i] = timestamps[order[i]];
+    }
+
+    {
+        QWriteLocker locker(&m_lock);
+        if (m_file.isOpen()) {
+            m_file.close();
+        }
+        m_file.setFileName(path);
+        m_file.open(QIODevice::ReadOnly);
+        m_records = m_file.map(HeaderSize, count * recordSize());
+        m_timestamps = sorted;
+        m_order = order;
+        if (!m_records) {
+            m_timestamps.clear();
+            m_order.clear();
+        }
+    }
+    file.unmap(const_cast<uchar *>(data));
+
+    if (!isReady()) {
+        *errorMessage = "Cannot map thumbnail atlas: " + path;
+        return false;
+    }
+
+    qDebug() << "Mapped thumbnail atlas" << path << "with" << count << "thumbnails";
+    emit readyChanged();
+    return true;
+}
+
+void ThumbnailAtlas::build(const QString &logFilename, const FrameIndex &frames, const QString &path, int generation)
+{
+    QString temporaryPath = path + ".tmp";
+    QFile out(temporaryPath);
+    bool ok = out.open(QIODevice::WriteOnly | QIODevice::Truncate) && out.write(header()) == HeaderSize;
+
+    QString logDirectory = QFileInfo(logFilename).absolutePath();
+    QByteArray record;
+    int total = frames.size();
+    for (int i = 0; ok && i < total; ++i) {
+        if (m_generation.load() != generation) {
+            ok = false;
+            break;
+        }
+
+        const FrameIndexEntry &entry = frames.at(i);
+        QString framePath = entry.filename;
+        if (!QFileInfo(framePath).isAbsolute() || !QFileInfo::exists(framePath)) {
+            QString candidate = logDirectory + "/" + entry.filename;
+            framePath = QFileInfo::exists(candidate) ? candidate : logDirectory + "/" + QFileInfo(entry.filename).fileName();
+        }
+
+        // Missing frames still get a (blank) record so the atlas counts as complete.
+        makeThumbnail(framePath, entry.timestampMs, record);
+        ok = out.write(record) == record.size();
+
+        if ((i + 1) % 64 == 0 || i + 1 == total) {
+            emit buildProgress(i + 1, total);
+        }
+    }
+    out.close();
+
+    if (ok) {
+        QFile::remove(path);
+        ok = QFile::rename(temporaryPath, path);
+    }
+    if (!ok) {
+        QFile::remove(temporaryPath);
+    }
+
+    QMetaObject::invokeMethod(this, [this, path, total, generation, ok]() {
+        if (m_generation.load() != generation) {
+            return;
+        }
+        setBuilding(false);
+        QString errorMessage;
+        if (!ok) {
+            emit error("Failed to build thumbnail atlas: " + path);
+        } else if (!map(path, total, &errorMessage)) {
+            emit error(errorMessage);
+        }
+    }, Qt::QueuedConnection);
+}
+
+bool ThumbnailAtlas::isReady() const
+{
+    QReadLocker locker(&m_lock);
+    return m_records && !m_timestamps.isEmpty();
+}
+
+int ThumbnailAtlas::count() const
+{
+    QReadLocker locker(&m_lock);
+    return m_timestamps.size();
+}
+
+QImage ThumbnailAtlas::thumbnailAt(qint64 timestampMs) const
+{
+    QReadLocker locker(&m_lock);
+    if (!m_records || m_timestamps.isEmpty()) {
+        return QImage();
+    }
+
+    auto it = std::lower_bound(m_timestamps.begin(), m_timestamps.end(), timestampMs);
+    int index = int(it - m_timestamps.begin());
+    if (index == m_timestamps.size() || (index > 0 && timestampMs - m_timestamps[index - 1] <= *it - timestampMs)) {
+        index--;
+    }
+
+    // The copy is a few KB and keeps the image valid after the atlas is closed.
+    const uchar *pixels = m_records + qint64(m_order[index]) * recordSize() + sizeof(qint64);
+    return QImage(pixels, ThumbnailWidth, ThumbnailHeight, ThumbnailWidth * 3, QImage::Format_RGB888).copy();
+}
@@ -3,65 +3,204 @@
 #include <QQmlContext>
 #include <QtQml>
 #include <QDir>
+#include <QCommandLineParser>
+#include <QQuickWindow>
+#include <QElapsedTimer>
+#include <QDebug>
 
 #include "CameraCapture.h"
+#include "CameraManager.h"
 #include "SensorDataGenerator.h"
+#include "SensorSampleModel.h"
 #include "DataLogger.h"
 #include "PlaybackController.h"
 #include "ImageProvider.h"
 #include "ImageProviderWrapper.h"
+#include "HeadlessRunner.h"
+#include "ExportEngine.h"
+#include "RuleEngine.h"
+#include "SessionComparison.h"
+#include "ThumbnailAtlas.h"
+#include "TelemetryStreamer.h"
+
+static int runHeadless(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("Camera Sensor Dashboard");
+    app.setApplicationVersion("1.0.0");
+
+    HeadlessConfig config;
+    QString errorMessage;
+    if (!HeadlessRunner::parseArguments(app.arguments(), config, &errorMessage)) {
+        if (errorMessage.isEmpty()) {
+            return 0;
+        }
+        qCritical().noquote() << errorMessage;
+        return 1;
+    }
+
+    HeadlessRunner runner(config);
+    if (!runner.start()) {
+        return 1;
+    }
+
+    return app.exec();
+}
 
 int main(int argc, char *argv[])
 {
+    if (HeadlessRunner::isRequested(argc, argv)) {
+        return runHeadless(argc, argv);
+    }
+
+    QElapsedTimer startupTimer;
+    startupTimer.start();
+
     QApplication app(argc, argv);
     app.setApplicationName("Camera Sensor Dashboard");
     app.setApplicationVersion("1.0.0");
 
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Camera Sensor Dashboard");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption busOption("bus", "Publish frames and samples to the shared-memory bus <name>.", "name");
+    parser.addOption(busOption);
+    FrameSource::addCommandLineOptions(parser);
+    TelemetryStreamer::addCommandLineOptions(parser);
+    PreTriggerRecorder::addCommandLineOptions(parser);
+    RuleEngine::addCommandLineOptions(parser);
+    parser.process(app);
+
+    QString busName = parser.value(busOption);
+    if (!busName.isEmpty() && !SharedBusWriter::isValidBusName(busName)) {
+        qCritical().noquote() << "Invalid bus name:" << busName << "- use letters, digits, '-' and '_'";
+        return 1;
+    }
+
+    QList<FrameSourceConfig> sourceConfigs;
+    QString sourceError;
+    if (!FrameSource::applyCommandLineOptions(parser, sourceConfigs, &sourceError)) {
+        qCritical().noquote() << sourceError;
+        return 1;
+    }
+
+    TelemetryConfig telemetryConfig;
+    if (!TelemetryStreamer::applyCommandLineOptions(parser, telemetryConfig, &sourceError)) {
+        qCritical().noquote() << sourceError;
+        return 1;
+    }
+
+    PreTriggerConfig preTriggerConfig;
+    if (!PreTriggerRecorder::applyCommandLineOptions(parser, preTriggerConfig, &sourceError)) {
+        qCritical().noquote() << sourceError;
+        return 1;
+    }
+
+    QStringList rules;
+    if (!RuleEngine::applyCommandLineOptions(parser, rules, &sourceError)) {
+        qCritical().noquote() << sourceError;
+        return 1;
+    }
+
     qmlRegisterType<CameraCapture>("CameraSensorDashboard", 1, 0, "CameraCapture");
     qmlRegisterType<SensorDataGenerator>("CameraSensorDashboard", 1, 0, "SensorDataGenerator");
     qmlRegisterType<DataLogger>("CameraSensorDashboard", 1, 0, "DataLogger");
     qmlRegisterType<PlaybackController>("CameraSensorDashboard", 1, 0, "PlaybackController");
 
-    CameraCapture cameraCapture;
     SensorDataGenerator sensorGenerator;
+    SensorSampleModel sensorSamples;
     DataLogger dataLogger;
     PlaybackController playbackController;
+    ExportEngine exportEngine;
+    RuleEngine ruleEngine;
+    ruleEngine.addRules(rules, &sourceError);
+    ThumbnailAtlas thumbnailAtlas;
+    SessionComparison sessionComparison;
+    TelemetryStreamer telemetryStreamer;
     ImageProvider *imageProvider = new ImageProvider();
+    imageProvider->setThumbnailAtlas(&thumbnailAtlas);
+    imageProvider->setSessionCatalog(dataLogger.catalog());
     ImageProviderWrapper *imageProviderWrapper = new ImageProviderWrapper(imageProvider);
 
-    QObject::connect(&cameraCapture, &CameraCapture::frameReady,
-                     [imageProvider](const QImage &image) {
-                         imageProvider->updateImage(image);
-                     });
+    CameraManager cameraManager(imageProvider);
+    for (const FrameSourceConfig &config : sourceConfigs) {
+        cameraManager.addCamera(config);
+    }
+    cameraManager.setBusName(busName);
+    cameraManager.setPreTriggerConfig(preTriggerConfig);
+    CameraCapture *cameraCapture = cameraManager.primaryCamera();
 
-    QObject::connect(&cameraCapture, &CameraCapture::frameSaved,
+    QString busError;
+    if (!sensorGenerator.setBusName(busName, &busError)) {
+        qWarning().noquote() << busError;
+    }
+
+    QObject::connect(&cameraManager, &CameraManager::frameSaved,
                      &dataLogger, &DataLogger::logFrame);
 
-    QObject::connect(&sensorGenerator, &SensorDataGenerator::dataReady,
-                     &dataLogger, &DataLogger::logSensorData);
+    QObject::connect(&sensorGenerator, &SensorDataGenerator::sampleReady,
+                     &dataLogger, &DataLogger::logSample);
+    QObject::connect(&sensorGenerator, &SensorDataGenerator::sampleReady,
+                     &ruleEngine, &RuleEngine::addSample);
+    QObject::connect(&sensorGenerator, &SensorDataGenerator::sampleReady,
+                     &sensorSamples, &SensorSampleModel::addSample);
+    if (preTriggerConfig.isEnabled() && preTriggerConfig.triggerOnAlert) {
+        QObject::connect(&ruleEngine, &RuleEngine::alertRaised, &cameraManager, [&cameraManager](const QString &rule) {
+            cameraManager.trigger("alert:" + rule);
+        });
+    }
+
+    QObject::connect(&sensorGenerator, &SensorDataGenerator::sampleReady,
+                     &telemetryStreamer, &TelemetryStreamer::addSample);
+    QObject::connect(&cameraManager, &CameraManager::frameSaved,
+                     &telemetryStreamer, &TelemetryStreamer::addFrame);
+    QString telemetryError;
+    if (!telemetryStreamer.start(telemetryConfig, dataLogger.getDataDirectory(), &telemetryError)) {
+        qWarning().noquote() << telemetryError;
+    }
 
-    QObject::connect(&dataLogger, &DataLogger::dataLoaded, [&dataLogger, &playbackController]() {
-        playbackController.loadData(dataLogger.getReadings());
+    QObject::connect(&dataLogger, &DataLogger::dataLoaded, [&dataLogger, &playbackController, &thumbnailAtlas]() {
+        thumbnailAtlas.open(dataLogger.loadedLogFile(), dataLogger.frameIndex(), dataLogger.isFollowing());
+        playbackController.setFrameIndex(dataLogger.frameIndex());
+        playbackController.setRollups(dataLogger.rollups());
+        playbackController.loadData(dataLogger.readings());
+    });
+    QObject::connect(&dataLogger, &DataLogger::followingChanged, [&dataLogger, &playbackController]() {
+        playbackController.setFollowing(dataLogger.isFollowing());
+    });
+    QObject::connect(&dataLogger, &DataLogger::readingsAppended, [&dataLogger, &playbackController]() {
+        playbackController.appendReadings(dataLogger.readings());
+    });
+    QObject::connect(&dataLogger, &DataLogger::framesAppended, [&dataLogger, &playbackController]() {
+        playbackController.appendFrames(dataLogger.frameIndex());
+    });
+    QObject::connect(&dataLogger, &DataLogger::frameIndexReset, [&dataLogger, &playbackController]() {
+        playbackController.setFrameIndex(dataLogger.frameIndex());
     });
     
-    QObject::connect(&playbackController, &PlaybackController::dataPoint,
-                     [imageProvider](double temperature, double pressure, const QString &timestamp, const QString &frameFile) {
-                         Q_UNUSED(temperature)
-                         Q_UNUSED(pressure)
-                         Q_UNUSED(timestamp)
-                         if (!frameFile.isEmpty()) {
-                             imageProvider->updatePlaybackImage(frameFile);
-                         }
+    QObject::connect(&playbackController, &PlaybackController::frameChanged,
+                     [imageProvider](int frameIndex, const QString &frameFile) {
+                         Q_UNUSED(frameIndex)
+                         imageProvider->updatePlaybackImage(frameFile);
                      });
 
     QQmlApplicationEngine engine;
     
     engine.addImageProvider("camera", imageProvider);
     
-    engine.rootContext()->setContextProperty("cameraCapture", &cameraCapture);
+    engine.rootContext()->setContextProperty("cameraCapture", cameraCapture);
+    engine.rootContext()->setContextProperty("cameraManager", &cameraManager);
     engine.rootContext()->setContextProperty("sensorGenerator", &sensorGenerator);
+    engine.rootContext()->setContextProperty("sensorSamples", &sensorSamples);
     engine.rootContext()->setContextProperty("dataLogger", &dataLogger);
     engine.rootContext()->setContextProperty("playbackController", &playbackController);
+    engine.rootContext()->setContextProperty("exportEngine", &exportEngine);
+    engine.rootContext()->setContextProperty("ruleEngine", &ruleEngine);
+    engine.rootContext()->setContextProperty("thumbnailAtlas", &thumbnailAtlas);
+    engine.rootContext()->setContextProperty("sessionCatalog", dataLogger.catalog());
+    engine.rootContext()->setContextProperty("sessionComparison", &sessionComparison);
+    engine.rootContext()->setContextProperty("telemetryStreamer", &telemetryStreamer);
     engine.rootContext()->setContextProperty("imageProvider", imageProviderWrapper);
 
     const QUrl url(QStringLiteral("qrc:/main.qml"));
@@ -73,5 +212,26 @@ int main(int argc, char *argv[])
     
     engine.load(url);
 
-    return app.exec();
+    if (!engine.rootObjects().isEmpty()) {
+        if (QQuickWindow *window = qobject_cast<QQuickWindow *>(engine.rootObjects().first())) {
+            QObject::connect(window, &QWindow::visibilityChanged, [imageProvider](QWindow::Visibility visibility) {
+                imageProvider->setDisplayActive(visibility != QWindow::Minimized && visibility != QWindow::Hidden);
+            });
+        }
+    }
+
+    qDebug() << "Startup: UI ready after" << startupTimer.elapsed() << "ms";
+    bool firstFrameReported = false;
+    QObject::connect(cameraCapture, &CameraCapture::stateChanged, &app, [cameraCapture, &startupTimer, &firstFrameReported]() {
+        if (!firstFrameReported && cameraCapture->state() == CameraCapture::Live) {
+            firstFrameReported = true;
+            qDebug() << "Startup: first camera frame" << startupTimer.elapsed() << "ms after launch,"
+                     << cameraCapture->timeToFirstFrameMs() << "ms after the camera was started (open"
+                     << cameraCapture->openMs() << "ms)";
+        }
+    });
+
+    int result = app.exec();
+    cameraManager.shutdown();
+    return result;
 }
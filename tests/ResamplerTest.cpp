@@ -0,0 +1,242 @@
+#include "Resampler.h"
+#include <QtTest>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+struct Samples {
+    std::vector<qint64> timestamps;
+    std::vector<double> first;
+    std::vector<double> second;
+};
+
+struct Grid {
+    std::vector<qint64> timestamps;
+    std::vector<double> first;
+    std::vector<double> second;
+};
+
+// Uneven spacing, a gap wider than the interval, and two readings at 4000.
+Samples irregularSamples()
+{
+    Samples samples;
+    samples.timestamps = {1000, 1300, 2100, 2150, 4000, 4000, 5200};
+    samples.first = {0.0, 3.0, 11.0, 11.5, 30.0, 31.0, 43.0};
+    samples.second = {-1.0, -2.0, -3.0, -4.0, -5.0, -6.0, -7.0};
+    return samples;
+}
+
+Grid batch(ResampleMethod method, const Samples &samples, qint64 startMs, qint64 intervalMs)
+{
+    Grid grid;
+    int points = Resampler::gridSize(startMs, samples.timestamps.back(), intervalMs);
+    grid.first.resize(points);
+    grid.second.resize(points);
+    for (int i = 0; i < points; ++i) {
+        grid.timestamps.push_back(startMs + qint64(i) * intervalMs);
+    }
+    const double *columns[] = {samples.first.data(), samples.second.data()};
+    double *outputs[] = {grid.first.data(), grid.second.data()};
+    Resampler::resample(method, samples.timestamps.data(), columns, int(samples.timestamps.size()), 2,
+                        startMs, intervalMs, points, outputs);
+    return grid;
+}
+
+Grid stream(ResampleMethod method, const Samples &samples, qint64 startMs, qint64 intervalMs)
+{
+    Grid grid;
+    Resampler resampler(method, intervalMs, 2, startMs);
+    for (size_t i = 0; i < samples.timestamps.size(); ++i) {
+        double values[] = {samples.first[i], samples.second[i]};
+        resampler.push(samples.timestamps[i], values);
+    }
+    resampler.finish();
+
+    qint64 timestampMs;
+    double values[2];
+    while (resampler.takePoint(timestampMs, values)) {
+        grid.timestamps.push_back(timestampMs);
+        grid.first.push_back(values[0]);
+        grid.second.push_back(values[1]);
+    }
+    return grid;
+}
+
+bool sameValue(double a, double b)
+{
+    if (std::isnan(a) || std::isnan(b)) {
+        return std::isnan(a) && std::isnan(b);
+    }
+    return qFuzzyCompare(a + 1.0, b + 1.0);
+}
+
+bool sameGrid(const Grid &a, const Grid &b)
+{
+    if (a.timestamps != b.timestamps || a.first.size() != b.first.size() || a.second.size() != b.second.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.first.size(); ++i) {
+        if (!sameValue(a.first[i], b.first[i]) || !sameValue(a.second[i], b.second[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+class ResamplerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void batchMatchesStreaming_data();
+    void batchMatchesStreaming();
+    void emptyBucketsAreNaN();
+    void duplicateTimestamps();
+    void explicitStartBeforeFirstSample();
+    void noSamples();
+};
+
+void ResamplerTest::batchMatchesStreaming_data()
+{
+    QTest::addColumn<int>("method");
+    QTest::addColumn<qint64>("intervalMs");
+    QTest::addColumn<bool>("autoStart");
+
+    const ResampleMethod methods[] = {ResampleMethod::Linear, ResampleMethod::Previous, ResampleMethod::Mean};
+    for (ResampleMethod method : methods) {
+        for (qint64 intervalMs : {100, 500, 700, 3000}) {
+            QByteArray name = Resampler::methodName(method).toLatin1() + " " + QByteArray::number(intervalMs);
+            QTest::newRow(name + " auto") << int(method) << intervalMs << true;
+            QTest::newRow(name + " explicit") << int(method) << intervalMs << false;
+        }
+    }
+}
+
+void ResamplerTest::batchMatchesStreaming()
+{
+    QFETCH(int, method);
+    QFETCH(qint64, intervalMs);
+    QFETCH(bool, autoStart);
+
+    ResampleMethod resampleMethod = ResampleMethod(method);
+    Samples samples = irregularSamples();
+    qint64 startMs = Resampler::alignedStart(resampleMethod, samples.timestamps.front(), intervalMs);
+    if (!autoStart) {
+        startMs -= 2 * intervalMs;
+    }
+
+    Grid streamed = stream(resampleMethod, samples, autoStart ? Resampler::AutoStart : startMs, intervalMs);
+    Grid stored = batch(resampleMethod, samples, startMs, intervalMs);
+    QVERIFY(!stored.timestamps.empty());
+    QVERIFY(sameGrid(streamed, stored));
+}
+
+void ResamplerTest::emptyBucketsAreNaN()
+{
+    // Buckets from 1000: [1000, 1500) has two readings, [2000, 2500) two,
+    // and the three between 2500 and 4000 none.
+    Samples samples = irregularSamples();
+    Grid grid = batch(ResampleMethod::Mean, samples, 1000, 500);
+    QCOMPARE(grid.timestamps.size(), size_t(9));
+    QCOMPARE(grid.first[0], 1.5);
+    QVERIFY(std::isnan(grid.first[1]));
+    QCOMPARE(grid.first[2], 11.25);
+    QVERIFY(std::isnan(grid.first[3]));
+    QVERIFY(std::isnan(grid.first[4]));
+    QVERIFY(std::isnan(grid.first[5]));
+    QCOMPARE(grid.first[6], 30.5);
+    QVERIFY(std::isnan(grid.first[7]));
+    QCOMPARE(grid.first[8], 43.0);
+    QVERIFY(std::isnan(grid.second[5]));
+
+    QVERIFY(sameGrid(stream(ResampleMethod::Mean, samples, Resampler::AutoStart, 500), grid));
+}
+
+void ResamplerTest::duplicateTimestamps()
+{
+    // At 4000 the later of the two readings wins for linear and previous,
+    // and both count towards the mean.
+    Samples samples = irregularSamples();
+
+    Grid linear = batch(ResampleMethod::Linear, samples, 1000, 1000);
+    QCOMPARE(linear.timestamps.size(), size_t(5));
+    QCOMPARE(linear.first[3], 31.0);
+    QCOMPARE(linear.first[4], 31.0 + 12.0 * (1000.0 / 1200.0));
+    QVERIFY(sameGrid(stream(ResampleMethod::Linear, samples, Resampler::AutoStart, 1000), linear));
+
+    Grid previous = batch(ResampleMethod::Previous, samples, 1000, 1000);
+    QCOMPARE(previous.first[3], 31.0);
+    QCOMPARE(previous.second[3], -6.0);
+    QCOMPARE(previous.first[4], 31.0);
+    QVERIFY(sameGrid(stream(ResampleMethod::Previous, samples, Resampler::AutoStart, 1000), previous));
+
+    Grid mean = batch(ResampleMethod::Mean, samples, 1000, 1000);
+    QCOMPARE(mean.first[3], 30.5);
+    QCOMPARE(mean.second[3], -5.5);
+    QVERIFY(sameGrid(stream(ResampleMethod::Mean, samples, Resampler::AutoStart, 1000), mean));
+}
+
+void ResamplerTest::explicitStartBeforeFirstSample()
+{
+    Samples samples = irregularSamples();
+
+    // Points before the first reading are NaN, and the rest of the grid is
+    // the one an automatic start would have given.
+    const ResampleMethod methods[] = {ResampleMethod::Linear, ResampleMethod::Previous, ResampleMethod::Mean};
+    for (ResampleMethod method : methods) {
+        Grid early = stream(method, samples, 0, 500);
+        Grid aligned = stream(method, samples, Resampler::AutoStart, 500);
+        QCOMPARE(early.timestamps.front(), qint64(0));
+        QCOMPARE(early.timestamps.size(), aligned.timestamps.size() + 2);
+        QVERIFY(std::isnan(early.first[0]));
+        QVERIFY(std::isnan(early.first[1]));
+        QVERIFY(std::isnan(early.second[1]));
+        Grid tail;
+        tail.timestamps.assign(early.timestamps.begin() + 2, early.timestamps.end());
+        tail.first.assign(early.first.begin() + 2, early.first.end());
+        tail.second.assign(early.second.begin() + 2, early.second.end());
+        QVERIFY(sameGrid(tail, aligned));
+        QVERIFY(sameGrid(early, batch(method, samples, 0, 500)));
+    }
+
+    // Readings before an explicit start do not reach the first bucket.
+    Resampler resampler(ResampleMethod::Mean, 500, 1, 1000);
+    const double before = 100.0;
+    const double inside = 2.0;
+    resampler.push(900, &before);
+    resampler.push(1100, &inside);
+    resampler.finish();
+    qint64 timestampMs;
+    double value;
+    QVERIFY(resampler.takePoint(timestampMs, &value));
+    QCOMPARE(timestampMs, qint64(1000));
+    QCOMPARE(value, 2.0);
+    QCOMPARE(resampler.droppedSamples(), quint64(1));
+}
+
+void ResamplerTest::noSamples()
+{
+    Samples samples;
+    std::vector<double> first(3, 0.0);
+    std::vector<double> second(3, 0.0);
+    const double *columns[] = {samples.first.data(), samples.second.data()};
+    double *outputs[] = {first.data(), second.data()};
+    Resampler::resample(ResampleMethod::Linear, samples.timestamps.data(), columns, 0, 2, 0, 100, 3, outputs);
+    for (int i = 0; i < 3; ++i) {
+        QVERIFY(std::isnan(first[i]));
+        QVERIFY(std::isnan(second[i]));
+    }
+
+    Resampler resampler(ResampleMethod::Mean, 100, 2);
+    resampler.finish();
+    qint64 timestampMs;
+    double values[2];
+    QVERIFY(!resampler.takePoint(timestampMs, values));
+}
+
+QTEST_APPLESS_MAIN(ResamplerTest)
+
+#include "ResamplerTest.moc"
@@ -0,0 +1,249 @@
+#include "SessionComparison.h"
+#include <QDateTime>
+#include <QFile>
+#include <QPointF>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <cmath>
+
+namespace {
+
+struct Row {
+    qint64 offsetMs;
+    double temperature;
+    double pressure;
+};
+
+// Session A: one reading a second for 10 s, rising 1 C/s.
+QVector<Row> risingRows()
+{
+    QVector<Row> rows;
+    for (int s = 0; s <= 10; ++s) {
+        rows.append({s * 1000, 20.0 + s, 1000.0 + 2.0 * s});
+    }
+    return rows;
+}
+
+// Session B: uneven spacing over 6 s, falling 1 C/s, so linear
+// interpolation lands on the line whatever the spacing.
+QVector<Row> unevenRows()
+{
+    QVector<Row> rows;
+    for (qint64 offsetMs : {0, 400, 1500, 2000, 3600, 6000}) {
+        rows.append({offsetMs, 30.0 - offsetMs / 1000.0, 1013.0});
+    }
+    return rows;
+}
+
+// Session C: 3 s at a constant temperature.
+QVector<Row> shortRows()
+{
+    QVector<Row> rows;
+    for (int s = 0; s <= 3; ++s) {
+        rows.append({s * 1000, 10.0, 990.0 + s});
+    }
+    return rows;
+}
+
+bool writeLog(const QString &path, const QDateTime &start, const QVector<Row> &rows)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+    file.write("Timestamp,Temperature(C),Pressure(hPa),FrameFile\n");
+    for (const Row &row : rows) {
+        file.write(start.addMSecs(row.offsetMs).toString(Qt::ISODateWithMs).toUtf8() + ','
+                   + QByteArray::number(row.temperature, 'f', 3) + ','
+                   + QByteArray::number(row.pressure, 'f', 3) + ",\n");
+    }
+    return true;
+}
+
+QVector<QPointF> points(const QVariantList &series)
+{
+    QVector<QPointF> result;
+    for (const QVariant &point : series) {
+        result.append(point.toPointF());
+    }
+    return result;
+}
+
+}
+
+class SessionComparisonTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void loadSessionAlignsOnFirstReading();
+    void loadSessionMeanLeavesEmptyBuckets();
+    void loadPoolsSessions();
+    void newerLoadDiscardsOlderResults();
+
+private:
+    QTemporaryDir m_dir;
+    QString m_rising;
+    QString m_uneven;
+    QString m_short;
+    QString m_invalid;
+};
+
+void SessionComparisonTest::init()
+{
+    QVERIFY(m_dir.isValid());
+    m_rising = m_dir.filePath("sensor_log_20240101_100000.csv");
+    m_uneven = m_dir.filePath("sensor_log_20240305_083000.csv");
+    m_short = m_dir.filePath("sensor_log_20240601_000000.csv");
+    m_invalid = m_dir.filePath("sensor_log_20240701_000000.csv");
+
+    // Different days and times of day: only time since start is shared.
+    QVERIFY(writeLog(m_rising, QDateTime(QDate(2024, 1, 1), QTime(10, 0, 0)), risingRows()));
+    QVERIFY(writeLog(m_uneven, QDateTime(QDate(2024, 3, 5), QTime(8, 30, 0, 500)), unevenRows()));
+    QVERIFY(writeLog(m_short, QDateTime(QDate(2024, 6, 1), QTime(0, 0, 0)), shortRows()));
+
+    QFile invalid(m_invalid);
+    QVERIFY(invalid.open(QIODevice::WriteOnly | QIODevice::Text));
+    invalid.write("not,a,sensor,log\n1,2,3,4\n");
+}
+
+void SessionComparisonTest::loadSessionAlignsOnFirstReading()
+{
+    ComparedSession session = SessionComparison::loadSession(m_uneven, 1000, ResampleMethod::Linear);
+    QVERIFY(session.error.isEmpty());
+    QCOMPARE(session.name, QString("sensor_log_20240305_083000"));
+    QCOMPARE(session.rows, 6);
+    QCOMPARE(session.startMs, QDateTime(QDate(2024, 3, 5), QTime(8, 30, 0, 500)).toMSecsSinceEpoch());
+    QCOMPARE(session.durationMs, qint64(6000));
+    QCOMPARE(session.alignedTemperature.size(), qsizetype(7));
+    QCOMPARE(session.alignedPressure.size(), qsizetype(7));
+    for (int i = 0; i < 7; ++i) {
+        QCOMPARE(session.alignedTemperature[i], 30.0 - i);
+        QCOMPARE(session.alignedPressure[i], 1013.0);
+    }
+    QCOMPARE(session.temperature.count, quint64(6));
+    QCOMPARE(session.temperature.min, 24.0);
+    QCOMPARE(session.temperature.max, 30.0);
+
+    ComparedSession missing = SessionComparison::loadSession(m_dir.filePath("missing.csv"), 1000,
+                                                             ResampleMethod::Linear);
+    QVERIFY(!missing.error.isEmpty());
+    QVERIFY(missing.alignedTemperature.isEmpty());
+}
+
+void SessionComparisonTest::loadSessionMeanLeavesEmptyBuckets()
+{
+    // Buckets start at the first reading: [4 s, 5 s) and [5 s, 6 s) are empty.
+    ComparedSession session = SessionComparison::loadSession(m_uneven, 1000, ResampleMethod::Mean);
+    QVERIFY(session.error.isEmpty());
+    QCOMPARE(session.alignedTemperature.size(), qsizetype(7));
+    QCOMPARE(session.alignedTemperature[0], 29.8);
+    QCOMPARE(session.alignedTemperature[1], 28.5);
+    QCOMPARE(session.alignedTemperature[2], 28.0);
+    QCOMPARE(session.alignedTemperature[3], 26.4);
+    QVERIFY(std::isnan(session.alignedTemperature[4]));
+    QVERIFY(std::isnan(session.alignedTemperature[5]));
+    QCOMPARE(session.alignedTemperature[6], 24.0);
+}
+
+void SessionComparisonTest::loadPoolsSessions()
+{
+    SessionComparison comparison;
+    QSignalSpy errors(&comparison, &SessionComparison::error);
+    QVERIFY(comparison.load({m_rising, m_uneven, m_short, m_invalid}, 1000, "linear"));
+    QVERIFY(comparison.isLoading());
+    QTRY_VERIFY_WITH_TIMEOUT(!comparison.isLoading(), 10000);
+
+    QCOMPARE(errors.count(), qsizetype(1));
+    QVERIFY(errors.first().first().toString().startsWith("sensor_log_20240701_000000: "));
+
+    // Sessions stay in the order they were asked for, whatever order the
+    // pool finished them in.
+    QVariantList sessions = comparison.sessions();
+    QCOMPARE(sessions.size(), qsizetype(4));
+    QCOMPARE(sessions[0].toMap()["rows"].toInt(), 11);
+    QCOMPARE(sessions[1].toMap()["rows"].toInt(), 6);
+    QCOMPARE(sessions[2].toMap()["rows"].toInt(), 4);
+    QCOMPARE(sessions[3].toMap()["loaded"].toBool(), false);
+    QCOMPARE(comparison.durationMs(), qint64(10000));
+
+    QVector<QPointF> rising = points(comparison.series(0, "temperature", 1000));
+    QCOMPARE(rising.size(), qsizetype(11));
+    for (int i = 0; i < rising.size(); ++i) {
+        QCOMPARE(rising[i].x(), double(i));
+        QCOMPARE(rising[i].y(), 20.0 + i);
+    }
+    QVector<QPointF> uneven = points(comparison.series(1, "temperature", 1000));
+    QCOMPARE(uneven.size(), qsizetype(7));
+    QCOMPARE(uneven[3].y(), 27.0);
+    QCOMPARE(points(comparison.series(2, "pressure", 1000)).last().y(), 993.0);
+    QVERIFY(comparison.series(3, "temperature", 1000).isEmpty());
+
+    // Decimated to 6 points: each is the mean of two grid points.
+    QVector<QPointF> decimated = points(comparison.series(0, "temperature", 6));
+    QCOMPARE(decimated.size(), qsizetype(6));
+    QCOMPARE(decimated[1].x(), 2.0);
+    QCOMPARE(decimated[1].y(), 22.5);
+
+    QVector<QPointF> mean = points(comparison.meanSeries("temperature", 1000));
+    QCOMPARE(mean.size(), qsizetype(11));
+    QCOMPARE(mean[0].y(), 20.0);
+    QCOMPARE(mean[5].y(), 25.0);
+    QCOMPARE(mean[10].y(), 30.0);
+
+    // Pooled over every reading of the three sessions that loaded.
+    double temperatureSum = 0.0;
+    double pressureSum = 0.0;
+    int count = 0;
+    for (const QVector<Row> &rows : {risingRows(), unevenRows(), shortRows()}) {
+        for (const Row &row : rows) {
+            temperatureSum += row.temperature;
+            pressureSum += row.pressure;
+            count++;
+        }
+    }
+    QVariantMap statistics = comparison.statistics();
+    QCOMPARE(statistics["sessions"].toInt(), 4);
+    QCOMPARE(statistics["loadedSessions"].toInt(), 3);
+    QCOMPARE(statistics["count"].toInt(), count);
+    QCOMPARE(statistics["temperatureMin"].toDouble(), 10.0);
+    QCOMPARE(statistics["temperatureMax"].toDouble(), 30.0);
+    QCOMPARE(statistics["temperatureMean"].toDouble(), temperatureSum / count);
+    QCOMPARE(statistics["pressureMin"].toDouble(), 990.0);
+    QCOMPARE(statistics["pressureMax"].toDouble(), 1020.0);
+    QCOMPARE(statistics["pressureMean"].toDouble(), pressureSum / count);
+    QCOMPARE(statistics["intervalMs"].toInt(), 1000);
+    QCOMPARE(statistics["method"].toString(), QString("linear"));
+    QCOMPARE(statistics["durationMs"].toLongLong(), qint64(10000));
+
+    // All three cover the first 3 s. Temperatures there are 20 + t, 30 - t
+    // and 10, so the spread falls from 20 to 17.
+    QCOMPARE(statistics["overlapMs"].toLongLong(), qint64(3000));
+    QCOMPARE(statistics["temperatureMaxSpread"].toDouble(), 20.0);
+    QCOMPARE(statistics["temperatureMeanSpread"].toDouble(), 18.5);
+}
+
+void SessionComparisonTest::newerLoadDiscardsOlderResults()
+{
+    SessionComparison comparison;
+    QVERIFY(comparison.load({m_rising, m_uneven}, 1000, "linear"));
+    QVERIFY(comparison.load({m_short}, 500, "previous"));
+    QTRY_VERIFY_WITH_TIMEOUT(!comparison.isLoading(), 10000);
+
+    QCOMPARE(comparison.sessionCount(), 1);
+    QCOMPARE(comparison.intervalMs(), 500);
+    QCOMPARE(comparison.method(), QString("previous"));
+    QVector<QPointF> pressure = points(comparison.series(0, "pressure", 1000));
+    QCOMPARE(pressure.size(), qsizetype(7));
+    QCOMPARE(pressure[1].y(), 990.0);
+    QCOMPARE(pressure[2].y(), 991.0);
+
+    QVERIFY(!comparison.load({}, 1000, "linear"));
+    QVERIFY(!comparison.load({m_short}, 1000, "cubic"));
+}
+
+QTEST_GUILESS_MAIN(SessionComparisonTest)
+
+#include "SessionComparisonTest.moc"